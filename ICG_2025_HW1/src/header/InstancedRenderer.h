@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+#include "Object.h"
+#include "Transform.h"
+
+// Per-instance vertex attributes, read by easy.vert at locations 3..10
+struct InstanceData
+{
+	glm::mat4 model;        // locations 3-6
+	glm::mat3 normalMatrix; // locations 7-9, inverse transpose of model
+	glm::vec3 color;        // location 10
+};
+
+// Collects every (mesh, model matrix, color) submitted during a frame and draws each mesh with
+// a single glDrawElementsInstanced, instead of one glDrawElements plus uniform uploads per object.
+//
+// Usage:
+//     int cubeId = renderer.addMesh(cube);
+//     ...
+//     renderer.submit(cubeId, model, color); // any number of times per frame
+//     renderer.flush();                      // upload + one draw per mesh, then clear
+class InstancedRenderer
+{
+public:
+	struct Stats
+	{
+		size_t instances = 0;
+		size_t drawCalls = 0;
+	};
+
+	InstancedRenderer() = default;
+	InstancedRenderer(const InstancedRenderer&) = delete;
+	InstancedRenderer& operator=(const InstancedRenderer&) = delete;
+
+	~InstancedRenderer() {
+		for (auto& batch : batches) {
+			glDeleteBuffers(1, &batch.VBO);
+		}
+	}
+
+	// Register a mesh and attach the instance buffer to its VAO; returns the id to submit with
+	int addMesh(Object* mesh) {
+		Batch batch;
+		batch.mesh = mesh;
+		glGenBuffers(1, &batch.VBO);
+
+		glBindVertexArray(mesh->getVAO());
+		glBindBuffer(GL_ARRAY_BUFFER, batch.VBO);
+		const GLsizei stride = sizeof(InstanceData);
+		for (int i = 0; i < 4; i++) {
+			GLuint location = 3 + i;
+			glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride,
+			                      (void*)(offsetof(InstanceData, model) + sizeof(glm::vec4) * i));
+			glEnableVertexAttribArray(location);
+			glVertexAttribDivisor(location, 1);
+		}
+		for (int i = 0; i < 3; i++) {
+			GLuint location = 7 + i;
+			glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, stride,
+			                      (void*)(offsetof(InstanceData, normalMatrix) + sizeof(glm::vec3) * i));
+			glEnableVertexAttribArray(location);
+			glVertexAttribDivisor(location, 1);
+		}
+		glVertexAttribPointer(10, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(InstanceData, color));
+		glEnableVertexAttribArray(10);
+		glVertexAttribDivisor(10, 1);
+		glBindVertexArray(0);
+
+		batches.push_back(batch);
+		return static_cast<int>(batches.size()) - 1;
+	}
+
+	void submit(int meshId, const glm::mat4& model, const glm::vec3& color) {
+		batches[meshId].instances.push_back({model, normalMatrix(model), color});
+	}
+
+	// Upload this frame's instances and draw every non-empty mesh once. The caller binds the shader
+	// and sets the per-frame uniforms (view, projection) beforehand.
+	void flush() {
+		lastStats = Stats();
+		for (auto& batch : batches) {
+			if (batch.instances.empty()) continue;
+
+			GLsizeiptr bytes = sizeof(InstanceData) * batch.instances.size();
+			glBindBuffer(GL_ARRAY_BUFFER, batch.VBO);
+			if (bytes > batch.capacity) {
+				// Grow geometrically so a slowly growing scene does not reallocate every frame
+				batch.capacity = std::max(bytes, batch.capacity * 2);
+			}
+			// (Re)specify the storage: orphans last frame's buffer so the upload does not wait on draws still reading it
+			glBufferData(GL_ARRAY_BUFFER, batch.capacity, nullptr, GL_STREAM_DRAW);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, batch.instances.data());
+
+			batch.mesh->drawInstanced(static_cast<GLsizei>(batch.instances.size()));
+
+			lastStats.instances += batch.instances.size();
+			lastStats.drawCalls++;
+			batch.instances.clear(); // keeps the capacity for the next frame
+		}
+	}
+
+	const Stats& stats() const { return lastStats; }
+
+private:
+	struct Batch
+	{
+		Object* mesh = nullptr;
+		unsigned int VBO = 0;
+		GLsizeiptr capacity = 0;
+		vector<InstanceData> instances;
+	};
+
+	vector<Batch> batches;
+	Stats lastStats;
+};
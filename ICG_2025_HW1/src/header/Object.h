@@ -1,9 +1,14 @@
+#pragma once
+
 #include <vector>
 #include <string>
 #include <iostream>
+#include <cstring>
+#include <unordered_map>
 #include <glm/glm.hpp>
 #include <glad/glad.h>
 #include <tiny_obj_loader.h>
+#include "MeshOptimizer.h"
 
 using namespace std;
 
@@ -13,28 +18,65 @@ enum class FACETYPE
 	QUAD
 };
 
+// Full attribute tuple of one vertex, used to merge identical face corners
+struct VertexKey
+{
+	float data[8]; // position(3) + normal(3) + texcoord(2)
+
+	bool operator==(const VertexKey& other) const {
+		return memcmp(data, other.data, sizeof(data)) == 0;
+	}
+};
+
+struct VertexKeyHash
+{
+	size_t operator()(const VertexKey& key) const {
+		// FNV-1a over the raw float bits
+		uint32_t bits[8];
+		memcpy(bits, key.data, sizeof(bits));
+		uint64_t h = 14695981039346656037ull;
+		for (int i = 0; i < 8; i++) {
+			h ^= bits[i];
+			h *= 1099511628211ull;
+		}
+		return static_cast<size_t>(h);
+	}
+};
+
 class Object
 {
 public:
 	vector<float> positions;
 	vector<float> normals;
 	vector<float> texcoords;
+	vector<unsigned int> indices;
 	FACETYPE faceType = FACETYPE::TRIANGLE;
 
 	void draw(){
 		glBindVertexArray(VAO);
-		glDrawArrays(GL_TRIANGLES, 0, vertex_cnt);
+		glDrawElements(GL_TRIANGLES, index_cnt, GL_UNSIGNED_INT, (void*)0);
 	}
 
+	// One draw for many copies; per-instance attributes are attached to the VAO by InstancedRenderer
+	void drawInstanced(GLsizei instanceCount){
+		glBindVertexArray(VAO);
+		glDrawElementsInstanced(GL_TRIANGLES, index_cnt, GL_UNSIGNED_INT, (void*)0, instanceCount);
+	}
+
+	unsigned int getVAO() const { return VAO; }
+
 	Object(const string& filename)
 	{
 		loadOBJ(filename);
+		optimizeMesh(filename);
 		set_VAO();
 	}
 
 private:
 	unsigned int VAO;
+	unsigned int EBO;
 	int vertex_cnt;
+	int index_cnt;
 
 	void loadOBJ(const string& filename) {
 		vector<tinyobj::shape_t> shapes;
@@ -52,6 +94,15 @@ private:
 			return;
 		}
 
+		// (position, normal, texcoord) -> index of the unique vertex
+		size_t cornerCount = 0;
+		for (const auto& shape : shapes) {
+			cornerCount += shape.mesh.indices.size();
+		}
+		unordered_map<VertexKey, unsigned int, VertexKeyHash> vertexCache;
+		vertexCache.reserve(cornerCount);
+		indices.reserve(cornerCount);
+
 		// Process all shapes
 		for (const auto& shape : shapes) {
 			const tinyobj::mesh_t& mesh = shape.mesh;
@@ -72,116 +123,12 @@ private:
 				if (fv == 3) {
 					// Triangle
 					for (size_t v = 0; v < 3; v++) {
-						unsigned int idx = mesh.indices[index_offset + v];
-						
-						// Positions
-						if (idx * 3 + 2 < mesh.positions.size()) {
-							positions.push_back(mesh.positions[idx * 3 + 0]);
-							positions.push_back(mesh.positions[idx * 3 + 1]);
-							positions.push_back(mesh.positions[idx * 3 + 2]);
-						} else {
-							positions.push_back(0.0f);
-							positions.push_back(0.0f);
-							positions.push_back(0.0f);
-						}
-
-						// Texture coordinates
-						if (!mesh.texcoords.empty() && idx * 2 + 1 < mesh.texcoords.size()) {
-							texcoords.push_back(mesh.texcoords[idx * 2 + 0]);
-							texcoords.push_back(mesh.texcoords[idx * 2 + 1]);
-						} else {
-							texcoords.push_back(0.0f);
-							texcoords.push_back(0.0f);
-						}
-
-						// Normals
-						if (!mesh.normals.empty() && idx * 3 + 2 < mesh.normals.size()) {
-							normals.push_back(mesh.normals[idx * 3 + 0]);
-							normals.push_back(mesh.normals[idx * 3 + 1]);
-							normals.push_back(mesh.normals[idx * 3 + 2]);
-						} else {
-							normals.push_back(0.0f);
-							normals.push_back(1.0f);
-							normals.push_back(0.0f);
-						}
+						addVertex(vertexCache, mesh, mesh.indices[index_offset + v]);
 					}
 				} else if (fv == 4) {
-					// Quad - convert to two triangles
-					vector<unsigned int> quad_indices;
-					for (size_t v = 0; v < 4; v++) {
-						quad_indices.push_back(mesh.indices[index_offset + v]);
-					}
-
-					// First triangle: 0, 1, 2
-					for (int i : {0, 1, 2}) {
-						unsigned int idx = quad_indices[i];
-						
-						// Positions
-						if (idx * 3 + 2 < mesh.positions.size()) {
-							positions.push_back(mesh.positions[idx * 3 + 0]);
-							positions.push_back(mesh.positions[idx * 3 + 1]);
-							positions.push_back(mesh.positions[idx * 3 + 2]);
-						} else {
-							positions.push_back(0.0f);
-							positions.push_back(0.0f);
-							positions.push_back(0.0f);
-						}
-
-						// Texture coordinates
-						if (!mesh.texcoords.empty() && idx * 2 + 1 < mesh.texcoords.size()) {
-							texcoords.push_back(mesh.texcoords[idx * 2 + 0]);
-							texcoords.push_back(mesh.texcoords[idx * 2 + 1]);
-						} else {
-							texcoords.push_back(0.0f);
-							texcoords.push_back(0.0f);
-						}
-
-						// Normals
-						if (!mesh.normals.empty() && idx * 3 + 2 < mesh.normals.size()) {
-							normals.push_back(mesh.normals[idx * 3 + 0]);
-							normals.push_back(mesh.normals[idx * 3 + 1]);
-							normals.push_back(mesh.normals[idx * 3 + 2]);
-						} else {
-							normals.push_back(0.0f);
-							normals.push_back(1.0f);
-							normals.push_back(0.0f);
-						}
-					}
-
-					// Second triangle: 0, 2, 3
-					for (int i : {0, 2, 3}) {
-						unsigned int idx = quad_indices[i];
-						
-						// Positions
-						if (idx * 3 + 2 < mesh.positions.size()) {
-							positions.push_back(mesh.positions[idx * 3 + 0]);
-							positions.push_back(mesh.positions[idx * 3 + 1]);
-							positions.push_back(mesh.positions[idx * 3 + 2]);
-						} else {
-							positions.push_back(0.0f);
-							positions.push_back(0.0f);
-							positions.push_back(0.0f);
-						}
-
-						// Texture coordinates
-						if (!mesh.texcoords.empty() && idx * 2 + 1 < mesh.texcoords.size()) {
-							texcoords.push_back(mesh.texcoords[idx * 2 + 0]);
-							texcoords.push_back(mesh.texcoords[idx * 2 + 1]);
-						} else {
-							texcoords.push_back(0.0f);
-							texcoords.push_back(0.0f);
-						}
-
-						// Normals
-						if (!mesh.normals.empty() && idx * 3 + 2 < mesh.normals.size()) {
-							normals.push_back(mesh.normals[idx * 3 + 0]);
-							normals.push_back(mesh.normals[idx * 3 + 1]);
-							normals.push_back(mesh.normals[idx * 3 + 2]);
-						} else {
-							normals.push_back(0.0f);
-							normals.push_back(1.0f);
-							normals.push_back(0.0f);
-						}
+					// Quad - convert to two triangles (0, 1, 2) and (0, 2, 3)
+					for (int i : {0, 1, 2, 0, 2, 3}) {
+						addVertex(vertexCache, mesh, mesh.indices[index_offset + i]);
 					}
 				}
 				
@@ -190,11 +137,84 @@ private:
 		}
 	}
 
+	// Emit one face corner, reusing an existing vertex when the same attributes were seen before
+	void addVertex(unordered_map<VertexKey, unsigned int, VertexKeyHash>& vertexCache,
+	               const tinyobj::mesh_t& mesh, unsigned int idx) {
+		VertexKey key;
+
+		// Positions
+		if (idx * 3 + 2 < mesh.positions.size()) {
+			key.data[0] = mesh.positions[idx * 3 + 0];
+			key.data[1] = mesh.positions[idx * 3 + 1];
+			key.data[2] = mesh.positions[idx * 3 + 2];
+		} else {
+			key.data[0] = 0.0f;
+			key.data[1] = 0.0f;
+			key.data[2] = 0.0f;
+		}
+
+		// Normals
+		if (!mesh.normals.empty() && idx * 3 + 2 < mesh.normals.size()) {
+			key.data[3] = mesh.normals[idx * 3 + 0];
+			key.data[4] = mesh.normals[idx * 3 + 1];
+			key.data[5] = mesh.normals[idx * 3 + 2];
+		} else {
+			key.data[3] = 0.0f;
+			key.data[4] = 1.0f;
+			key.data[5] = 0.0f;
+		}
+
+		// Texture coordinates
+		if (!mesh.texcoords.empty() && idx * 2 + 1 < mesh.texcoords.size()) {
+			key.data[6] = mesh.texcoords[idx * 2 + 0];
+			key.data[7] = mesh.texcoords[idx * 2 + 1];
+		} else {
+			key.data[6] = 0.0f;
+			key.data[7] = 0.0f;
+		}
+
+		unsigned int newIndex = static_cast<unsigned int>(positions.size() / 3);
+		auto inserted = vertexCache.emplace(key, newIndex);
+		if (!inserted.second) {
+			indices.push_back(inserted.first->second);
+			return;
+		}
+
+		positions.insert(positions.end(), key.data + 0, key.data + 3);
+		normals.insert(normals.end(), key.data + 3, key.data + 6);
+		texcoords.insert(texcoords.end(), key.data + 6, key.data + 8);
+		indices.push_back(newIndex);
+	}
+
+	// Reorder triangles for the post-transform cache and overdraw, then vertices for fetch locality
+	void optimizeMesh(const string& filename) {
+		size_t vertexCount = positions.size() / 3;
+		if (indices.empty() || vertexCount == 0) return;
+
+		VertexCacheStats before = analyzeVertexCache(indices, vertexCount);
+
+		vector<unsigned int> clusters;
+		optimizeVertexCache(indices, vertexCount, clusters);
+		optimizeOverdraw(indices, positions, clusters);
+
+		vector<unsigned int> remap;
+		size_t newVertexCount = optimizeVertexFetch(indices, vertexCount, remap);
+		remapVertexAttribute(positions, 3, remap, newVertexCount);
+		remapVertexAttribute(normals, 3, remap, newVertexCount);
+		remapVertexAttribute(texcoords, 2, remap, newVertexCount);
+
+		VertexCacheStats after = analyzeVertexCache(indices, newVertexCount);
+		cout << filename << ": " << newVertexCount << " vertices, " << indices.size() / 3 << " triangles, "
+		     << "ACMR " << before.acmr << " -> " << after.acmr << ", "
+		     << "ATVR " << before.atvr << " -> " << after.atvr << endl;
+	}
+
 	void set_VAO(){
 		unsigned int VBO[3];
 		glGenVertexArrays(1, &VAO);
 		glBindVertexArray(VAO);
 		glGenBuffers(3, VBO);
+		glGenBuffers(1, &EBO);
 
 		// Positions
 		if (!positions.empty()) {
@@ -220,13 +240,19 @@ private:
 			glEnableVertexAttribArray(2);
 		}
 
+		// Indices (the element buffer binding is stored in the VAO)
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * indices.size(), indices.data(), GL_STATIC_DRAW);
+
 		glBindVertexArray(0);
 
 		vertex_cnt = positions.size() / 3;
+		index_cnt = indices.size();
 		
-		// Clear vectors to save memory after uploading to GPU
-		positions.clear();
-		texcoords.clear();
-		normals.clear();
+		// Free the CPU copies after uploading to GPU (clear() would keep the capacity)
+		vector<float>().swap(positions);
+		vector<float>().swap(texcoords);
+		vector<float>().swap(normals);
+		vector<unsigned int>().swap(indices);
 	}
 };
@@ -130,6 +130,10 @@ public:
         glUniform4fv(glGetUniformLocation(this->ID, name.c_str()), 1, glm::value_ptr(value));
     }
 
+    void set_uniform(const string &name, glm::mat3 value) const{
+        glUniformMatrix3fv(glGetUniformLocation(this->ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(value));
+    }
+
     void set_uniform(const string &name, glm::mat4 value) const{
         glUniformMatrix4fv(glGetUniformLocation(this->ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(value));
     }
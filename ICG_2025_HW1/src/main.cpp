@@ -11,6 +11,8 @@
 
 #include "./header/Shader.h"
 #include "./header/Object.h"
+#include "./header/Transform.h"
+#include "./header/InstancedRenderer.h"
 
 // Settings
 const int INITIAL_SCR_WIDTH = 800;
@@ -30,11 +32,21 @@ Object* cube = nullptr;
 Object* fish1 = nullptr;
 Object* fish2 = nullptr;
 Object* fish3 = nullptr;
+InstancedRenderer* renderer = nullptr;
+
+// Instanced renderer mesh ids, registered in this order by init()
+enum MeshType { MESH_CUBE, MESH_FISH1, MESH_FISH2, MESH_FISH3 };
+
+// Stress test (toggled with T): adds STRESS_SEAWEED_COUNT seaweeds and STRESS_FISH_COUNT fish
+const int STRESS_SEAWEED_COUNT = 10000;
+const int STRESS_FISH_COUNT = 10000;
+bool stressTest = false;
 
 struct Fish {
     glm::vec3 position;
     glm::vec3 direction;
     std::string fishType = "fish1";
+    MeshType mesh = MESH_FISH1; // resolved from fishType once, not per draw
     float angle = 0.0f;
     float speed = 3.0f;
     glm::vec3 scale = glm::vec3(2.0f, 2.0f, 2.0f);
@@ -89,15 +101,18 @@ float globalTime = 0.0f;
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
 void processInput(GLFWwindow* window, float deltaTime);
-void drawModel(std::string type, const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& color);
-void drawPlayerFish(const glm::vec3& position, float angle, float tailPhase,
-                    const glm::mat4& view, const glm::mat4& projection, bool mouthOpen, float deltaTime);
+void drawModel(MeshType type, const glm::mat4& model, const glm::vec3& color);
+MeshType meshTypeOf(const std::string& fishType);
+void reportFrameStats(float deltaTime);
+void drawPlayerFish(const glm::vec3& position, float angle, float tailPhase, bool mouthOpen, float deltaTime);
 void updateSchoolFish(float deltaTime);
 void initializeAquarium();
+void clearSeaweeds();
+void addStressAquarium();
 void cleanup();
 void init();
 void updateFireballs(float deltaTime);
-void drawFireballs(const glm::mat4& view, const glm::mat4& projection);
+void drawFireballs();
 
 int main() {
     // Initialize random seed for aquarium elements
@@ -163,17 +178,17 @@ int main() {
         1. translate
         glm::mat4 model(1.0f);
         model = glm::translate(model, glm::vec3(2.0f, 1.0f, 0.0f));
-        drawModel("cube",model,view,projection, glm::vec3(0.9f, 0.8f, 0.6f));
+        drawModel(MESH_CUBE, model, glm::vec3(0.9f, 0.8f, 0.6f));
         
         2. scale
         glm::mat4 model(1.0f);
         model = glm::scale(model, glm::vec3(0.5f, 1.0f, 2.0f)); 
-        drawModel("cube",model,view,projection, glm::vec3(0.9f, 0.8f, 0.6f));
+        drawModel(MESH_CUBE, model, glm::vec3(0.9f, 0.8f, 0.6f));
         
         3. rotate
         glm::mat4 model(1.0f);
         model = glm::rotate(model, glm::radians(45.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        drawModel("cube",model,view,projection, glm::vec3(0.9f, 0.8f, 0.6f));
+        drawModel(MESH_CUBE, model, glm::vec3(0.9f, 0.8f, 0.6f));
         ==============================================================================*/
 
         // TODO: Create model, view, and perspective matrix
@@ -185,13 +200,16 @@ int main() {
                                                 (float)SCR_WIDTH / (float)SCR_HEIGHT, 
                                                 0.1f, 
                                                 1000.0f);
+        // Shared by every instance, so set once per frame
+        shader->set_uniform("view", view);
+        shader->set_uniform("projection", projection);
 
         // TODO: Aquarium Base
         glm::mat4 model(1.0f);
         model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
         model = glm::scale(model, glm::vec3(70.0f, 1.0f, 40.0f));
         glm::vec3 color(0.9f, 0.8f, 0.6f);
-        drawModel("cube", model, view, projection, color);
+        drawModel(MESH_CUBE, model, color);
         // TODO: Draw seaweeds with hierarchical structure and wave motion
         // Wave motion is sine wave based on global time and segment phase
         // Each segment sways slightly differently for natural effect
@@ -215,7 +233,7 @@ int main() {
                 glm::mat4 model = parentModel * rotationModel; // 在位置還在local原點的時候，先做rotation
                 model = glm::translate(model, glm::vec3(0.0f, current_segment->scale.y / 2.0f, 0.0f));
                 model = glm::scale(model, current_segment->scale);
-                drawModel("cube", model, view, projection, current_segment->color);
+                drawModel(MESH_CUBE, model, current_segment->color);
                 glm::mat4 topModel = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, current_segment->scale.y, 0.0f)); // 海草頂端
                 parentModel = parentModel * rotationModel * topModel; // 該segment的頂點 -> 下一segment的起點
                 current_segment = current_segment->next;
@@ -230,7 +248,7 @@ int main() {
             model = glm::translate(model, fish.position);
             model = glm::rotate(model, fish.angle, glm::vec3(0.0f, 1.0f, 0.0f));
             model = glm::scale(model, fish.scale);
-            drawModel(fish.fishType, model, view, projection, fish.color);
+            drawModel(fish.mesh, model, fish.color);
         }
         // Update aquarium elements
         updateSchoolFish(deltaTime);
@@ -246,13 +264,13 @@ int main() {
         // model = glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f));  
         //  ^-- "angle": Rotate the whole body but in the homework case, no need to rotate the fish.
         // bodyModel = glm::scale(model, glm::vec3(5.0f, 3.0f, 2.5f)); // Elongated for shark body
-        // drawModel("cube", bodyModel, view, projection, glm::vec3(0.4f, 0.4f, 0.6f)); // Dark blue-gray shark color
+        // drawModel(MESH_CUBE, bodyModel, glm::vec3(0.4f, 0.4f, 0.6f)); // Dark blue-gray shark color
         // Reuse "model" for the children of the body.
         // glm::mat4 dorsalFinModel;
         // dorsalFinModel = glm::translate(model, glm::vec3(0.0f, 2.0f, 0.0f));
         // dorsalFinModel = glm::rotate(dorsalFinModel, glm::radians(-50.0f), glm::vec3(0.0f, 0.0f, 1.0f));
         // dorsalFinModel = glm::scale(dorsalFinModel, glm::vec3(3.0f, 1.5f, 1.0f));
-        // drawModel("cube", dorsalFinModel, view, projection, glm::vec3(0.35f, 0.35f, 0.55f)); // Fin color
+        // drawModel(MESH_CUBE, dorsalFinModel, glm::vec3(0.35f, 0.35f, 0.55f)); // Fin color
         //
         // Notice that to keep the scale of the children is not affected by the body scale,
         // you need to apply the inverse scale to the fin model matrix, 
@@ -263,10 +281,14 @@ int main() {
         // To make the tail motion, follow the formula: Amplitude * sin(tailPhase);
 
         drawPlayerFish(playerFish.position, playerFish.angle, playerFish.tailAnimation,
-                        view, projection, playerFish.mouthOpen, deltaTime);
+                        playerFish.mouthOpen, deltaTime);
 
         updateFireballs(deltaTime);
-        drawFireballs(view, projection);
+        drawFireballs();
+
+        // One instanced draw per mesh for everything submitted above
+        renderer->flush();
+        reportFrameStats(deltaTime);
 
         // TODO: Implement input processing
         processInput(window, deltaTime);
@@ -372,22 +394,45 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
     }
 
     // TODO: Implement mouth toggle logic
+
+    if (key == GLFW_KEY_T && action == GLFW_PRESS) {
+        stressTest = !stressTest;
+        initializeAquarium();
+        std::cout << "stress test " << (stressTest ? "on" : "off") << std::endl;
+    }
+}
+
+// Queue one instance; nothing is drawn until renderer->flush() at the end of the frame
+void drawModel(MeshType type, const glm::mat4& model, const glm::vec3& color) {
+    renderer->submit(type, model, color);
+}
+
+MeshType meshTypeOf(const std::string& fishType) {
+    if (fishType == "fish1") return MESH_FISH1;
+    if (fishType == "fish2") return MESH_FISH2;
+    if (fishType == "fish3") return MESH_FISH3;
+    return MESH_CUBE;
 }
 
-void drawModel(std::string type, const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& color) {
-    shader->set_uniform("projection", projection);
-    shader->set_uniform("view", view);
-    shader->set_uniform("model", model);
-    shader->set_uniform("objectColor", color);
-    if (type == "fish1") {
-        fish1->draw();
-    } else if (type == "fish2") {
-        fish2->draw();
-    } else if (type == "fish3") {
-        fish3->draw();
-    }else if (type == "cube") {
-        cube->draw();
+// Instance / draw call counts and frame time, printed once per second while the stress test runs
+void reportFrameStats(float deltaTime) {
+    static float accumulated = 0.0f;
+    static int frames = 0;
+    if (!stressTest) {
+        accumulated = 0.0f;
+        frames = 0;
+        return;
     }
+    accumulated += deltaTime;
+    frames++;
+    if (accumulated < 1.0f) return;
+
+    const InstancedRenderer::Stats& stats = renderer->stats();
+    std::cout << "stress test: " << seaweeds.size() << " seaweeds, " << schoolFish.size() << " fish, "
+              << stats.instances << " instances in " << stats.drawCalls << " draw calls, "
+              << 1000.0f * accumulated / frames << " ms/frame" << std::endl;
+    accumulated = 0.0f;
+    frames = 0;
 }
 
 void init() {
@@ -405,6 +450,25 @@ void init() {
     fish1 = new Object(dirAsset + "fish1.obj");
     fish2 = new Object(dirAsset + "fish2.obj");
     fish3 = new Object(dirAsset + "fish3.obj");
+
+    // Same order as MeshType
+    renderer = new InstancedRenderer();
+    renderer->addMesh(cube);
+    renderer->addMesh(fish1);
+    renderer->addMesh(fish2);
+    renderer->addMesh(fish3);
+}
+
+void clearSeaweeds() {
+    for (auto& seaweed : seaweeds) {
+        SeaweedSegment* current = seaweed.rootSegment;
+        while (current != nullptr) {
+            SeaweedSegment* next = current->next;
+            delete current;
+            current = next;
+        }
+    }
+    seaweeds.clear();
 }
 
 void cleanup() {
@@ -412,21 +476,18 @@ void cleanup() {
         delete shader;
         shader = nullptr;
     }
+
+    if (renderer) {
+        delete renderer;
+        renderer = nullptr;
+    }
     
     if (cube) {
         delete cube;
         cube = nullptr;
     }
     
-    for (auto& seaweed : seaweeds) {
-        SeaweedSegment* current = seaweed.rootSegment;
-        while (current != nullptr) {
-            SeaweedSegment* next = current->next;
-            delete current;
-            current = next;
-        }
-    }
-    seaweeds.clear();
+    clearSeaweeds();
     
     schoolFish.clear();
 }
@@ -439,13 +500,13 @@ void cleanup() {
         // model = glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f));  
         //  ^-- "angle": Rotate the whole body but in the homework case, no need to rotate the fish.
         // bodyModel = glm::scale(model, glm::vec3(5.0f, 3.0f, 2.5f)); // Elongated for shark body
-        // drawModel("cube", bodyModel, view, projection, glm::vec3(0.4f, 0.4f, 0.6f)); // Dark blue-gray shark color
+        // drawModel(MESH_CUBE, bodyModel, glm::vec3(0.4f, 0.4f, 0.6f)); // Dark blue-gray shark color
         // Reuse "model" for the children of the body.
         // glm::mat4 dorsalFinModel;
         // dorsalFinModel = glm::translate(model, glm::vec3(0.0f, 2.0f, 0.0f));
         // dorsalFinModel = glm::rotate(dorsalFinModel, glm::radians(-50.0f), glm::vec3(0.0f, 0.0f, 1.0f));
         // dorsalFinModel = glm::scale(dorsalFinModel, glm::vec3(3.0f, 1.5f, 1.0f));
-        // drawModel("cube", dorsalFinModel, view, projection, glm::vec3(0.35f, 0.35f, 0.55f)); // Fin color
+        // drawModel(MESH_CUBE, dorsalFinModel, glm::vec3(0.35f, 0.35f, 0.55f)); // Fin color
         //
         // Notice that to keep the scale of the children is not affected by the body scale,
         // you need to apply the inverse scale to the fin model matrix, 
@@ -455,8 +516,7 @@ void cleanup() {
         // which is provided as playerFish.tailAnimation that would act as tail phase in the drawPlayerFish().
         // To make the tail motion, follow the formula: Amplitude * sin(tailPhase);
 
-void drawPlayerFish(const glm::vec3& position, float angle, float tailPhase,
-    const glm::mat4& view, const glm::mat4& projection, bool mouthOpen, float deltaTime) {
+void drawPlayerFish(const glm::vec3& position, float angle, float tailPhase, bool mouthOpen, float deltaTime) {
     glm::mat4 model(1.0f);
 
     // TODO: Draw body using cube (main body)
@@ -464,13 +524,13 @@ void drawPlayerFish(const glm::vec3& position, float angle, float tailPhase,
     model = glm::translate(model, position);
     model = glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f));
     bodyModel = glm::scale(model, glm::vec3(5.0f, 3.0f, 2.5f));
-    drawModel("cube", bodyModel, view, projection, glm::vec3(0.4f, 0.4f, 0.6f));
+    drawModel(MESH_CUBE, bodyModel, glm::vec3(0.4f, 0.4f, 0.6f));
 
     glm::mat4 dorsalFinModel;
     dorsalFinModel = glm::translate(model, glm::vec3(0.0f, 2.0f, 0.0f));
     dorsalFinModel = glm::rotate(dorsalFinModel, glm::radians(-50.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     dorsalFinModel = glm::scale(dorsalFinModel, glm::vec3(3.0f, 1.5f, 1.0f));
-    drawModel("cube", dorsalFinModel, view, projection, glm::vec3(0.35f, 0.35f, 0.55f));
+    drawModel(MESH_CUBE, dorsalFinModel, glm::vec3(0.35f, 0.35f, 0.55f));
 
     // pectoral fin right
     glm::mat4 pectoralFinModel;
@@ -478,13 +538,13 @@ void drawPlayerFish(const glm::vec3& position, float angle, float tailPhase,
     pectoralFinModel = glm::rotate(pectoralFinModel, glm::radians(30.0f), glm::vec3(0.0f, 1.0f, 0.0f));
     pectoralFinModel = glm::rotate(pectoralFinModel, glm::radians(30.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     pectoralFinModel = glm::scale(pectoralFinModel, glm::vec3(3.0f, 0.5f, 1.0f));
-    drawModel("cube", pectoralFinModel, view, projection, glm::vec3(0.35f, 0.35f, 0.55f));
+    drawModel(MESH_CUBE, pectoralFinModel, glm::vec3(0.35f, 0.35f, 0.55f));
     // pectoral fin left
     pectoralFinModel = glm::translate(model, glm::vec3(0.5f, -1.5f, -1.5f));
     pectoralFinModel = glm::rotate(pectoralFinModel, glm::radians(-30.0f), glm::vec3(0.0f, 1.0f, 0.0f));
     pectoralFinModel = glm::rotate(pectoralFinModel, glm::radians(30.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     pectoralFinModel = glm::scale(pectoralFinModel, glm::vec3(3.0f, 0.5f, 1.0f));
-    drawModel("cube", pectoralFinModel, view, projection, glm::vec3(0.35f, 0.35f, 0.55f));
+    drawModel(MESH_CUBE, pectoralFinModel, glm::vec3(0.35f, 0.35f, 0.55f));
 
     // TODO: Draw head and Mouth using cube with mouth open/close feature
 
@@ -515,7 +575,7 @@ void drawPlayerFish(const glm::vec3& position, float angle, float tailPhase,
         glm::vec3 teethScale = glm::vec3(0.3f, abs(y_diff), 0.3f);
         upperTeethRightModel = glm::translate(upperTeethRightModel, glm::vec3(0.0f, y_diff / 2.0f, 0.0f));
         upperTeethRightModel = glm::scale(upperTeethRightModel, teethScale);
-        drawModel("cube", upperTeethRightModel, view, projection, glm::vec3(0.9f, 0.9f, 0.9f));
+        drawModel(MESH_CUBE, upperTeethRightModel, glm::vec3(0.9f, 0.9f, 0.9f));
         // TODO: Upper teeth left
         glm::mat4 upperTeethLeftModel(1.0f);
         upperTeethLeftModel = glm::translate(headModel, playerFish.toothUpperLeft.pos0);// glm::vec3(1.2f, -1.0f, 0.5f));
@@ -524,7 +584,7 @@ void drawPlayerFish(const glm::vec3& position, float angle, float tailPhase,
         teethScale = glm::vec3(0.3f, abs(y_diff), 0.3f);
         upperTeethLeftModel = glm::translate(upperTeethLeftModel, glm::vec3(0.0f, y_diff / 2.0f, 0.0f));
         upperTeethLeftModel = glm::scale(upperTeethLeftModel, teethScale);
-        drawModel("cube", upperTeethLeftModel, view, projection, glm::vec3(0.9f, 0.9f, 0.9f));
+        drawModel(MESH_CUBE, upperTeethLeftModel, glm::vec3(0.9f, 0.9f, 0.9f));
         // TODO: Lower teeth right
         glm::mat4 lowerTeethRightModel(1.0f);
         lowerTeethRightModel = glm::translate(jawModel, playerFish.toothLowerRight.pos0);
@@ -533,7 +593,7 @@ void drawPlayerFish(const glm::vec3& position, float angle, float tailPhase,
         teethScale = glm::vec3(0.3f, abs(y_diff), 0.3f);
         lowerTeethRightModel = glm::translate(lowerTeethRightModel, glm::vec3(0.0f, y_diff / 2.0f, 0.0f));
         lowerTeethRightModel = glm::scale(lowerTeethRightModel, teethScale);
-        drawModel("cube", lowerTeethRightModel, view, projection, glm::vec3(0.9f, 0.9f, 0.9f));
+        drawModel(MESH_CUBE, lowerTeethRightModel, glm::vec3(0.9f, 0.9f, 0.9f));
         // TODO: Lower teeth left
         glm::mat4 lowerTeethLeftModel(1.0f);
         lowerTeethLeftModel = glm::translate(jawModel, playerFish.toothLowerLeft.pos0);
@@ -542,7 +602,7 @@ void drawPlayerFish(const glm::vec3& position, float angle, float tailPhase,
         teethScale = glm::vec3(0.3f, abs(y_diff), 0.3f);
         lowerTeethLeftModel = glm::translate(lowerTeethLeftModel, glm::vec3(0.0f, y_diff / 2.0f, 0.0f));
         lowerTeethLeftModel = glm::scale(lowerTeethLeftModel, teethScale);
-        drawModel("cube", lowerTeethLeftModel, view, projection, glm::vec3(0.9f, 0.9f, 0.9f));
+        drawModel(MESH_CUBE, lowerTeethLeftModel, glm::vec3(0.9f, 0.9f, 0.9f));
         
     } else {
         playerFish.elapsed = 0.0f;
@@ -550,9 +610,9 @@ void drawPlayerFish(const glm::vec3& position, float angle, float tailPhase,
     } 
 
     glm::mat4 scaled_headModel = glm::scale(headModel, glm::vec3(3.0f, 2.0f, 2.3f));
-    drawModel("cube", scaled_headModel, view, projection, glm::vec3(0.35f, 0.35f, 0.55f));
+    drawModel(MESH_CUBE, scaled_headModel, glm::vec3(0.35f, 0.35f, 0.55f));
     jawModel = glm::scale(jawModel, glm::vec3(2.0f, 0.9f, 2.2f));
-    drawModel("cube", jawModel, view, projection, glm::vec3(0.9f, 0.9f, 0.9f));
+    drawModel(MESH_CUBE, jawModel, glm::vec3(0.9f, 0.9f, 0.9f));
 
 
     // TODO: Draw Eyes right
@@ -560,23 +620,23 @@ void drawPlayerFish(const glm::vec3& position, float angle, float tailPhase,
     eyeWhiteModel = glm::translate(headModel, glm::vec3(0.0f, 0.0f, 1.15f));
     eyeWhiteModel = glm::rotate(eyeWhiteModel, glm::radians(30.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     glm::mat4 scaled_eyeWhiteModel = glm::scale(eyeWhiteModel, glm::vec3(0.5f, 0.5f, 0.1f));
-    drawModel("cube", scaled_eyeWhiteModel, view, projection, glm::vec3(1.0f, 1.0f, 1.0f));
+    drawModel(MESH_CUBE, scaled_eyeWhiteModel, glm::vec3(1.0f, 1.0f, 1.0f));
 
     glm::mat4 eyeBlackModel;
     eyeBlackModel = glm::translate(eyeWhiteModel, glm::vec3(0.0f, 0.0f, 0.1f));
     glm::mat4 scaled_eyeBlackModel = glm::scale(eyeBlackModel, glm::vec3(0.3f, 0.3f, 0.1f));
-    drawModel("cube", scaled_eyeBlackModel, view, projection, glm::vec3(0.0f, 0.0f, 0.0f));
+    drawModel(MESH_CUBE, scaled_eyeBlackModel, glm::vec3(0.0f, 0.0f, 0.0f));
 
 
     // TODO: Draw Eyes left
     eyeWhiteModel = glm::translate(headModel, glm::vec3(0.0f, 0.0f, -1.15f));
     eyeWhiteModel = glm::rotate(eyeWhiteModel, glm::radians(30.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     scaled_eyeWhiteModel = glm::scale(eyeWhiteModel, glm::vec3(0.5f, 0.5f, 0.1f));
-    drawModel("cube", scaled_eyeWhiteModel, view, projection, glm::vec3(1.0f, 1.0f, 1.0f));
+    drawModel(MESH_CUBE, scaled_eyeWhiteModel, glm::vec3(1.0f, 1.0f, 1.0f));
 
     eyeBlackModel = glm::translate(eyeWhiteModel, glm::vec3(0.0f, 0.0f, -0.1f));
     scaled_eyeBlackModel = glm::scale(eyeBlackModel, glm::vec3(0.3f, 0.3f, 0.1f));
-    drawModel("cube", scaled_eyeBlackModel, view, projection, glm::vec3(0.0f, 0.0f, 0.0f));
+    drawModel(MESH_CUBE, scaled_eyeBlackModel, glm::vec3(0.0f, 0.0f, 0.0f));
 
     // TODO: Draw hierarchical animated tail with multiple segments
     glm::mat4 tailModel1;
@@ -585,27 +645,27 @@ void drawPlayerFish(const glm::vec3& position, float angle, float tailPhase,
     tailModel1 = glm::rotate(tailModel1, glm::radians(20.0f * sin(tailPhase * 0.5f)), glm::vec3(0.0f, 1.0f, 0.0f));
     tailModel1 = glm::translate(tailModel1, glm::vec3(-2.0f, 0.0f, 0.0f));
     glm::mat4 scaled_tailModel1 = glm::scale(tailModel1, glm::vec3(4.0f, 1.3f, 1.7f));
-    drawModel("cube", scaled_tailModel1, view, projection, glm::vec3(0.4f, 0.4f, 0.6f));
+    drawModel(MESH_CUBE, scaled_tailModel1, glm::vec3(0.4f, 0.4f, 0.6f));
     glm::mat4 tailModel2;
     tailModel2 = glm::translate(tailModel1, glm::vec3(-2.5f, 0.0f, 0.0f));
     tailModel2 = glm::translate(tailModel2, glm::vec3(1.5f, 0.0f, 0.0f));
     tailModel2 = glm::rotate(tailModel2, glm::radians(20.0f * sin(tailPhase * 0.5f)), glm::vec3(0.0f, 1.0f, 0.0f));
     tailModel2 = glm::translate(tailModel2, glm::vec3(-1.5f, 0.0f, 0.0f));
     glm::mat4 scaled_tailModel2 = glm::scale(tailModel2, glm::vec3(3.0f, 1.0f, 1.2f));
-    drawModel("cube", scaled_tailModel2, view, projection, glm::vec3(0.4f, 0.4f, 0.6f));
+    drawModel(MESH_CUBE, scaled_tailModel2, glm::vec3(0.4f, 0.4f, 0.6f));
     glm::mat4 tailModel3;
     tailModel3 = glm::translate(tailModel2, glm::vec3(-2.0f, 0.0f, 0.0f));
     tailModel3 = glm::translate(tailModel3, glm::vec3(1.0f, 0.0f, 0.0f));
     tailModel3 = glm::rotate(tailModel3, glm::radians(20.0f * sin(tailPhase  * 0.5f)), glm::vec3(0.0f, 1.0f, 0.0f));
     tailModel3 = glm::translate(tailModel3, glm::vec3(-1.0f, 0.0f, 0.0f));
     glm::mat4 scaled_tailModel3 = glm::scale(tailModel3, glm::vec3(2.0f, 0.7f, 0.7f));
-    drawModel("cube", scaled_tailModel3, view, projection, glm::vec3(0.4f, 0.4f, 0.6f));
+    drawModel(MESH_CUBE, scaled_tailModel3, glm::vec3(0.4f, 0.4f, 0.6f));
 
     // TODO: Draw tail fin at the end
     glm::mat4 tailFinModel;
     tailFinModel = glm::translate(tailModel3, glm::vec3(-1.0f, 0.0f, 0.0f));
     tailFinModel = glm::scale(tailFinModel, glm::vec3(0.8f, 4.0f, 0.5f));
-    drawModel("cube", tailFinModel, view, projection, glm::vec3(0.35f, 0.35f, 0.55f));
+    drawModel(MESH_CUBE, tailFinModel, glm::vec3(0.35f, 0.35f, 0.55f));
 
     // RGB stripe right
     glm::mat4 stripeModel;
@@ -613,41 +673,41 @@ void drawPlayerFish(const glm::vec3& position, float angle, float tailPhase,
     stripeModel = glm::rotate(stripeModel, glm::radians(-20.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     stripeModel = glm::scale(stripeModel, glm::vec3(0.2f, 1.5f, 0.2f));
     float RTime = abs(sin(globalTime));
-    drawModel("cube", stripeModel, view, projection, glm::vec3(RTime, 0.0f, 0.0f));
+    drawModel(MESH_CUBE, stripeModel, glm::vec3(RTime, 0.0f, 0.0f));
     stripeModel = glm::translate(model, glm::vec3(1.7f, 0.0f, 1.25f));
     stripeModel = glm::rotate(stripeModel, glm::radians(-20.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     stripeModel = glm::scale(stripeModel, glm::vec3(0.2f, 1.5f, 0.2f));
     float GTime = abs(sin(globalTime + 0.2));
-    drawModel("cube", stripeModel, view, projection, glm::vec3(0.0f, GTime, 0.0f));
+    drawModel(MESH_CUBE, stripeModel, glm::vec3(0.0f, GTime, 0.0f));
     stripeModel = glm::translate(model, glm::vec3(2.1f, 0.0f, 1.25f));
     stripeModel = glm::rotate(stripeModel, glm::radians(-20.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     stripeModel = glm::scale(stripeModel, glm::vec3(0.2f, 1.5f, 0.2f));
     float BTime = abs(sin(globalTime + 0.4));
-    drawModel("cube", stripeModel, view, projection, glm::vec3(0.0f, 0.0f, BTime));
+    drawModel(MESH_CUBE, stripeModel, glm::vec3(0.0f, 0.0f, BTime));
 
     // RGB stripe left
     stripeModel = glm::translate(model, glm::vec3(1.3f, 0.0f, -1.25f));
     stripeModel = glm::rotate(stripeModel, glm::radians(-20.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     stripeModel = glm::scale(stripeModel, glm::vec3(0.2f, 1.5f, 0.2f));
-    drawModel("cube", stripeModel, view, projection, glm::vec3(RTime, 0.0f, 0.0f));
+    drawModel(MESH_CUBE, stripeModel, glm::vec3(RTime, 0.0f, 0.0f));
     stripeModel = glm::translate(model, glm::vec3(1.7f, 0.0f, -1.25f));
     stripeModel = glm::rotate(stripeModel, glm::radians(-20.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     stripeModel = glm::scale(stripeModel, glm::vec3(0.2f, 1.5f, 0.2f));
-    drawModel("cube", stripeModel, view, projection, glm::vec3(0.0f, GTime, 0.0f));
+    drawModel(MESH_CUBE, stripeModel, glm::vec3(0.0f, GTime, 0.0f));
     stripeModel = glm::translate(model, glm::vec3(2.1f, 0.0f, -1.25f));
     stripeModel = glm::rotate(stripeModel, glm::radians(-20.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     stripeModel = glm::scale(stripeModel, glm::vec3(0.2f, 1.5f, 0.2f));
-    drawModel("cube", stripeModel, view, projection, glm::vec3(0.0f, 0.0f, BTime));
+    drawModel(MESH_CUBE, stripeModel, glm::vec3(0.0f, 0.0f, BTime));
 
     // Rocket right
     glm::mat4 rocketShellModel;
     rocketShellModel = glm::translate(model, glm::vec3(-2.3f, -1.3f, 1.25f + 0.5f));
     rocketShellModel = glm::scale(rocketShellModel, glm::vec3(2.0f, 1.0f, 1.0f));
-    drawModel("cube", rocketShellModel, view, projection, glm::vec3(0.7f, 0.7f, 0.7f));
+    drawModel(MESH_CUBE, rocketShellModel, glm::vec3(0.7f, 0.7f, 0.7f));
     glm::mat4 rocketFireModel;
     rocketFireModel = glm::translate(model, glm::vec3(-2.4f, -1.3f, 1.25f + 0.5f));
     glm::mat4 scaled_rocketFireModel = glm::scale(rocketFireModel, glm::vec3(2.0f, 0.7f, 0.7f));
-    drawModel("cube", scaled_rocketFireModel, view, projection, glm::vec3(1.0f, 0.2f, 0.0f));
+    drawModel(MESH_CUBE, scaled_rocketFireModel, glm::vec3(1.0f, 0.2f, 0.0f));
     // 粒子效果
     if(playerFish.rocketOpen){
         const int particleCount = 10; // 粒子數量
@@ -674,7 +734,7 @@ void drawPlayerFish(const glm::vec3& position, float angle, float tailPhase,
                 0.0f
             );
 
-            drawModel("cube", particleModel, view, projection, color);
+            drawModel(MESH_CUBE, particleModel, color);
         }
     }
 
@@ -682,11 +742,11 @@ void drawPlayerFish(const glm::vec3& position, float angle, float tailPhase,
     rocketShellModel;
     rocketShellModel = glm::translate(model, glm::vec3(-2.3f, -1.3f, -1.25f - 0.35f));
     rocketShellModel = glm::scale(rocketShellModel, glm::vec3(2.0f, 1.0f, 1.0f));
-    drawModel("cube", rocketShellModel, view, projection, glm::vec3(0.7f, 0.7f, 0.7f));
+    drawModel(MESH_CUBE, rocketShellModel, glm::vec3(0.7f, 0.7f, 0.7f));
     rocketFireModel;
     rocketFireModel = glm::translate(model, glm::vec3(-2.4f, -1.3f, -1.25f - 0.35f));
     scaled_rocketFireModel = glm::scale(rocketFireModel, glm::vec3(2.0f, 0.7f, 0.7f));
-    drawModel("cube", scaled_rocketFireModel, view, projection, glm::vec3(1.0f, 0.2f, 0.0f));
+    drawModel(MESH_CUBE, scaled_rocketFireModel, glm::vec3(1.0f, 0.2f, 0.0f));
     // 粒子效果
     if(playerFish.rocketOpen){
         const int particleCount = 10; // 粒子數量
@@ -713,7 +773,7 @@ void drawPlayerFish(const glm::vec3& position, float angle, float tailPhase,
                 0.0f
             );
 
-            drawModel("cube", particleModel, view, projection, color);
+            drawModel(MESH_CUBE, particleModel, color);
         }
     }
 
@@ -741,19 +801,19 @@ void updateSchoolFish(float deltaTime) {
     }
 }
 
-void drawFireballs(const glm::mat4& view, const glm::mat4& projection) {
+void drawFireballs() {
     for (const auto& fireball : fireballs) {
         glm::mat4 model(1.0f);
         model = glm::translate(model, fireball.position);
         model = glm::rotate(model, playerFish.angle, glm::vec3(0.0f, 1.0f, 0.0f));
         glm::mat4 scaled_model = glm::scale(model, glm::vec3(0.5f, 1.0f, 1.0f));
-        drawModel("cube", scaled_model, view, projection, glm::vec3(1.0f, 0.3f, 0.0f));
+        drawModel(MESH_CUBE, scaled_model, glm::vec3(1.0f, 0.3f, 0.0f));
         model = glm::translate(model, glm::vec3(0.25f + 0.15f, 0.0f, 0.0f));
         scaled_model = glm::scale(model, glm::vec3(0.3f, 0.95f, 0.95f));
-        drawModel("cube", scaled_model, view, projection, glm::vec3(1.0f, 0.5f, 0.0f));
+        drawModel(MESH_CUBE, scaled_model, glm::vec3(1.0f, 0.5f, 0.0f));
         model = glm::translate(model, glm::vec3(0.15f + 0.1f, 0.0f, 0.0f));
         scaled_model = glm::scale(model, glm::vec3(0.2f, 0.9f, 0.9f));
-        drawModel("cube", scaled_model, view, projection, glm::vec3(1.0f, 0.7f, 0.0f));
+        drawModel(MESH_CUBE, scaled_model, glm::vec3(1.0f, 0.7f, 0.0f));
 
         // 粒子效果
         const int particleCount = 10; // 粒子數量
@@ -779,7 +839,7 @@ void drawFireballs(const glm::mat4& view, const glm::mat4& projection) {
                 0.0f
             );
 
-            drawModel("cube", particleModel, view, projection, color);
+            drawModel(MESH_CUBE, particleModel, color);
         }
 
     }
@@ -822,12 +882,13 @@ void initializeAquarium() {
         fish.scale = std::get<1>(props);
         fish.direction = glm::normalize(std::get<2>(props));
         fish.fishType = name;
+        fish.mesh = meshTypeOf(name);
         fish.color = glm::vec3(static_cast<float>(rand()) / RAND_MAX, static_cast<float>(rand()) / RAND_MAX, static_cast<float>(rand()) / RAND_MAX);
         schoolFish.push_back(fish);
     }
 
     // Seaweeds
-    seaweeds.clear();
+    clearSeaweeds();
     const std::map<std::string, std::tuple<glm::vec3, SeaweedSegment*, float>> SeaweedPropertys {
         // name, basePosition, rootSegment, swayOffset
         {"seaweed1", {glm::vec3(7.0f, 0.0f, 0.0f),
@@ -864,4 +925,38 @@ void initializeAquarium() {
         seaweeds.push_back(seaweed);
     }
 
+    if (stressTest) addStressAquarium();
+}
+
+// Scatter STRESS_SEAWEED_COUNT seaweeds over the base and STRESS_FISH_COUNT fish through the tank
+void addStressAquarium() {
+    auto random = [](float lo, float hi) { return lo + (hi - lo) * static_cast<float>(rand()) / RAND_MAX; };
+
+    seaweeds.reserve(seaweeds.size() + STRESS_SEAWEED_COUNT);
+    for (int i = 0; i < STRESS_SEAWEED_COUNT; i++) {
+        Seaweed seaweed;
+        seaweed.basePosition = glm::vec3(random(-34.0f, 34.0f), 0.0f, random(-19.0f, 19.0f));
+        seaweed.swayOffset = random(0.0f, 10.0f);
+        seaweed.rootSegment = new SeaweedSegment(glm::vec3(0.0f), glm::vec3(0.0f, random(0.5f, 0.9f), 0.0f), 0.0f, glm::vec3(1.0f, 2.0f, 1.0f));
+        SeaweedSegment* current = seaweed.rootSegment;
+        for (int j = 2; j <= 7; j++) {
+            current->next = new SeaweedSegment(current->localPos, current->color, current->phase + 0.5f, current->scale);
+            current = current->next;
+        }
+        seaweeds.push_back(seaweed);
+    }
+
+    const char* fishTypes[] = {"fish1", "fish2", "fish3"};
+    schoolFish.reserve(schoolFish.size() + STRESS_FISH_COUNT);
+    for (int i = 0; i < STRESS_FISH_COUNT; i++) {
+        Fish fish;
+        fish.fishType = fishTypes[rand() % 3];
+        fish.mesh = meshTypeOf(fish.fishType);
+        fish.position = glm::vec3(random(-AQUARIUM_BOUNDARY + 2.0f, AQUARIUM_BOUNDARY - 2.0f), random(1.0f, 20.0f), random(-19.0f, 19.0f));
+        fish.direction = glm::vec3(rand() % 2 ? 1.0f : -1.0f, 0.0f, 0.0f);
+        fish.angle = atan2(-fish.direction.z, fish.direction.x);
+        fish.speed = random(1.0f, 5.0f);
+        fish.color = glm::vec3(random(0.0f, 1.0f), random(0.0f, 1.0f), random(0.0f, 1.0f));
+        schoolFish.push_back(fish);
+    }
 }
\ No newline at end of file
@@ -5,7 +5,7 @@ in vec3 Normal;
 in vec3 FragPos;  
 in vec2 TexCoord; 
 
-uniform vec3 objectColor; 
+flat in vec3 Color; // objectColor, per instance
 
 void main()
 {
@@ -18,6 +18,6 @@ void main()
     float diff = max(dot(norm, lightDir), 0.0);
     vec3 diffuse = diff * lightColor;
         
-    vec3 result = diffuse * objectColor;
+    vec3 result = diffuse * Color;
     FragColor = vec4(result, 1.0);
 } 
\ No newline at end of file
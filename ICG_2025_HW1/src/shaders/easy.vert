@@ -3,18 +3,24 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
 
+// Per instance (glVertexAttribDivisor 1), filled by InstancedRenderer
+layout (location = 3) in mat4 instanceModel;
+layout (location = 7) in mat3 instanceNormalMatrix; // inverse transpose of model, from the CPU
+layout (location = 10) in vec3 instanceColor;
+
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoord;
+flat out vec3 Color;
 
-uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;  
+    FragPos = vec3(instanceModel * vec4(aPos, 1.0));
+    Normal = instanceNormalMatrix * aNormal;  
     TexCoord = aTexCoord;
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    Color = instanceColor;
+    gl_Position = projection * view * instanceModel * vec4(aPos, 1.0);
 }
\ No newline at end of file
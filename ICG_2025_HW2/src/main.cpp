@@ -190,7 +190,7 @@ int main() {
         glUniform1i(texLoc, 0); // 告訴shader ground texture在texture unit 0 (texture location的第0個)
         
 	    glBindVertexArray(groundVAO); // bind vao, 載入vbo設定，就不用重新設定vbo的load
-	    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(groundObject->positions.size() / 3)); // 把shader內的vertex跑一遍，用三角形polygon畫出來
+	    glDrawElements(GL_TRIANGLES, groundObject->indexCount(), GL_UNSIGNED_INT, (void*)0); // 把shader內的vertex跑一遍，用三角形polygon畫出來
         
 
 
@@ -223,7 +223,7 @@ int main() {
         glUniform1i(texLoc, 0);
         
 	    glBindVertexArray(columnVAO);
-	    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(columnObject->positions.size() / 3));
+	    glDrawElements(GL_TRIANGLES, columnObject->indexCount(), GL_UNSIGNED_INT, (void*)0);
 
         /* TODO#6-3: Render Fish
          *    1. Set up fish model matrix.
@@ -254,7 +254,7 @@ int main() {
         glUniform1i(texLoc, 0);
         
 	    glBindVertexArray(fishVAO);
-	    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(fishObject->positions.size() / 3));
+	    glDrawElements(GL_TRIANGLES, fishObject->indexCount(), GL_UNSIGNED_INT, (void*)0);
 
 
         // Status update
@@ -469,6 +469,14 @@ unsigned int modelVAO(Object &model) {
         glEnableVertexAttribArray(1);
     }
 
+    // index buffer，Object已經把重複的vertex合併，用indices來畫 (EBO的binding會存在VAO裡)
+    unsigned int EBO;
+    glGenBuffers(1, &EBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * model.indices.size(), &model.indices[0], GL_STATIC_DRAW);
+    model.setGpuBytes(sizeof(float) * (model.positions.size() + model.texcoords.size()) +
+                      sizeof(unsigned int) * model.indices.size());
+
     // 解綁
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
@@ -558,5 +566,17 @@ void init() {
     fishVAO = modelVAO(*fishObject);
     columnVAO = modelVAO(*columnObject);
     groundVAO = modelVAO(*groundObject);
+
+    // 上傳到GPU之後就不需要CPU這份了
+    fishObject->releaseCpuData();
+    columnObject->releaseCpuData();
+    groundObject->releaseCpuData();
+
+    std::pair<const char*, Object*> models[] = {{"fish", fishObject}, {"column", columnObject}, {"ground", groundObject}};
+    for (const auto& model : models) {
+        MeshMemory memory = model.second->memoryUsage();
+        std::cout << "mesh " << model.first << ": CPU " << memory.cpuBytes / 1024 << " KB, GPU "
+                  << memory.gpuBytes / 1024 << " KB" << std::endl;
+    }
 }
 
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include <glm/glm.hpp>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define FRUSTUM_SSE 1
+#endif
+
+// Axis aligned box, object space from Object::bounds() or world space from transformBox()
+struct BoundingBox
+{
+	glm::vec3 min = glm::vec3(0.0f);
+	glm::vec3 max = glm::vec3(0.0f);
+
+	glm::vec3 center() const { return (min + max) * 0.5f; }
+	glm::vec3 extent() const { return (max - min) * 0.5f; }
+};
+
+struct BoundingSphere
+{
+	glm::vec3 center = glm::vec3(0.0f);
+	float radius = 0.0f;
+};
+
+// Box that contains 'box' after 'model' (Arvo: the extent goes through |M|)
+inline BoundingBox transformBox(const BoundingBox& box, const glm::mat4& model)
+{
+	glm::vec3 center = glm::vec3(model * glm::vec4(box.center(), 1.0f));
+	glm::mat3 m(model);
+	glm::vec3 e = box.extent();
+	glm::vec3 extent = glm::abs(m[0]) * e.x + glm::abs(m[1]) * e.y + glm::abs(m[2]) * e.z;
+	return {center - extent, center + extent};
+}
+
+// Radius grows with the largest axis scale, so the sphere stays conservative under non-uniform scale
+inline BoundingSphere transformSphere(const BoundingSphere& sphere, const glm::mat4& model)
+{
+	glm::mat3 m(model);
+	float scale2 = glm::max(glm::dot(m[0], m[0]), glm::max(glm::dot(m[1], m[1]), glm::dot(m[2], m[2])));
+	return {glm::vec3(model * glm::vec4(sphere.center, 1.0f)), sphere.radius * std::sqrt(scale2)};
+}
+
+// Six planes (left, right, bottom, top, near, far) as (normal, d) with the normal pointing inside,
+// normalized so dot(normal, p) + d is a distance.
+struct Frustum
+{
+	glm::vec4 planes[6];
+
+	// Gribb / Hartmann: rows of projection * view give the clip planes directly
+	static Frustum fromMatrix(const glm::mat4& viewProjection)
+	{
+		glm::mat4 m = glm::transpose(viewProjection); // m[i] = row i
+		Frustum frustum;
+		frustum.planes[0] = m[3] + m[0];
+		frustum.planes[1] = m[3] - m[0];
+		frustum.planes[2] = m[3] + m[1];
+		frustum.planes[3] = m[3] - m[1];
+		frustum.planes[4] = m[3] + m[2];
+		frustum.planes[5] = m[3] - m[2];
+		for (glm::vec4& plane : frustum.planes) {
+			plane /= glm::length(glm::vec3(plane));
+		}
+		return frustum;
+	}
+
+	bool intersects(const BoundingSphere& sphere) const
+	{
+		for (const glm::vec4& plane : planes) {
+			if (glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius) return false;
+		}
+		return true;
+	}
+
+	// Only the corner furthest along each plane normal needs checking
+	bool intersects(const BoundingBox& box) const
+	{
+		glm::vec3 center = box.center(), extent = box.extent();
+		for (const glm::vec4& plane : planes) {
+			glm::vec3 normal(plane);
+			float reach = glm::dot(glm::abs(normal), extent);
+			if (glm::dot(normal, center) + plane.w < -reach) return false;
+		}
+		return true;
+	}
+};
+
+// Counters over cull() calls since the last reset
+struct CullStats
+{
+	unsigned int tested = 0;
+	unsigned int culled = 0;      // outside, by the sphere or the box test
+	unsigned int culledByBox = 0; // ... of which the sphere still overlapped the frustum
+};
+
+// World space bounds of many objects, culled together. Spheres are kept as separate x / y / z / r
+// arrays so SSE tests four of them against a plane per instruction; the spheres that survive get
+// the tighter box test one by one.
+class FrustumCuller
+{
+public:
+	void clear()
+	{
+		xs.clear(); ys.clear(); zs.clear(); rs.clear();
+		boxes.clear();
+	}
+
+	void add(const BoundingSphere& sphere, const BoundingBox& box)
+	{
+		xs.push_back(sphere.center.x);
+		ys.push_back(sphere.center.y);
+		zs.push_back(sphere.center.z);
+		rs.push_back(sphere.radius);
+		boxes.push_back(box);
+	}
+
+	size_t size() const { return boxes.size(); }
+
+	// visible[i] = object i is at least partly inside. Returns how many are.
+	size_t cull(const Frustum& frustum, std::vector<unsigned char>& visible, CullStats& stats) const
+	{
+		size_t n = size();
+		visible.resize(n);
+		sphereTest(frustum, visible.data(), n);
+
+		size_t count = 0;
+		for (size_t i = 0; i < n; i++) {
+			if (!visible[i]) continue;
+			if (!frustum.intersects(boxes[i])) {
+				visible[i] = 0;
+				stats.culledByBox++;
+				continue;
+			}
+			count++;
+		}
+		stats.tested += (unsigned int)n;
+		stats.culled += (unsigned int)(n - count);
+		return count;
+	}
+
+	// One sphere at a time, for comparison with the SSE path (bench/frustum_cull_bench)
+	void sphereTestScalar(const Frustum& frustum, unsigned char* visible, size_t begin, size_t end) const
+	{
+		for (size_t i = begin; i < end; i++) {
+			visible[i] = frustum.intersects(BoundingSphere{glm::vec3(xs[i], ys[i], zs[i]), rs[i]}) ? 1 : 0;
+		}
+	}
+
+	void sphereTest(const Frustum& frustum, unsigned char* visible, size_t n) const
+	{
+		size_t i = 0;
+#ifdef FRUSTUM_SSE
+		__m128 nx[6], ny[6], nz[6], d[6];
+		for (int p = 0; p < 6; p++) {
+			nx[p] = _mm_set1_ps(frustum.planes[p].x);
+			ny[p] = _mm_set1_ps(frustum.planes[p].y);
+			nz[p] = _mm_set1_ps(frustum.planes[p].z);
+			d[p] = _mm_set1_ps(frustum.planes[p].w);
+		}
+		for (; i + 4 <= n; i += 4) {
+			__m128 x = _mm_loadu_ps(&xs[i]);
+			__m128 y = _mm_loadu_ps(&ys[i]);
+			__m128 z = _mm_loadu_ps(&zs[i]);
+			__m128 negR = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&rs[i]));
+			__m128 outside = _mm_setzero_ps();
+			for (int p = 0; p < 6; p++) {
+				__m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], x), _mm_mul_ps(ny[p], y)),
+				                         _mm_add_ps(_mm_mul_ps(nz[p], z), d[p]));
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, negR));
+			}
+			int mask = _mm_movemask_ps(outside);
+			visible[i + 0] = (mask & 1) ? 0 : 1;
+			visible[i + 1] = (mask & 2) ? 0 : 1;
+			visible[i + 2] = (mask & 4) ? 0 : 1;
+			visible[i + 3] = (mask & 8) ? 0 : 1;
+		}
+#endif
+		sphereTestScalar(frustum, visible, i, n);
+	}
+
+private:
+	std::vector<float> xs, ys, zs, rs;
+	std::vector<BoundingBox> boxes;
+};
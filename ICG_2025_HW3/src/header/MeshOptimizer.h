@@ -0,0 +1,223 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+// Triangle / vertex reordering for indexed triangle lists.
+//   optimizeVertexCache  : Tipsify (Sander et al. 2007), reorders triangles for post-transform cache hits
+//   optimizeOverdraw     : sorts the Tipsify clusters so outward facing parts are drawn first
+//   optimizeVertexFetch  : renumbers vertices in first-use order so vertex fetch walks memory linearly
+
+const int VERTEX_CACHE_SIZE = 16;
+
+struct VertexCacheStats
+{
+	float acmr; // transformed vertices per triangle (0.5 ~ 3.0, lower is better)
+	float atvr; // transformed vertices per unique vertex (1.0 is optimal)
+};
+
+// Simulate a FIFO post-transform cache over the index list
+inline VertexCacheStats analyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount,
+                                           int cacheSize = VERTEX_CACHE_SIZE)
+{
+	VertexCacheStats stats = {0.0f, 0.0f};
+	if (indices.empty() || vertexCount == 0) return stats;
+
+	// a vertex is in the cache while (misses - timestamp) < cacheSize
+	std::vector<unsigned int> timestamp(vertexCount, 0);
+	unsigned int misses = 0;
+	for (unsigned int idx : indices) {
+		if (timestamp[idx] == 0 || misses + 1 - timestamp[idx] > (unsigned int)cacheSize) {
+			misses++;
+			timestamp[idx] = misses;
+		}
+	}
+
+	stats.acmr = (float)misses / (float)(indices.size() / 3);
+	stats.atvr = (float)misses / (float)vertexCount;
+	return stats;
+}
+
+// Tipsify: fan around the most recently used vertices that are still in the cache.
+// 'clusters' receives the first triangle of every cluster (a new cluster starts at each dead end).
+inline void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount,
+                                std::vector<unsigned int>& clusters, int cacheSize = VERTEX_CACHE_SIZE)
+{
+	clusters.clear();
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) return;
+
+	// vertex -> adjacent triangles (CSR layout)
+	std::vector<unsigned int> liveCount(vertexCount, 0);
+	for (unsigned int idx : indices) liveCount[idx]++;
+
+	std::vector<unsigned int> adjacencyOffset(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++) adjacencyOffset[v + 1] = adjacencyOffset[v] + liveCount[v];
+
+	std::vector<unsigned int> adjacency(indices.size());
+	std::vector<unsigned int> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+	for (size_t i = 0; i < indices.size(); i++) adjacency[fill[indices[i]]++] = (unsigned int)(i / 3);
+
+	std::vector<unsigned int> cacheTime(vertexCount, 0);
+	std::vector<char> emitted(triangleCount, 0);
+	std::vector<unsigned int> deadEnd;
+	std::vector<unsigned int> candidates;
+	std::vector<unsigned int> result;
+	result.reserve(indices.size());
+
+	unsigned int timestamp = cacheSize + 1;
+	size_t cursor = 0;
+	int fanning = 0;
+	clusters.push_back(0);
+
+	while (fanning >= 0) {
+		candidates.clear();
+
+		// emit every live triangle around the fanning vertex
+		for (unsigned int a = adjacencyOffset[fanning]; a < adjacencyOffset[fanning + 1]; a++) {
+			unsigned int t = adjacency[a];
+			if (emitted[t]) continue;
+
+			for (int k = 0; k < 3; k++) {
+				unsigned int v = indices[t * 3 + k];
+				result.push_back(v);
+				deadEnd.push_back(v);
+				candidates.push_back(v);
+				liveCount[v]--;
+				if (timestamp - cacheTime[v] > (unsigned int)cacheSize) {
+					cacheTime[v] = timestamp++;
+				}
+			}
+			emitted[t] = 1;
+		}
+
+		// pick the candidate that will still be cached after fanning it, preferring the oldest one
+		int next = -1;
+		int bestPriority = -1;
+		for (unsigned int v : candidates) {
+			if (liveCount[v] == 0) continue;
+			int priority = 0;
+			if (timestamp - cacheTime[v] + 2 * liveCount[v] <= (unsigned int)cacheSize) {
+				priority = timestamp - cacheTime[v];
+			}
+			if (priority > bestPriority) {
+				bestPriority = priority;
+				next = (int)v;
+			}
+		}
+
+		if (next == -1) {
+			// dead end: walk back the recently used vertices, then fall back to input order
+			while (!deadEnd.empty()) {
+				unsigned int d = deadEnd.back();
+				deadEnd.pop_back();
+				if (liveCount[d] > 0) {
+					next = (int)d;
+					break;
+				}
+			}
+			while (next == -1 && cursor < vertexCount) {
+				if (liveCount[cursor] > 0) next = (int)cursor;
+				cursor++;
+			}
+			if (next != -1 && result.size() / 3 < triangleCount) {
+				clusters.push_back((unsigned int)(result.size() / 3));
+			}
+		}
+
+		fanning = next;
+	}
+
+	indices.swap(result);
+}
+
+// Sort clusters by dot(clusterCentroid - meshCentroid, clusterNormal) in descending order, so the
+// outer shell is rendered first and occluded triangles fail the depth test (view independent).
+inline void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<float>& positions,
+                             const std::vector<unsigned int>& clusters)
+{
+	if (clusters.size() < 2) return;
+
+	auto position = [&](unsigned int idx) {
+		return glm::vec3(positions[idx * 3 + 0], positions[idx * 3 + 1], positions[idx * 3 + 2]);
+	};
+
+	size_t triangleCount = indices.size() / 3;
+	glm::vec3 meshCentroid(0.0f);
+	float meshArea = 0.0f;
+
+	std::vector<glm::vec3> clusterCentroid(clusters.size(), glm::vec3(0.0f));
+	std::vector<glm::vec3> clusterNormal(clusters.size(), glm::vec3(0.0f));
+	std::vector<float> clusterArea(clusters.size(), 0.0f);
+
+	for (size_t c = 0; c < clusters.size(); c++) {
+		size_t end = (c + 1 < clusters.size()) ? clusters[c + 1] : triangleCount;
+		for (size_t t = clusters[c]; t < end; t++) {
+			glm::vec3 p0 = position(indices[t * 3 + 0]);
+			glm::vec3 p1 = position(indices[t * 3 + 1]);
+			glm::vec3 p2 = position(indices[t * 3 + 2]);
+			glm::vec3 n = glm::cross(p1 - p0, p2 - p0); // length = 2 * area
+			float area = glm::length(n);
+			glm::vec3 centroid = (p0 + p1 + p2) / 3.0f;
+
+			clusterCentroid[c] += centroid * area;
+			clusterNormal[c] += n;
+			clusterArea[c] += area;
+			meshCentroid += centroid * area;
+			meshArea += area;
+		}
+	}
+	if (meshArea > 0.0f) meshCentroid /= meshArea;
+
+	std::vector<float> sortKey(clusters.size());
+	std::vector<unsigned int> order(clusters.size());
+	for (size_t c = 0; c < clusters.size(); c++) {
+		glm::vec3 centroid = clusterArea[c] > 0.0f ? clusterCentroid[c] / clusterArea[c] : meshCentroid;
+		float normalLength = glm::length(clusterNormal[c]);
+		glm::vec3 normal = normalLength > 0.0f ? clusterNormal[c] / normalLength : glm::vec3(0.0f);
+		sortKey[c] = glm::dot(centroid - meshCentroid, normal);
+		order[c] = (unsigned int)c;
+	}
+	std::stable_sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) {
+		return sortKey[a] > sortKey[b];
+	});
+
+	std::vector<unsigned int> result;
+	result.reserve(indices.size());
+	for (unsigned int c : order) {
+		size_t end = (c + 1 < clusters.size()) ? clusters[c + 1] : triangleCount;
+		result.insert(result.end(), indices.begin() + clusters[c] * 3, indices.begin() + end * 3);
+	}
+	indices.swap(result);
+}
+
+// Renumber vertices in the order the index list first touches them. Returns the new vertex count
+// (unreferenced vertices are dropped); remap[old] is the new index or ~0u.
+inline size_t optimizeVertexFetch(std::vector<unsigned int>& indices, size_t vertexCount,
+                                  std::vector<unsigned int>& remap)
+{
+	remap.assign(vertexCount, ~0u);
+	unsigned int next = 0;
+	for (unsigned int& idx : indices) {
+		if (remap[idx] == ~0u) remap[idx] = next++;
+		idx = remap[idx];
+	}
+	return next;
+}
+
+// Apply a remap produced by optimizeVertexFetch to one attribute array
+inline void remapVertexAttribute(std::vector<float>& attribute, int components,
+                                 const std::vector<unsigned int>& remap, size_t newVertexCount)
+{
+	if (attribute.empty()) return;
+
+	std::vector<float> result(newVertexCount * components);
+	for (size_t v = 0; v < remap.size(); v++) {
+		if (remap[v] == ~0u) continue;
+		for (int k = 0; k < components; k++) {
+			result[remap[v] * components + k] = attribute[v * components + k];
+		}
+	}
+	attribute.swap(result);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cmath>
+#include <glm/glm.hpp>
+
+// Normal matrix (inverse transpose of the upper 3x3) for the "normalMatrix" uniform, computed once
+// per draw instead of per vertex in the shaders.
+//
+// Rotation + uniform scale (every model matrix in the scene, quantized position decode included)
+// takes the fast path: for M = s * R the inverse transpose is M / s^2, no inversion needed.
+inline glm::mat3 normalMatrix(const glm::mat4& model)
+{
+	glm::mat3 m(model);
+	float xx = glm::dot(m[0], m[0]);
+	float yy = glm::dot(m[1], m[1]);
+	float zz = glm::dot(m[2], m[2]);
+
+	const float eps = 1e-5f * (xx + yy + zz);
+	bool uniformScale = std::fabs(xx - yy) <= eps && std::fabs(xx - zz) <= eps;
+	bool orthogonal = std::fabs(glm::dot(m[0], m[1])) <= eps && std::fabs(glm::dot(m[0], m[2])) <= eps &&
+	                  std::fabs(glm::dot(m[1], m[2])) <= eps;
+	if (uniformScale && orthogonal && xx > 0.0f) return m * (1.0f / xx);
+
+	return glm::transpose(glm::inverse(m));
+}
@@ -1,10 +1,27 @@
 #include <bits/stdc++.h>
 
+// Pre-resolved uniform of one program, from shader_program_t::uniform()
+struct uniform_handle_t{
+    int location = -1;
+    int slot = -1;      // index into the program's value cache, -1 = uniform is not active
+};
+
+// Counters over all programs since the last reset_uniform_stats()
+struct uniform_stats_t{
+    unsigned int uploads = 0;       // glUniform* calls issued
+    unsigned int redundant = 0;     // skipped, the program already had that value
+    unsigned int lookups = 0;       // glGetUniformLocation calls avoided by the name table
+};
+
 class shader_program_t{
 public:
     shader_program_t();
     ~shader_program_t();
+    // Expands #include "file" (relative to the shader file) and inserts the defines added before
+    // the call after the #version line, then compiles
     void add_shader(std::string& filepath, unsigned int type);
+    // Feature flag for the following add_shader() calls: "NAME" or "NAME VALUE"
+    void add_define(const std::string& define);
     void link_shader();
     void create();
     void use();
@@ -15,8 +32,62 @@ public:
     void set_uniform_value(const char* name, const float value);
     void set_uniform_value(const char* name, const int value);
     unsigned int get_program_id() const { return program_handle; }
-    
+
+    // Hot uniforms: resolve once after link_shader(), then set without any name lookup
+    uniform_handle_t uniform(const char* name) const;
+    void set_uniform_value(const uniform_handle_t& u, const glm::mat4& mat);
+    void set_uniform_value(const uniform_handle_t& u, const glm::mat3& mat);
+    void set_uniform_value(const uniform_handle_t& u, const glm::vec3& vec);
+    void set_uniform_value(const uniform_handle_t& u, const float value);
+    void set_uniform_value(const uniform_handle_t& u, const int value);
+
+    static uniform_stats_t uniform_stats();
+    static void reset_uniform_stats();
+
 private:
     unsigned int program_handle;
     std::vector<unsigned int> shader_handles;
-};
\ No newline at end of file
+    std::string defines;                    // "#define ...\n" lines from add_define()
+
+    static bool expand_source(const std::string& path, const std::string& defines,
+                              std::vector<std::string>& files, std::ostream& out);
+
+    // Active uniforms, filled from glGetActiveUniform after linking. Open addressing on the
+    // FNV-1a hash of the name, so lookups by const char* never allocate.
+    struct uniform_entry_t{
+        std::string name;
+        uint32_t hash;
+        int location;
+        int slot;
+    };
+    std::vector<uniform_entry_t> uniform_table;     // power of two, empty name = free
+    std::vector<unsigned char> uniform_values;      // last uploaded value, 64 bytes per slot
+    std::vector<unsigned char> uniform_valid;       // slot has a known value
+
+    void reflect_uniforms();
+    const uniform_entry_t* find_uniform(const char* name) const;
+    bool uniform_changed(const uniform_handle_t& u, const void* data, size_t bytes);
+};
+
+// One linked program per permutation (stage files + defines). A permutation is compiled the first
+// time it is requested, asking for it again returns the same program. Owns its programs.
+class shader_variant_cache_t{
+public:
+    struct stage_t{
+        std::string path;
+        unsigned int type;
+    };
+
+    ~shader_variant_cache_t();
+
+    // Called once for every newly linked program (uniform block bindings, sampler units, ...)
+    void set_on_link(std::function<void(shader_program_t*)> callback) { on_link = callback; }
+
+    shader_program_t* get(const std::vector<stage_t>& stages, std::vector<std::string> defines);
+    void clear();
+    size_t size() const { return programs.size(); }
+
+private:
+    std::map<std::string, shader_program_t*> programs;
+    std::function<void(shader_program_t*)> on_link;
+};
@@ -9,6 +9,7 @@
 #include "header/cube.h"
 #include "header/Object.h"
 #include "header/shader.h"
+#include "header/Transform.h"
 #include "header/stb_image.h"
 
 void framebufferSizeCallback(GLFWwindow *window, int width, int height);
@@ -64,6 +65,7 @@ unsigned int cubemapVAO, cubemapVBO;
 // shader programs 
 int shaderProgramIndex = 0;
 std::vector<shader_program_t*> shaderPrograms;
+shader_variant_cache_t shaderVariants;   // lit.vert / lit.frag permutations
 shader_program_t* cubemapShader;
 
 light_t light;
@@ -74,6 +76,7 @@ Object* staticModel = nullptr;
 Object* cubeModel = nullptr;
 bool isCube = false;
 glm::mat4 modelMatrix(1.0f);
+CullStats cullStats; // frustum culling of the model, since start (C prints it)
 
 float currentTime = 0.0f;
 float deltaTime = 0.0f;
@@ -158,20 +161,15 @@ void shader_setup(){
     std::string shaderDir = "..\\..\\src\\shaders\\";
 #endif
 
+    // one lit.vert / lit.frag permutation per shading method, key 0~5
     std::vector<std::string> shadingMethod = {
-        "default", "bling-phong", "gouraud", "metallic", "glass_schlick", "Toon"
+        "SHADING_UNLIT", "SHADING_BLINN_PHONG", "SHADING_GOURAUD", "SHADING_METALLIC", "SHADING_GLASS_SCHLICK", "SHADING_TOON"
     };
 
     for(int i=0; i<shadingMethod.size(); i++){
-        std::string vpath = shaderDir + shadingMethod[i] + ".vert";
-        std::string fpath = shaderDir + shadingMethod[i] + ".frag";
-
-        shader_program_t* shaderProgram = new shader_program_t();
-        shaderProgram->create();
-        shaderProgram->add_shader(vpath, GL_VERTEX_SHADER);
-        shaderProgram->add_shader(fpath, GL_FRAGMENT_SHADER);
-        shaderProgram->link_shader();
-        shaderPrograms.push_back(shaderProgram);
+        shaderPrograms.push_back(shaderVariants.get(
+            {{shaderDir + "lit.vert", GL_VERTEX_SHADER}, {shaderDir + "lit.frag", GL_FRAGMENT_SHADER}},
+            {shadingMethod[i]}));
     }
 }
 
@@ -247,40 +245,53 @@ void render(){
     glm::mat4 view = glm::lookAt(camera.position - glm::vec3(0.0f, 0.2f, 0.1f), camera.position + camera.front, camera.up);
     glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 1000.0f);
 
-    // set matrix for view, projection, model transformation
-    shaderPrograms[shaderProgramIndex]->use();
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("model", modelMatrix);
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("view", view);
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("projection", projection);
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("viewPos", camera.position - glm::vec3(0.0f, 0.2f, 0.1f));
+    // model在frustum外面就不用畫 (skybox還是要畫)
+    Object* model = isCube ? cubeModel : staticModel;
+    Frustum frustum = Frustum::fromMatrix(projection * view);
+    BoundingSphere sphere = transformSphere(model->boundingSphere(), modelMatrix);
+    BoundingBox box = transformBox(model->bounds(), modelMatrix);
+    cullStats.tested++;
+    bool sphereVisible = frustum.intersects(sphere);
+    bool visible = sphereVisible && frustum.intersects(box);
+    if (!visible) {
+        cullStats.culled++;
+        if (sphereVisible) cullStats.culledByBox++;
+    }
 
-    // TODO: set additional uniform value for shader program
+    if (visible) {
+        // set matrix for view, projection, model transformation
+        shaderPrograms[shaderProgramIndex]->use();
+        shaderPrograms[shaderProgramIndex]->set_uniform_value("model", modelMatrix);
+        shaderPrograms[shaderProgramIndex]->set_uniform_value("normalMatrix", normalMatrix(modelMatrix));
+        shaderPrograms[shaderProgramIndex]->set_uniform_value("view", view);
+        shaderPrograms[shaderProgramIndex]->set_uniform_value("projection", projection);
+        shaderPrograms[shaderProgramIndex]->set_uniform_value("viewPos", camera.position - glm::vec3(0.0f, 0.2f, 0.1f));
 
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("light.position", light.position);
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("light.ambient",  light.ambient);
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("light.diffuse",  light.diffuse);
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("light.specular", light.specular);
+        // TODO: set additional uniform value for shader program
 
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("material.ambient",  material.ambient);
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("material.diffuse",  material.diffuse);
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("material.specular", material.specular);
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("material.gloss",    material.gloss);
+        shaderPrograms[shaderProgramIndex]->set_uniform_value("light.position", light.position);
+        shaderPrograms[shaderProgramIndex]->set_uniform_value("light.ambient",  light.ambient);
+        shaderPrograms[shaderProgramIndex]->set_uniform_value("light.diffuse",  light.diffuse);
+        shaderPrograms[shaderProgramIndex]->set_uniform_value("light.specular", light.specular);
 
-    // specifying sampler for shader program
+        shaderPrograms[shaderProgramIndex]->set_uniform_value("material.ambient",  material.ambient);
+        shaderPrograms[shaderProgramIndex]->set_uniform_value("material.diffuse",  material.diffuse);
+        shaderPrograms[shaderProgramIndex]->set_uniform_value("material.specular", material.specular);
+        shaderPrograms[shaderProgramIndex]->set_uniform_value("material.gloss",    material.gloss);
 
-    glActiveTexture(GL_TEXTURE0);
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("objectTexture", 0); // object texture
+        // specifying sampler for shader program
 
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("skybox", 1); // 把cubemap texture放到shader program，用來反射
+        glActiveTexture(GL_TEXTURE0);
+        shaderPrograms[shaderProgramIndex]->set_uniform_value("objectTexture", 0); // object texture
 
-    if(isCube)
-        cubeModel->draw();
-    else
-        staticModel->draw();
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
+        shaderPrograms[shaderProgramIndex]->set_uniform_value("skybox", 1); // 把cubemap texture放到shader program，用來反射
 
-    shaderPrograms[shaderProgramIndex]->release();
+        model->draw();
+
+        shaderPrograms[shaderProgramIndex]->release();
+    }
 
     // TODO 
     // Rendering cubemap environment
@@ -353,9 +364,7 @@ int main() {
 
     delete staticModel;
     delete cubeModel;
-    for (auto shader : shaderPrograms) {
-        delete shader;
-    }
+    shaderVariants.clear(); // owns shaderPrograms
     delete cubemapShader;
 
     glfwTerminate();
@@ -414,6 +423,10 @@ void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods
         shaderProgramIndex = 8;
     if( key == GLFW_KEY_9 && action == GLFW_PRESS)
         isCube = !isCube;
+
+    if (key == GLFW_KEY_C && action == GLFW_PRESS)
+        std::cout << "frustum culling: " << cullStats.tested << " tested, " << cullStats.culled << " culled ("
+                  << cullStats.culledByBox << " by the box after the sphere passed)" << std::endl;
 }
 
 void framebufferSizeCallback(GLFWwindow *window, int width, int height) {
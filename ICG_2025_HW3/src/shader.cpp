@@ -18,7 +18,7 @@ void shader_program_t::create(){
 
 void shader_program_t::add_shader(std::string& filepath, unsigned int type){
     
-    // compile and add shader to program
+    // preprocess, compile and add shader to program
     
     if(type == GL_VERTEX_SHADER){
         std::cout << "adding vert shader from " << filepath << std::endl;  
@@ -31,12 +31,9 @@ void shader_program_t::add_shader(std::string& filepath, unsigned int type){
         return;
     }
 
-    std::ifstream fs(filepath);
+    std::vector<std::string> files;
     std::stringstream ss;
-    std::string s;
-    while (getline(fs, s)) {
-        ss << s << "\n";
-    }
+    if (!expand_source(filepath, defines, files, ss)) return;
     std::string temp = ss.str();
     const char *source = temp.c_str();
 
@@ -51,10 +48,77 @@ void shader_program_t::add_shader(std::string& filepath, unsigned int type){
         glGetShaderInfoLog(shader, 512, NULL, infoLog);
         std::cout << "ERROR::SHADER::" << type << "::COMPLIATION_FAILED"
                   << infoLog << std::endl;
+        for (size_t i = 0; i < files.size(); i++)
+            std::cout << "  source string " << i << ": " << files[i] << std::endl;
         return;
     }
     shader_handles.push_back(shader);
 }
+void shader_program_t::add_define(const std::string& define){
+    defines += "#define " + define + "\n";
+}
+
+// "dir/" part of a path, empty if there is none
+static std::string directory_of(const std::string& path){
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+// Bounds the include tree; every file is read at most once per stage anyway
+static const size_t MAX_SOURCE_FILES = 32;
+
+// Copy 'path' into 'out' with every #include "file" (relative to the including file) replaced by
+// the file itself, and 'defines' inserted right after the #version line. A file is included at
+// most once per stage, so headers need no guards. Includes are expanded before the GLSL compiler
+// sees any #if, so keep them unconditional. The #line directives keep compiler messages
+// usable: their source string number is the file's index in 'files'.
+bool shader_program_t::expand_source(const std::string& path, const std::string& defines,
+                                     std::vector<std::string>& files, std::ostream& out){
+    std::ifstream fs(path);
+    if (!fs) {
+        std::cout << "ERROR::SHADER::FILE_NOT_READ " << path << std::endl;
+        return false;
+    }
+    int file_index = (int)files.size();
+    files.push_back(path);
+
+    std::string line;
+    int line_number = 0;
+    while (getline(fs, line)) {
+        line_number++;
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line[start] != '#') {
+            out << line << "\n";
+            continue;
+        }
+
+        if (line.compare(start, 8, "#version") == 0) {
+            out << line << "\n" << defines << "#line " << line_number + 1 << " " << file_index << "\n";
+        }
+        else if (line.compare(start, 8, "#include") == 0) {
+            size_t open = line.find('"', start + 8);
+            size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+            if (close == std::string::npos) {
+                std::cout << "ERROR::SHADER::BAD_INCLUDE " << path << ":" << line_number << std::endl;
+                return false;
+            }
+            std::string include_path = directory_of(path) + line.substr(open + 1, close - open - 1);
+            if (std::find(files.begin(), files.end(), include_path) == files.end()) {
+                if (files.size() >= MAX_SOURCE_FILES) {
+                    std::cout << "ERROR::SHADER::TOO_MANY_INCLUDES " << path << std::endl;
+                    return false;
+                }
+                out << "#line 1 " << files.size() << "\n";
+                if (!expand_source(include_path, "", files, out)) return false;
+            }
+            out << "#line " << line_number + 1 << " " << file_index << "\n";
+        }
+        else {
+            out << line << "\n";
+        }
+    }
+    return true;
+}
 
 void shader_program_t::link_shader(){
 
@@ -90,6 +154,9 @@ void shader_program_t::link_shader(){
     for(auto shader_handle: shader_handles){
         glDetachShader(program_handle, shader_handle);
     }
+
+    // name -> location table and value cache for set_uniform_value
+    if (success) reflect_uniforms();
 }
 
 void shader_program_t::use(){
@@ -100,28 +167,199 @@ void shader_program_t::release(){
     glUseProgram(0);
 }
 
+static uniform_stats_t g_uniform_stats;
+
+uniform_stats_t shader_program_t::uniform_stats(){
+    return g_uniform_stats;
+}
+
+void shader_program_t::reset_uniform_stats(){
+    g_uniform_stats = uniform_stats_t();
+}
+
+static uint32_t hash_uniform_name(const char* name){
+    // FNV-1a 32
+    uint32_t h = 2166136261u;
+    for (; *name; name++) {
+        h ^= (unsigned char)*name;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void shader_program_t::reflect_uniforms(){
+    uniform_table.clear();
+    uniform_values.clear();
+    uniform_valid.clear();
+
+    int count = 0, max_length = 0;
+    glGetProgramiv(program_handle, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program_handle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+
+    // arrays are reported as "name[0]", register the bare name as well
+    std::vector<std::pair<std::string, int>> active;
+    std::vector<char> buffer(std::max(max_length, 1));
+    for (int i = 0; i < count; i++) {
+        int length = 0, size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program_handle, i, (GLsizei)buffer.size(), &length, &size, &type, buffer.data());
+        std::string name(buffer.data(), length);
+        int location = glGetUniformLocation(program_handle, name.c_str());
+        if (location < 0) continue; // uniform block members
+
+        active.push_back({name, location});
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0) {
+            active.push_back({name.substr(0, name.size() - 3), location});
+        }
+    }
+
+    size_t capacity = 16;
+    while (capacity < active.size() * 2) capacity *= 2;
+    uniform_table.assign(capacity, uniform_entry_t{"", 0, -1, -1});
+
+    int slots = 0;
+    for (const auto& uniform : active) {
+        uint32_t hash = hash_uniform_name(uniform.first.c_str());
+        size_t i = hash & (capacity - 1);
+        while (!uniform_table[i].name.empty()) i = (i + 1) & (capacity - 1);
+
+        // "name" and "name[0]" share one location and so one cached value
+        int slot = slots;
+        for (const auto& entry : uniform_table) {
+            if (!entry.name.empty() && entry.location == uniform.second) slot = entry.slot;
+        }
+        if (slot == slots) slots++;
+
+        uniform_table[i] = {uniform.first, hash, uniform.second, slot};
+    }
+
+    uniform_values.assign(slots * 64, 0);
+    uniform_valid.assign(slots, 0);
+}
+
+const shader_program_t::uniform_entry_t* shader_program_t::find_uniform(const char* name) const{
+    if (uniform_table.empty()) return nullptr;
+
+    uint32_t hash = hash_uniform_name(name);
+    size_t mask = uniform_table.size() - 1;
+    for (size_t i = hash & mask; !uniform_table[i].name.empty(); i = (i + 1) & mask) {
+        if (uniform_table[i].hash == hash && uniform_table[i].name == name) return &uniform_table[i];
+    }
+    return nullptr;
+}
+
+uniform_handle_t shader_program_t::uniform(const char* name) const{
+    uniform_handle_t u;
+    const uniform_entry_t* entry = find_uniform(name);
+    if (entry) {
+        u.location = entry->location;
+        u.slot = entry->slot;
+    }
+    return u;
+}
+
+// Remember the value and tell whether the program has to be updated. Inactive uniforms never are.
+bool shader_program_t::uniform_changed(const uniform_handle_t& u, const void* data, size_t bytes){
+    if (u.slot < 0 || u.slot >= (int)uniform_valid.size()) {
+        g_uniform_stats.redundant++;
+        return false;
+    }
+    unsigned char* cached = &uniform_values[u.slot * 64];
+    if (uniform_valid[u.slot] && memcmp(cached, data, bytes) == 0) {
+        g_uniform_stats.redundant++;
+        return false;
+    }
+    memcpy(cached, data, bytes);
+    uniform_valid[u.slot] = 1;
+    g_uniform_stats.uploads++;
+    return true;
+}
+
+void shader_program_t::set_uniform_value(const uniform_handle_t& u, const glm::mat4 &mat){
+    if (uniform_changed(u, glm::value_ptr(mat), sizeof(mat)))
+        glUniformMatrix4fv(u.location, 1, GL_FALSE, glm::value_ptr(mat));
+}
+
+void shader_program_t::set_uniform_value(const uniform_handle_t& u, const glm::mat3 &mat){
+    if (uniform_changed(u, glm::value_ptr(mat), sizeof(mat)))
+        glUniformMatrix3fv(u.location, 1, GL_FALSE, glm::value_ptr(mat));
+}
+
+void shader_program_t::set_uniform_value(const uniform_handle_t& u, const glm::vec3& vec){
+    if (uniform_changed(u, glm::value_ptr(vec), sizeof(vec)))
+        glUniform3fv(u.location, 1, glm::value_ptr(vec));
+}
+
+void shader_program_t::set_uniform_value(const uniform_handle_t& u, const float value){
+    if (uniform_changed(u, &value, sizeof(value)))
+        glUniform1f(u.location, value);
+}
+
+void shader_program_t::set_uniform_value(const uniform_handle_t& u, const int value){
+    if (uniform_changed(u, &value, sizeof(value)))
+        glUniform1i(u.location, value);
+}
+
 void shader_program_t::set_uniform_value(const char* name, const glm::mat4 &mat){
-    unsigned int loc = glGetUniformLocation(program_handle, name);
-    glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(mat)); 
+    g_uniform_stats.lookups++;
+    set_uniform_value(uniform(name), mat);
 }
 
 void shader_program_t::set_uniform_value(const char* name, const glm::mat3 &mat){
-    unsigned int loc = glGetUniformLocation(program_handle, name);
-    glUniformMatrix3fv(loc, 1, GL_FALSE, glm::value_ptr(mat));
+    g_uniform_stats.lookups++;
+    set_uniform_value(uniform(name), mat);
 }
 
 void shader_program_t::set_uniform_value(const char* name, const glm::vec3& vec){
-    unsigned int loc = glGetUniformLocation(program_handle, name);
-    glUniform3fv(loc, 1, glm::value_ptr(vec));
-
+    g_uniform_stats.lookups++;
+    set_uniform_value(uniform(name), vec);
 }
 
 void shader_program_t::set_uniform_value(const char* name, const float value){
-    unsigned int loc = glGetUniformLocation(program_handle, name);
-    glUniform1f(loc, value);
+    g_uniform_stats.lookups++;
+    set_uniform_value(uniform(name), value);
 }
 
 void shader_program_t::set_uniform_value(const char* name, const int value){
-    unsigned int loc = glGetUniformLocation(program_handle, name);
-    glUniform1i(loc, value);
-}
\ No newline at end of file
+    g_uniform_stats.lookups++;
+    set_uniform_value(uniform(name), value);
+}
+
+shader_variant_cache_t::~shader_variant_cache_t(){
+    clear();
+}
+
+shader_program_t* shader_variant_cache_t::get(const std::vector<stage_t>& stages, std::vector<std::string> defines){
+    // flag order does not make a different permutation
+    std::sort(defines.begin(), defines.end());
+    defines.erase(std::unique(defines.begin(), defines.end()), defines.end());
+
+    std::string key;
+    for (const auto& stage : stages)
+        key += std::to_string(stage.type) + ":" + stage.path + ";";
+    for (const auto& define : defines)
+        key += "-D" + define + ";";
+
+    auto found = programs.find(key);
+    if (found != programs.end()) return found->second;
+
+    shader_program_t* program = new shader_program_t();
+    program->create();
+    for (const auto& define : defines)
+        program->add_define(define);
+    for (const auto& stage : stages) {
+        std::string path = stage.path;
+        program->add_shader(path, stage.type);
+    }
+    program->link_shader();
+    if (on_link) on_link(program);
+
+    programs[key] = program;
+    return program;
+}
+
+void shader_variant_cache_t::clear(){
+    for (auto& entry : programs)
+        delete entry.second;
+    programs.clear();
+}
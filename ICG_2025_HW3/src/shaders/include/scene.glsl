@@ -0,0 +1,21 @@
+// Camera, light and material uniforms of the lit shaders, set by render() in main.cpp
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 viewPos;
+
+struct light_t {
+    vec3 position;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct material_t {
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+    float gloss;
+};
+
+uniform light_t light;
+uniform material_t material;
@@ -0,0 +1,58 @@
+#version 330 core
+// Permutations: see lit.vert
+
+out vec4 FragColor;
+
+in vec3 WorldPos;
+in vec3 Normal;
+in vec2 TexCoord;
+
+#include "include/scene.glsl"
+#include "include/lighting.glsl"
+
+uniform sampler2D objectTexture;
+uniform samplerCube skybox;
+
+#if defined(SHADING_GOURAUD)
+in vec3 ColorCoeff;
+#endif
+
+void main()
+{
+#if defined(SHADING_METALLIC) || defined(SHADING_GLASS_SCHLICK)
+    vec3 I = normalize(WorldPos - viewPos);
+    vec3 N = normalize(Normal);
+    vec3 R = reflect(I, N);
+#endif
+
+#if defined(SHADING_METALLIC)
+    // directly reflect the enviroment, not to consider object color
+    FragColor = texture(skybox, R);
+#elif defined(SHADING_GLASS_SCHLICK)
+    float n1 = 1.0; // AIR_coeff
+    float n2 = 1.52; // GLASS_coeff
+    float eta = n1 / n2;
+
+    vec3 T = refract(I, N, eta);
+    float R0 = pow((n1 - n2) / (n1 + n2), 2.0);
+    vec3 V = -I; // I dot N => negative => compute with -I
+    float cosTheta = max(dot(N, V), 0.0);
+    float Rtheta = R0 + (1.0 - R0) * pow(1.0 - cosTheta, 5.0);
+
+    vec4 reflectColor = texture(skybox, R);
+    vec4 refractColor = texture(skybox, T);
+
+    FragColor = mix(refractColor, reflectColor, Rtheta);
+#elif defined(SHADING_GOURAUD)
+    vec4 texColor = texture(objectTexture, TexCoord);
+    FragColor = vec4(ColorCoeff * texColor.rgb, 1.0);
+#elif defined(SHADING_UNLIT)
+    FragColor = texture(objectTexture, TexCoord);
+#else
+    vec3 textureColor = texture(objectTexture, TexCoord).rgb;
+    light_terms_t terms = light_terms(light, material, WorldPos, normalize(Normal), viewPos);
+
+    vec3 color = terms.ambient * textureColor + terms.diffuse * textureColor + terms.specular;
+    FragColor = vec4(color, 1.0);
+#endif
+}
@@ -0,0 +1,35 @@
+#version 330 core
+// Every lighting model in one file, shader_setup() compiles one permutation per shading method:
+// SHADING_UNLIT, SHADING_BLINN_PHONG, SHADING_GOURAUD, SHADING_TOON, SHADING_METALLIC, SHADING_GLASS_SCHLICK
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+
+out vec3 WorldPos;
+out vec3 Normal;
+out vec2 TexCoord;
+
+uniform mat4 model;
+uniform mat3 normalMatrix; // inverse transpose of model, from the CPU
+
+#include "include/scene.glsl"
+#include "include/lighting.glsl"
+
+#if defined(SHADING_GOURAUD)
+// caculate color coefficient of texture color in vertex shader => intrpolate in fragment shader and apply to texture color
+out vec3 ColorCoeff;
+#endif
+
+void main()
+{
+    WorldPos = vec3(model * vec4(aPos, 1.0));
+    Normal = normalMatrix * aNormal;
+    TexCoord = aTexCoord;
+
+#if defined(SHADING_GOURAUD)
+    light_terms_t terms = light_terms(light, material, WorldPos, normalize(Normal), viewPos);
+    ColorCoeff = terms.ambient + terms.diffuse + terms.specular;
+#endif
+
+    gl_Position = projection * view * vec4(WorldPos, 1.0);
+}
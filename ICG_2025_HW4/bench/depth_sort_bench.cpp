@@ -0,0 +1,134 @@
+// Far to near sort of snowflakes (src/DepthSort.cpp) against std::sort of (depth, index) pairs.
+// The flakes come from SnowSystem, seen by a camera that slowly turns around the volume like the
+// HW4 scene. Reports one sort from scratch (radix on 1 and on every thread) and the average over
+// FRAMES frames of falling snow where each sort starts from the previous frame's order, with a still
+// and a turning camera, and how often that order was kept, finished by insertion or radix sorted
+// again. Every result is checked (DepthSorter keeps 16 bits of mantissa, closer depths may tie).
+//   usage: depth_sort_bench [flake count]   (default 1000000)
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include "../src/header/DepthSort.h"
+#include "../src/header/SnowSystem.h"
+
+static const int FRAMES = 120; // two seconds at 60 fps
+static const int REPEAT = 5;
+static const float DT = 1.0f / 60.0f;
+
+static double seconds(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// View space depth of every flake for a camera at 'eye' looking along 'forward'
+static void viewDepths(const SnowSystem& snow, const float eye[3], const float forward[3], float* out) {
+    const float* x = snow.x();
+    const float* y = snow.y();
+    const float* z = snow.z();
+    for (size_t i = 0; i < snow.size(); i++) {
+        out[i] = (x[i] - eye[0]) * forward[0] + (y[i] - eye[1]) * forward[1] + (z[i] - eye[2]) * forward[2];
+    }
+}
+
+// Camera at frame f, 900 units away from the volume's center, turning 'turn' radians per frame
+static void cameraAt(int frame, float turn, float eye[3], float forward[3]) {
+    float angle = frame * turn;
+    forward[0] = -std::sin(angle);
+    forward[1] = -0.1f;
+    forward[2] = -std::cos(angle);
+    eye[0] = -forward[0] * 900.0f;
+    eye[1] = 100.0f;
+    eye[2] = -forward[2] * 900.0f;
+}
+
+static bool farToNear(const std::vector<uint32_t>& order, const std::vector<float>& depths) {
+    if (order.size() != depths.size()) return false;
+    std::vector<char> seen(order.size(), 0);
+    for (size_t i = 0; i < order.size(); i++) {
+        if (order[i] >= order.size() || seen[order[i]]++) return false;
+        if (i == 0) continue;
+        float farther = depths[order[i - 1]], nearer = depths[order[i]];
+        if (farther < nearer && nearer - farther > std::fabs(nearer) / 32768.0f) return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+
+    SnowSystem snow;
+    snow.reset(count, 1234);
+    std::vector<float> positions(count * 3), depths(count);
+    snow.update(0.0f, DT, positions.data());
+    float eye[3], forward[3];
+    cameraAt(0, 0.0f, eye, forward);
+    viewDepths(snow, eye, forward, depths.data());
+
+    DepthSorter serial(1);
+    DepthSorter parallel;
+    std::vector<std::pair<float, uint32_t>> pairs(count);
+    double stdBest = 1e30, serialBest = 1e30, parallelBest = 1e30;
+    bool correct = true;
+    for (int r = 0; r < REPEAT; r++) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++) pairs[i] = {depths[i], (uint32_t)i};
+        std::sort(pairs.begin(), pairs.end(), [](const std::pair<float, uint32_t>& a, const std::pair<float, uint32_t>& b) {
+            return a.first > b.first;
+        });
+        stdBest = std::min(stdBest, seconds(t0));
+
+        serial.forget();
+        t0 = std::chrono::steady_clock::now();
+        serial.sort(depths.data(), count);
+        serialBest = std::min(serialBest, seconds(t0));
+        correct = correct && farToNear(serial.order(), depths);
+
+        parallel.forget();
+        t0 = std::chrono::steady_clock::now();
+        parallel.sort(depths.data(), count);
+        parallelBest = std::min(parallelBest, seconds(t0));
+        correct = correct && farToNear(parallel.order(), depths);
+    }
+
+    printf("%zu flakes, best of %d, ms per sort\n", count, REPEAT);
+    printf("  %-32s %8.3f ms\n", "std::sort (depth, index)", stdBest * 1e3);
+    printf("  %-32s %8.3f ms  x%.1f\n", "radix, 1 thread", serialBest * 1e3, stdBest / serialBest);
+    printf("  %-32s %8.3f ms  x%.1f\n", "radix, parallel", parallelBest * 1e3, stdBest / parallelBest);
+
+    // Falling snow, the order carried over from frame to frame
+    struct Camera { const char* name; float turn; };
+    Camera cameras[] = {{"previous order, still camera", 0.0f}, {"previous order, turning 0.2 deg", 0.0035f}};
+    for (const Camera& camera : cameras) {
+        DepthSorter coherent;
+        snow.reset(count, 1234);
+        snow.update(0.0f, DT, positions.data());
+        cameraAt(0, camera.turn, eye, forward);
+        viewDepths(snow, eye, forward, depths.data());
+        coherent.sort(depths.data(), count);
+
+        int methods[3] = {};
+        double total = 0.0;
+        for (int frame = 1; frame <= FRAMES; frame++) {
+            snow.update(frame * DT, DT, positions.data());
+            cameraAt(frame, camera.turn, eye, forward);
+            viewDepths(snow, eye, forward, depths.data());
+
+            auto t0 = std::chrono::steady_clock::now();
+            coherent.sort(depths.data(), count);
+            total += seconds(t0);
+            methods[(int)coherent.lastMethod()]++;
+            correct = correct && farToNear(coherent.order(), depths);
+        }
+        printf("  %-32s %8.3f ms  x%.1f  (%d %s, %d %s, %d %s)\n", camera.name, total / FRAMES * 1e3,
+               stdBest / (total / FRAMES), methods[0], DepthSorter::methodName(DepthSorter::Method::Presorted),
+               methods[1], DepthSorter::methodName(DepthSorter::Method::Insertion),
+               methods[2], DepthSorter::methodName(DepthSorter::Method::Radix));
+    }
+    printf("  orders %s\n", correct ? "checked far to near" : "WRONG");
+    return correct ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+// Frustum culling of thousands of scattered Object instances (header/Frustum.h), CPU only.
+// Bounds come from the scene's OBJ files the same way Object computes them at load time.
+// Times the scalar and the SSE sphere test and the full cull() (spheres + boxes of the survivors),
+// checks that both sphere tests agree and reports how many instances get culled.
+//   usage: frustum_cull_bench [instance count]   (default 10000)
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <tiny_obj_loader.h>
+
+#include "../src/header/Frustum.h"
+
+static const int FRAMES = 256; // camera positions per run
+static const int REPEAT = 5;
+
+struct MeshBounds {
+    std::string name;
+    BoundingBox box;
+    BoundingSphere sphere;
+};
+
+// AABB of every position, sphere around the box center (see Object::buildMeshData)
+static bool loadBounds(const std::string& path, MeshBounds& bounds) {
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string err;
+    if (!tinyobj::LoadObj(shapes, materials, err, path.c_str()) || shapes.empty()) return false;
+
+    glm::vec3 lo(FLT_MAX), hi(-FLT_MAX);
+    for (const auto& shape : shapes) {
+        const std::vector<float>& p = shape.mesh.positions;
+        for (size_t i = 0; i + 2 < p.size(); i += 3) {
+            glm::vec3 v(p[i], p[i + 1], p[i + 2]);
+            lo = glm::min(lo, v);
+            hi = glm::max(hi, v);
+        }
+    }
+    glm::vec3 center = (lo + hi) * 0.5f;
+    float radius2 = 0.0f;
+    for (const auto& shape : shapes) {
+        const std::vector<float>& p = shape.mesh.positions;
+        for (size_t i = 0; i + 2 < p.size(); i += 3) {
+            glm::vec3 d = glm::vec3(p[i], p[i + 1], p[i + 2]) - center;
+            radius2 = std::max(radius2, glm::dot(d, d));
+        }
+    }
+    bounds.box = {lo, hi};
+    bounds.sphere = {center, std::sqrt(radius2)};
+    return true;
+}
+
+static double seconds(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? (size_t)std::strtoul(argv[1], nullptr, 10) : 10000;
+
+    const char* names[] = {"cube", "Madara_Uchiha", "portal", "Meteor_mp", "ranita"};
+    std::vector<MeshBounds> meshes;
+    for (const char* name : names) {
+        MeshBounds bounds;
+        bounds.name = name;
+        std::string path = std::string("../../src/asset/obj/") + name + ".obj";
+        if (!loadBounds(path, bounds)) {
+            fprintf(stderr, "skipping %s\n", path.c_str());
+            continue;
+        }
+        meshes.push_back(bounds);
+    }
+    if (meshes.empty()) {
+        // run anyway with a unit cube, so the bench works outside the build tree
+        meshes.push_back({"unit cube", {glm::vec3(-1.0f), glm::vec3(1.0f)}, {glm::vec3(0.0f), std::sqrt(3.0f)}});
+    }
+
+    // Random meshes, positions, rotations and scales inside a 2000 unit cube around the origin;
+    // normalize the mesh size first so a 1000x portal does not cover the whole scene
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(-1000.0f, 1000.0f), angle(0.0f, 6.2831853f),
+        scale(5.0f, 50.0f);
+    FrustumCuller culler;
+    for (size_t i = 0; i < count; i++) {
+        const MeshBounds& mesh = meshes[i % meshes.size()];
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(position(rng), position(rng), position(rng)));
+        model = glm::rotate(model, angle(rng), glm::normalize(glm::vec3(position(rng), position(rng), 1.0f)));
+        model = glm::scale(model, glm::vec3(scale(rng) / std::max(mesh.sphere.radius, 1e-6f)));
+        culler.add(transformSphere(mesh.sphere, model), transformBox(mesh.box, model));
+    }
+
+    // Camera orbits the scene looking at the center, same projection as HW4's render()
+    std::vector<Frustum> frustums;
+    for (int f = 0; f < FRAMES; f++) {
+        float a = 6.2831853f * f / FRAMES;
+        glm::vec3 eye(std::cos(a) * 1200.0f, 200.0f, std::sin(a) * 1200.0f);
+        glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1280.0f / 720.0f, 0.1f, 5000.0f);
+        frustums.push_back(Frustum::fromMatrix(projection * view));
+    }
+
+    std::vector<unsigned char> scalarVisible(count), simdVisible(count), visible;
+    double scalarBest = 1e30, simdBest = 1e30, cullBest = 1e30;
+    size_t mismatches = 0, sphereVisible = 0;
+    CullStats stats;
+    for (int r = 0; r < REPEAT; r++) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (const Frustum& frustum : frustums) culler.sphereTestScalar(frustum, scalarVisible.data(), 0, count);
+        scalarBest = std::min(scalarBest, seconds(t0));
+
+        t0 = std::chrono::steady_clock::now();
+        for (const Frustum& frustum : frustums) culler.sphereTest(frustum, simdVisible.data(), count);
+        simdBest = std::min(simdBest, seconds(t0));
+
+        stats = CullStats();
+        t0 = std::chrono::steady_clock::now();
+        for (const Frustum& frustum : frustums) culler.cull(frustum, visible, stats);
+        cullBest = std::min(cullBest, seconds(t0));
+    }
+
+    // the last frame's results, compared object by object
+    sphereVisible = 0;
+    for (size_t i = 0; i < count; i++) {
+        mismatches += scalarVisible[i] != simdVisible[i];
+        sphereVisible += simdVisible[i];
+    }
+
+    double tests = (double)count * FRAMES;
+#ifdef FRUSTUM_SSE
+    const char* simd = "sse";
+#else
+    const char* simd = "scalar (no SSE)";
+#endif
+    printf("%zu instances of %zu meshes, %d camera positions, best of %d\n", count, meshes.size(), FRAMES, REPEAT);
+    printf("  %-16s %8.2f ns/object\n", "sphere scalar", scalarBest / tests * 1e9);
+    printf("  %-16s %8.2f ns/object  x%.2f\n", ("sphere " + std::string(simd)).c_str(), simdBest / tests * 1e9,
+           scalarBest / simdBest);
+    printf("  %-16s %8.2f ns/object\n", "cull (+ boxes)", cullBest / tests * 1e9);
+    printf("  per frame: %.1f tested, %.1f culled (%.1f by the box), last frame %zu pass the sphere test%s\n",
+           (double)stats.tested / FRAMES, (double)stats.culled / FRAMES, (double)stats.culledByBox / FRAMES,
+           sphereVisible, mismatches ? "" : ", scalar and SIMD agree");
+    if (mismatches) printf("  MISMATCH: %zu objects differ between scalar and SIMD\n", mismatches);
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,143 @@
+// Serial vs. chunked multithreaded OBJ parsing (tinyobj::LoadObj vs. tinyobj::LoadObjParallel).
+// Also checks that both produce exactly the same shapes.
+//   usage: obj_parallel_bench [obj file ...]
+//   without arguments: Madara_Uchiha.obj and a generated ~100 MB synthetic.obj (written once)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <tiny_obj_loader.h>
+
+namespace fs = std::filesystem;
+
+static const int REPEAT = 3;
+
+// Grid of quads with normals and texcoords, in groups of 64 rows
+static void writeSyntheticObj(const std::string& path, size_t targetBytes) {
+    std::ofstream out(path);
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> jitter(-0.01f, 0.01f);
+
+    const int width = 512;
+    size_t bytes = 0;
+    char line[256];
+    for (int row = 0; bytes < targetBytes; row++) {
+        if (row % 64 == 0) {
+            int n = snprintf(line, sizeof(line), "g rows_%d\n", row);
+            out.write(line, n);
+            bytes += n;
+        }
+        // two rows of vertices per strip so every strip is self contained (relative indices)
+        for (int r = 0; r < 2; r++) {
+            for (int x = 0; x < width; x++) {
+                int n = snprintf(line, sizeof(line), "v %f %f %f\nvt %f %f\nvn %f %f %f\n",
+                                 x * 0.1f, (row + r) * 0.1f, jitter(rng), x / (float)width,
+                                 (row + r) / 1024.0f, jitter(rng), jitter(rng), 1.0f);
+                out.write(line, n);
+                bytes += n;
+            }
+        }
+        for (int x = 0; x + 1 < width; x++) {
+            int a = -2 * width + x, b = a + 1, c = b + width, d = a + width;
+            int n = snprintf(line, sizeof(line), "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a,
+                             b, b, b, c, c, c, d, d, d);
+            out.write(line, n);
+            bytes += n;
+        }
+    }
+}
+
+static uint64_t hashShapes(const std::vector<tinyobj::shape_t>& shapes) {
+    uint64_t h = 14695981039346656037ull;
+    auto mix = [&](const void* data, size_t size) {
+        const unsigned char* p = (const unsigned char*)data;
+        for (size_t i = 0; i < size; i++) {
+            h ^= p[i];
+            h *= 1099511628211ull;
+        }
+    };
+    for (const auto& shape : shapes) {
+        const tinyobj::mesh_t& mesh = shape.mesh;
+        mix(shape.name.data(), shape.name.size());
+        mix(mesh.positions.data(), mesh.positions.size() * sizeof(float));
+        mix(mesh.normals.data(), mesh.normals.size() * sizeof(float));
+        mix(mesh.texcoords.data(), mesh.texcoords.size() * sizeof(float));
+        mix(mesh.indices.data(), mesh.indices.size() * sizeof(unsigned int));
+        mix(mesh.num_vertices.data(), mesh.num_vertices.size());
+        mix(mesh.material_ids.data(), mesh.material_ids.size() * sizeof(int));
+    }
+    return h;
+}
+
+// Best of REPEAT runs, threads == 0 means the serial loader
+static double timeLoad(const std::string& path, unsigned int threads, uint64_t& hash) {
+    double best = 1e30;
+    for (int r = 0; r < REPEAT; r++) {
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string err;
+
+        auto t0 = std::chrono::steady_clock::now();
+        if (threads == 0) {
+            tinyobj::LoadObj(shapes, materials, err, path.c_str());
+        } else {
+            tinyobj::LoadObjParallel(shapes, materials, err, path.c_str(), NULL, true, threads);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+        hash = hashShapes(shapes);
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++) files.push_back(argv[i]);
+    if (files.empty()) {
+        files.push_back("../../src/asset/obj/Madara_Uchiha.obj");
+        if (!fs::exists("synthetic.obj")) {
+            std::cout << "writing synthetic.obj ..." << std::endl;
+            writeSyntheticObj("synthetic.obj", 100u * 1000 * 1000);
+        }
+        files.push_back("synthetic.obj");
+    }
+
+    unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned int> threadCounts;
+    for (unsigned int t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    bool identical = true;
+    for (const auto& path : files) {
+        if (!fs::exists(path)) {
+            std::cerr << "missing " << path << std::endl;
+            continue;
+        }
+        double mb = (double)fs::file_size(path) / 1e6;
+        printf("%s (%.2f MB)\n", fs::path(path).filename().string().c_str(), mb);
+
+        uint64_t serialHash = 0;
+        double serial = timeLoad(path, 0, serialHash);
+        printf("  %-10s %9.2f ms %8.1f MB/s\n", "serial", serial * 1e3, mb / serial);
+
+        for (unsigned int threads : threadCounts) {
+            uint64_t hash = 0;
+            double t = timeLoad(path, threads, hash);
+            char label[32];
+            snprintf(label, sizeof(label), "%u thread%s", threads, threads > 1 ? "s" : "");
+            printf("  %-10s %9.2f ms %8.1f MB/s  x%.2f%s\n", label, t * 1e3, mb / t, serial / t,
+                   hash == serialHash ? "" : "  MISMATCH");
+            identical = identical && hash == serialHash;
+        }
+    }
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,57 @@
+// Parse throughput of tinyobj::LoadObj over every .obj in the asset folder.
+//   usage: obj_parse_bench [obj directory] [repeat]
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <tiny_obj_loader.h>
+
+namespace fs = std::filesystem;
+
+int main(int argc, char** argv) {
+    std::string objDir = argc > 1 ? argv[1] : "../../src/asset/obj/";
+    int repeat = argc > 2 ? std::max(1, atoi(argv[2])) : 5;
+
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator(objDir)) {
+        if (entry.path().extension() == ".obj") files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    if (files.empty()) {
+        std::cerr << "no .obj files in " << objDir << std::endl;
+        return 1;
+    }
+
+    double totalBytes = 0.0, totalSeconds = 0.0;
+    for (const auto& path : files) {
+        double bytes = (double)fs::file_size(path);
+        double best = 1e30;
+        size_t triangles = 0;
+
+        for (int r = 0; r < repeat; r++) {
+            std::vector<tinyobj::shape_t> shapes;
+            std::vector<tinyobj::material_t> materials;
+            std::string err;
+
+            auto t0 = std::chrono::steady_clock::now();
+            tinyobj::LoadObj(shapes, materials, err, path.string().c_str());
+            auto t1 = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+
+            triangles = 0;
+            for (const auto& shape : shapes) triangles += shape.mesh.indices.size() / 3;
+        }
+
+        totalBytes += bytes;
+        totalSeconds += best;
+        printf("%-24s %8.2f MB %8zu tris %9.2f ms %8.1f MB/s\n", path.filename().string().c_str(),
+               bytes / 1e6, triangles, best * 1e3, bytes / 1e6 / best);
+    }
+    printf("%-24s %8.2f MB %17s %9.2f ms %8.1f MB/s\n", "total", totalBytes / 1e6, "",
+           totalSeconds * 1e3, totalBytes / 1e6 / totalSeconds);
+    return 0;
+}
@@ -0,0 +1,258 @@
+// Snowflake draw cost: snowflake.vert + snowflake.geom (a point per flake, 36 vertices emitted by the
+// geometry shader) vs. snowflake_instanced.vert (the same star as a static 36 vertex mesh, one
+// glDrawArraysInstanced instance per flake), for the flake counts HW4 cycles through with J.
+// Flakes come from SnowSystem, drawn blended without depth writes like in the scene, DRAWS draws per
+// variant (best of REPEAT, glFinish'ed) into an 800x600 window.
+//   usage: snow_render_bench [max flakes]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "../src/header/SnowSystem.h"
+
+static const int REPEAT = 3;
+static const int DRAWS = 5;
+static const int WIDTH = 800;
+static const int HEIGHT = 600;
+
+// shaders/snowflake.vert, .geom, .frag and snowflake_instanced.vert with the Camera block as uniforms
+static const char* VERTEX_POINT = R"(#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in float aSize;
+layout (location = 2) in float aRotation;
+out VS_OUT { float size; float rotation; } vs_out;
+uniform float time;
+void main()
+{
+    vs_out.size = aSize;
+    vs_out.rotation = aRotation + time * 0.5;
+    gl_Position = vec4(aPos, 1.0);
+}
+)";
+
+static const char* GEOMETRY = R"(#version 330 core
+layout (points) in;
+layout (triangle_strip, max_vertices = 36) out;
+in VS_OUT { float size; float rotation; } gs_in[];
+out vec3 SnowColor;
+out vec2 LocalPos;
+uniform mat4 view;
+uniform mat4 projection;
+mat2 rotate2D(float angle) { float c = cos(angle); float s = sin(angle); return mat2(c, -s, s, c); }
+void emitTriangle(vec3 center, vec2 p1, vec2 p2, vec2 p3, float rotation) {
+    mat2 rot = rotate2D(rotation);
+    vec3 right = vec3(view[0][0], view[1][0], view[2][0]);
+    vec3 up = vec3(view[0][1], view[1][1], view[2][1]);
+    vec2 p[3] = vec2[3](p1, p2, p3);
+    for (int k = 0; k < 3; k++) {
+        vec2 r = rot * p[k];
+        gl_Position = projection * view * vec4(center + right * r.x + up * r.y, 1.0);
+        SnowColor = vec3(0.95, 0.97, 1.0);
+        LocalPos = p[k];
+        EmitVertex();
+    }
+    EndPrimitive();
+}
+void main() {
+    vec3 center = gl_in[0].gl_Position.xyz;
+    float size = gs_in[0].size;
+    float innerRadius = size * 0.3;
+    for (int i = 0; i < 6; i++) {
+        float angle = float(i) * 3.14159265 / 3.0;
+        float nextAngle = float(i + 1) * 3.14159265 / 3.0;
+        emitTriangle(center, vec2(0.0), vec2(cos(angle), sin(angle)) * innerRadius,
+                     vec2(cos(nextAngle), sin(nextAngle)) * innerRadius, gs_in[0].rotation);
+        emitTriangle(center, vec2(cos(angle - 0.15), sin(angle - 0.15)) * innerRadius,
+                     vec2(cos(angle), sin(angle)) * size,
+                     vec2(cos(angle + 0.15), sin(angle + 0.15)) * innerRadius, gs_in[0].rotation);
+    }
+}
+)";
+
+static const char* VERTEX_INSTANCED = R"(#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in float aSize;
+layout (location = 2) in float aRotation;
+layout (location = 3) in vec2 aCorner;
+out vec3 SnowColor;
+out vec2 LocalPos;
+uniform mat4 view;
+uniform mat4 projection;
+uniform float time;
+mat2 rotate2D(float angle) { float c = cos(angle); float s = sin(angle); return mat2(c, -s, s, c); }
+void main()
+{
+    vec2 local = aCorner * aSize;
+    vec2 r = rotate2D(aRotation + time * 0.5) * local;
+    vec3 right = vec3(view[0][0], view[1][0], view[2][0]);
+    vec3 up = vec3(view[0][1], view[1][1], view[2][1]);
+    gl_Position = projection * view * vec4(aPos + right * r.x + up * r.y, 1.0);
+    SnowColor = vec3(0.95, 0.97, 1.0);
+    LocalPos = local;
+}
+)";
+
+static const char* FRAGMENT = R"(#version 330 core
+out vec4 FragColor;
+in vec3 SnowColor;
+in vec2 LocalPos;
+void main()
+{
+    float alpha = clamp(0.85 * smoothstep(1.0, 0.0, length(LocalPos) * 0.3), 0.6, 0.9);
+    FragColor = vec4(SnowColor, alpha);
+}
+)";
+
+static unsigned int compile(GLenum type, const char* source) {
+    unsigned int shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    int success = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        std::cerr << log << std::endl;
+    }
+    return shader;
+}
+
+static unsigned int link(const char* vertexSource, const char* geometrySource) {
+    unsigned int program = glCreateProgram();
+    unsigned int shaders[3] = {compile(GL_VERTEX_SHADER, vertexSource), compile(GL_FRAGMENT_SHADER, FRAGMENT),
+                               geometrySource ? compile(GL_GEOMETRY_SHADER, geometrySource) : 0};
+    for (unsigned int shader : shaders) if (shader) glAttachShader(program, shader);
+    glLinkProgram(program);
+    for (unsigned int shader : shaders) if (shader) glDeleteShader(shader);
+
+    glUseProgram(program);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 100.0f, 500.0f), glm::vec3(0.0f, 100.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)WIDTH / HEIGHT, 0.1f, 5000.0f);
+    glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, glm::value_ptr(view));
+    glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+    glUniform1f(glGetUniformLocation(program, "time"), 1.0f);
+    return program;
+}
+
+// Best of REPEAT runs of DRAWS draws, seconds per draw
+template <typename Draw>
+static double timeDraws(unsigned int program, unsigned int vao, Draw draw) {
+    glUseProgram(program);
+    glBindVertexArray(vao);
+    glClear(GL_COLOR_BUFFER_BIT);
+    draw(); // warm up, the driver may compile lazily
+    glFinish();
+
+    double best = 1e30;
+    for (int r = 0; r < REPEAT; r++) {
+        glClear(GL_COLOR_BUFFER_BIT);
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < DRAWS; i++) draw();
+        glFinish();
+        auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(t1 - t0).count() / DRAWS);
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    size_t maxFlakes = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 1000000;
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+    GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "snow_render_bench", NULL, NULL);
+    if (window == NULL) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        return 1;
+    }
+    printf("%s\n%dx%d, %d draws x best of %d\n", (const char*)glGetString(GL_RENDERER), WIDTH, HEIGHT, DRAWS, REPEAT);
+
+    glViewport(0, 0, WIDTH, HEIGHT);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_FALSE);
+
+    unsigned int pointProgram = link(VERTEX_POINT, GEOMETRY);
+    unsigned int instancedProgram = link(VERTEX_INSTANCED, NULL);
+
+    float star[SnowSystem::STAR_VERTICES * 2];
+    SnowSystem::writeStarMesh(star);
+    unsigned int starVBO, positionVBO, staticVBO, vaos[2];
+    glGenBuffers(1, &starVBO);
+    glGenBuffers(1, &positionVBO);
+    glGenBuffers(1, &staticVBO);
+    glGenVertexArrays(2, vaos);
+    glBindBuffer(GL_ARRAY_BUFFER, starVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(star), star, GL_STATIC_DRAW);
+
+    printf("%10s %22s %22s\n", "flakes", "geometry shader", "instanced");
+    const size_t counts[] = {2000, 100000, 1000000};
+    for (size_t count : counts) {
+        if (count > maxFlakes) break;
+
+        SnowSystem snow;
+        snow.reset(count, 1234);
+        std::vector<float> positions(count * 3), attributes(count * 2);
+        snow.update(0.0f, 0.0f, positions.data());
+        snow.writeStaticAttributes(attributes.data());
+        glBindBuffer(GL_ARRAY_BUFFER, positionVBO);
+        glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(float), positions.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, staticVBO);
+        glBufferData(GL_ARRAY_BUFFER, attributes.size() * sizeof(float), attributes.data(), GL_STATIC_DRAW);
+
+        // vaos[0]: per vertex for the geometry shader, vaos[1]: per instance + the star mesh
+        for (int v = 0; v < 2; v++) {
+            glBindVertexArray(vaos[v]);
+            glBindBuffer(GL_ARRAY_BUFFER, positionVBO);
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+            glBindBuffer(GL_ARRAY_BUFFER, staticVBO);
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+            glEnableVertexAttribArray(2);
+            glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)(1 * sizeof(float)));
+            for (int location = 0; location < 3; location++) glVertexAttribDivisor(location, v);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, starVBO);
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+
+        GLsizei flakes = (GLsizei)count;
+        double geometry = timeDraws(pointProgram, vaos[0], [flakes]() { glDrawArrays(GL_POINTS, 0, flakes); });
+        double instanced = timeDraws(instancedProgram, vaos[1], [flakes]() {
+            glDrawArraysInstanced(GL_TRIANGLES, 0, SnowSystem::STAR_VERTICES, flakes);
+        });
+        printf("%10zu %12.3f ms/draw %12.3f ms/draw  x%.2f\n", count, geometry * 1e3, instanced * 1e3, geometry / instanced);
+    }
+
+    glDeleteProgram(pointProgram);
+    glDeleteProgram(instancedProgram);
+    glDeleteBuffers(1, &starVBO);
+    glDeleteBuffers(1, &positionVBO);
+    glDeleteBuffers(1, &staticVBO);
+    glDeleteVertexArrays(2, vaos);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,119 @@
+// Snowflake update (src/SnowSystem.cpp) against the array-of-structs loop main.cpp used before:
+// sin() per flake, rand() on respawn and a fresh std::vector repacked for glBufferSubData every
+// frame. Reports the cost of one update per million flakes for each kernel, checks that the
+// scalar, SSE2 and AVX2 kernels produce the same flakes and how far fastSin is from sin.
+//   usage: snow_update_bench [flake count]   (default 1000000)
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../src/header/SnowSystem.h"
+
+static const int FRAMES = 120; // two seconds at 60 fps
+static const int REPEAT = 5;
+static const float DT = 1.0f / 60.0f;
+
+// The old main.cpp update, kept as the baseline
+struct Snowflake {
+    float x, y, z;
+    float size;
+    float rotation;
+    float fallSpeed;
+    float swayPhase;
+};
+
+static float randomFloat(float min, float max) {
+    return min + static_cast<float>(rand()) / (static_cast<float>(RAND_MAX / (max - min)));
+}
+
+static void updateAoS(std::vector<Snowflake>& flakes, const SnowVolume& volume, float time, std::vector<float>& gpu) {
+    for (Snowflake& f : flakes) {
+        f.y -= f.fallSpeed * DT;
+        f.x += sin(time * 2.0f + f.swayPhase) * 15.0f * DT;
+        if (f.y < volume.heightMin) {
+            f.y = volume.heightMax;
+            f.x = randomFloat(-volume.areaSize / 2, volume.areaSize / 2);
+            f.z = randomFloat(-volume.areaSize / 2, volume.areaSize / 2);
+        }
+    }
+    std::vector<float> data(flakes.size() * 5);
+    for (size_t i = 0; i < flakes.size(); i++) {
+        data[i * 5 + 0] = flakes[i].x;
+        data[i * 5 + 1] = flakes[i].y;
+        data[i * 5 + 2] = flakes[i].z;
+        data[i * 5 + 3] = flakes[i].size;
+        data[i * 5 + 4] = flakes[i].rotation;
+    }
+    // stands in for glBufferSubData
+    memcpy(gpu.data(), data.data(), data.size() * sizeof(float));
+}
+
+static double seconds(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? (size_t)std::strtoul(argv[1], nullptr, 10) : 1000000;
+    SnowVolume volume;
+    double perMillion = 1e6 / (double)count / FRAMES * 1e3; // seconds per run -> ms per million flakes
+
+    // Baseline
+    double aosBest = 1e30;
+    std::vector<float> aosGpu(count * 5);
+    for (int r = 0; r < REPEAT; r++) {
+        srand(2025);
+        std::vector<Snowflake> flakes(count);
+        for (Snowflake& f : flakes) {
+            f = {randomFloat(-600.0f, 600.0f), randomFloat(volume.heightMin, volume.heightMax), randomFloat(-600.0f, 600.0f),
+                 randomFloat(2.0f, 6.0f), randomFloat(0.0f, 6.28318f), randomFloat(20.0f, 60.0f), randomFloat(0.0f, 6.28318f)};
+        }
+        auto t0 = std::chrono::steady_clock::now();
+        for (int f = 0; f < FRAMES; f++) updateAoS(flakes, volume, f * DT, aosGpu);
+        aosBest = std::min(aosBest, seconds(t0));
+    }
+
+    printf("%zu flakes, %d frames, best of %d, ms per update of 1M flakes\n", count, FRAMES, REPEAT);
+    printf("  %-22s %8.3f ms\n", "AoS + sin + repack", aosBest * perMillion);
+
+    // Every kernel from the same seed; the final positions must match the scalar kernel's
+    const SnowSystem::Kernel kernels[] = {SnowSystem::Kernel::Scalar, SnowSystem::Kernel::SSE2, SnowSystem::Kernel::AVX2};
+    std::vector<float> out(count * 3), reference;
+    size_t mismatches = 0;
+    for (SnowSystem::Kernel kernel : kernels) {
+        if (!SnowSystem::kernelSupported(kernel)) {
+            printf("  %-22s not supported here\n", (std::string("SoA ") + SnowSystem::kernelName(kernel)).c_str());
+            continue;
+        }
+        double best = 1e30;
+        SnowSystem snow(volume);
+        for (int r = 0; r < REPEAT; r++) {
+            snow.reset(count, 2025);
+            auto t0 = std::chrono::steady_clock::now();
+            for (int f = 0; f < FRAMES; f++) snow.update(f * DT, DT, out.data(), kernel);
+            best = std::min(best, seconds(t0));
+        }
+        printf("  %-22s %8.3f ms  x%.1f\n", (std::string("SoA ") + SnowSystem::kernelName(kernel)).c_str(),
+               best * perMillion, aosBest / best);
+
+        if (reference.empty()) {
+            reference = out;
+            continue;
+        }
+        for (size_t i = 0; i < out.size(); i++) mismatches += std::fabs(out[i] - reference[i]) > 1e-3f;
+    }
+    printf("  kernels %s\n", mismatches ? "DIFFER" : "agree on every flake");
+
+    double maxError = 0.0;
+    for (int i = -1000000; i <= 1000000; i++) {
+        float x = i * 1e-4f;
+        maxError = std::max(maxError, std::fabs((double)SnowSystem::fastSin(x) - std::sin((double)x)));
+    }
+    printf("  fastSin max |error| on [-100, 100]: %.2g\n", maxError);
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,201 @@
+// Vertex stage cost of mat3(transpose(inverse(model))) per vertex vs. a CPU computed normalMatrix.
+// Draws Madara_Uchiha.obj (not deduplicated, one vertex per face corner) into a 1x1 viewport so
+// almost nothing is rasterized, and times DRAWS draws per variant (best of REPEAT, glFinish'ed).
+// Most useful on a software driver (e.g. LIBGL_ALWAYS_SOFTWARE=1 with Mesa llvmpipe), where the
+// vertex shader runs on the CPU.
+//   usage: vertex_stage_bench [obj file]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <tiny_obj_loader.h>
+
+#include "../src/header/Transform.h"
+
+static const int REPEAT = 5;
+static const int DRAWS = 20;
+
+// Same vertex work as shaders/bling-phong.vert, with the two ways of getting the normal matrix
+static const char* VERTEX_INVERSE = R"(#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+out vec3 WorldPos;
+out vec3 Normal;
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+void main()
+{
+    WorldPos = vec3(model * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(model))) * aNormal;
+    gl_Position = projection * view * vec4(WorldPos, 1.0);
+}
+)";
+
+static const char* VERTEX_UNIFORM = R"(#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+out vec3 WorldPos;
+out vec3 Normal;
+uniform mat4 model;
+uniform mat3 normalMatrix;
+uniform mat4 view;
+uniform mat4 projection;
+void main()
+{
+    WorldPos = vec3(model * vec4(aPos, 1.0));
+    Normal = normalMatrix * aNormal;
+    gl_Position = projection * view * vec4(WorldPos, 1.0);
+}
+)";
+
+static const char* FRAGMENT = R"(#version 330 core
+in vec3 Normal;
+out vec4 FragColor;
+void main()
+{
+    FragColor = vec4(normalize(Normal) * 0.5 + 0.5, 1.0);
+}
+)";
+
+static unsigned int compile(GLenum type, const char* source) {
+    unsigned int shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    int success = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        std::cerr << log << std::endl;
+    }
+    return shader;
+}
+
+static unsigned int link(const char* vertexSource) {
+    unsigned int vs = compile(GL_VERTEX_SHADER, vertexSource);
+    unsigned int fs = compile(GL_FRAGMENT_SHADER, FRAGMENT);
+    unsigned int program = glCreateProgram();
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glLinkProgram(program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    return program;
+}
+
+// Best of REPEAT runs of DRAWS draws, seconds per draw
+static double timeDraws(unsigned int program, GLsizei vertexCount, const glm::mat4& model) {
+    glUseProgram(program);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 100.0f, 400.0f), glm::vec3(0.0f, 100.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 5000.0f);
+    glm::mat3 normal = normalMatrix(model);
+    glUniformMatrix4fv(glGetUniformLocation(program, "model"), 1, GL_FALSE, glm::value_ptr(model));
+    glUniformMatrix3fv(glGetUniformLocation(program, "normalMatrix"), 1, GL_FALSE, glm::value_ptr(normal));
+    glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, glm::value_ptr(view));
+    glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+
+    glDrawArrays(GL_TRIANGLES, 0, vertexCount); // warm up, the driver may compile lazily
+    glFinish();
+
+    double best = 1e30;
+    for (int r = 0; r < REPEAT; r++) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < DRAWS; i++) glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+        glFinish();
+        auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(t1 - t0).count() / DRAWS);
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "../../src/asset/obj/Madara_Uchiha.obj";
+
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string err;
+    if (!tinyobj::LoadObj(shapes, materials, err, path.c_str()) || shapes.empty()) {
+        std::cerr << "failed to load " << path << ": " << err << std::endl;
+        return 1;
+    }
+
+    // position + normal per face corner
+    std::vector<float> vertices;
+    for (const auto& shape : shapes) {
+        const tinyobj::mesh_t& mesh = shape.mesh;
+        for (unsigned int index : mesh.indices) {
+            for (int k = 0; k < 3; k++) vertices.push_back(mesh.positions[index * 3 + k]);
+            for (int k = 0; k < 3; k++) vertices.push_back(index * 3 + k < mesh.normals.size() ? mesh.normals[index * 3 + k] : 0.0f);
+        }
+    }
+    GLsizei vertexCount = (GLsizei)(vertices.size() / 6);
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+    GLFWwindow* window = glfwCreateWindow(64, 64, "vertex_stage_bench", NULL, NULL);
+    if (window == NULL) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        return 1;
+    }
+    printf("%s\n%s: %d vertices, %d draws x best of %d\n", (const char*)glGetString(GL_RENDERER),
+           path.c_str(), vertexCount, DRAWS, REPEAT);
+
+    unsigned int vao, vbo;
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+
+    glViewport(0, 0, 1, 1);
+    glEnable(GL_DEPTH_TEST);
+
+    unsigned int inverseProgram = link(VERTEX_INVERSE);
+    unsigned int uniformProgram = link(VERTEX_UNIFORM);
+
+    struct Case { const char* name; glm::mat4 model; };
+    Case cases[] = {
+        {"rigid + uniform scale", glm::scale(glm::rotate(glm::mat4(1.0f), 0.5f, glm::vec3(0.0f, 1.0f, 0.0f)), glm::vec3(2.0f))},
+        {"non-uniform scale", glm::scale(glm::mat4(1.0f), glm::vec3(1.0f, 2.0f, 0.5f))},
+    };
+    for (const Case& c : cases) {
+        double before = timeDraws(inverseProgram, vertexCount, c.model);
+        double after = timeDraws(uniformProgram, vertexCount, c.model);
+        printf("%s\n", c.name);
+        printf("  %-22s %8.3f ms/draw %8.2f Mvert/s\n", "inverse() per vertex", before * 1e3, vertexCount / before / 1e6);
+        printf("  %-22s %8.3f ms/draw %8.2f Mvert/s  x%.2f\n", "normalMatrix uniform", after * 1e3, vertexCount / after / 1e6, before / after);
+    }
+
+    glDeleteProgram(inverseProgram);
+    glDeleteProgram(uniformProgram);
+    glDeleteBuffers(1, &vbo);
+    glDeleteVertexArrays(1, &vao);
+    glfwTerminate();
+    return 0;
+}
@@ -5,6 +5,10 @@
 //
 
 //
+// local patch   : Vertex cache is an open addressing hash passed by reference
+//                 instead of a std::map copied for every face group.
+// local patch   : LoadObjParallel (mmap + chunked multithreaded parsing),
+//                 faster fractional part in tryParseDouble.
 // version 0.9.20: Fixes creating per-face material using `usemtl`(#68)
 // version 0.9.17: Support n-polygon and crease tag(OpenSubdiv extension)
 // version 0.9.16: Make tinyobjloader header-only
@@ -155,6 +159,15 @@ bool LoadObj(std::vector<shape_t> &shapes,       // [output]
              std::istream &inStream, MaterialReader &readMatFn,
              bool triangulate = true);
 
+/// Loads .obj from a file using `num_threads` threads (0 = one per core).
+/// The file is memory mapped and parsed in chunks; the result is identical
+/// to LoadObj(filename).
+bool LoadObjParallel(std::vector<shape_t> &shapes,       // [output]
+                     std::vector<material_t> &materials, // [output]
+                     std::string &err,                   // [output]
+                     const char *filename, const char *mtl_basepath = NULL,
+                     bool triangulate = true, unsigned int num_threads = 0);
+
 /// Loads materials into std::map
 void LoadMtl(std::map<std::string, int> &material_map, // [output]
              std::vector<material_t> &materials,       // [output]
@@ -162,6 +175,7 @@ void LoadMtl(std::map<std::string, int> &material_map, // [output]
 } // namespace tinyobj
 
 #ifdef TINYOBJLOADER_IMPLEMENTATION
+#include <algorithm>
 #include <cassert>
 #include <cctype>
 #include <cmath>
@@ -169,12 +183,23 @@ void LoadMtl(std::map<std::string, int> &material_map, // [output]
 #include <cstdlib>
 #include <cstring>
 
+#include <atomic>
 #include <fstream>
+#include <iterator>
 #include <map>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "tiny_obj_loader.h"
 
 namespace tinyobj
@@ -203,18 +228,112 @@ struct tag_sizes
     int num_strings;
 };
 
-// for std::map
-static inline bool operator<(const vertex_index &a, const vertex_index &b)
+// Open addressing (linear probing) map from a (v, vt, vn) triple to the
+// exported vertex index. Replaces std::map: one flat allocation, no per-node
+// allocation, and clear() keeps the table for the next face group.
+class vertex_index_map
 {
-    if (a.v_idx != b.v_idx)
-        return (a.v_idx < b.v_idx);
-    if (a.vn_idx != b.vn_idx)
-        return (a.vn_idx < b.vn_idx);
-    if (a.vt_idx != b.vt_idx)
-        return (a.vt_idx < b.vt_idx);
+public:
+    vertex_index_map() : mask_(0), size_(0) {}
 
-    return false;
-}
+    // Make room for `n` keys at a load factor of at most 0.5.
+    void reserve(size_t n)
+    {
+        size_t capacity = 16;
+        while (capacity < n * 2)
+            capacity <<= 1;
+
+        // Also shrink a table that got much larger than needed, otherwise
+        // clearing it between small groups would dominate.
+        if (capacity > mask_ + 1 || (mask_ + 1) > capacity * 8)
+        {
+            slots_.assign(capacity, slot());
+            mask_ = capacity - 1;
+            size_ = 0;
+        }
+    }
+
+    void clear()
+    {
+        if (size_ == 0)
+            return;
+        std::fill(slots_.begin(), slots_.end(), slot());
+        size_ = 0;
+    }
+
+    // Returns the stored value for `key`, or inserts `value` and returns it.
+    // `inserted` tells which of the two happened.
+    unsigned int findOrInsert(const vertex_index &key, unsigned int value,
+                              bool &inserted)
+    {
+        if ((size_ + 1) * 2 > slots_.size())
+            grow();
+
+        size_t i = hash(key) & mask_;
+        for (;;)
+        {
+            slot &s = slots_[i];
+            if (s.value == kEmpty)
+            {
+                s.key = key;
+                s.value = value;
+                size_++;
+                inserted = true;
+                return value;
+            }
+            if (s.key.v_idx == key.v_idx && s.key.vt_idx == key.vt_idx &&
+                s.key.vn_idx == key.vn_idx)
+            {
+                inserted = false;
+                return s.value;
+            }
+            i = (i + 1) & mask_;
+        }
+    }
+
+private:
+    static const unsigned int kEmpty = 0xffffffffu;
+
+    struct slot
+    {
+        vertex_index key;
+        unsigned int value;
+        slot() : key(-1), value(kEmpty) {}
+    };
+
+    static size_t hash(const vertex_index &key)
+    {
+        unsigned long long h =
+            static_cast<unsigned long long>(static_cast<unsigned int>(key.v_idx)) *
+            0x9E3779B97F4A7C15ull;
+        h ^= static_cast<unsigned long long>(static_cast<unsigned int>(key.vt_idx)) *
+             0xC2B2AE3D27D4EB4Full;
+        h ^= static_cast<unsigned long long>(static_cast<unsigned int>(key.vn_idx)) *
+             0x165667B19E3779F9ull;
+        return static_cast<size_t>(h ^ (h >> 29));
+    }
+
+    void grow()
+    {
+        std::vector<slot> old;
+        old.swap(slots_);
+        size_t capacity = old.empty() ? 16 : old.size() * 2;
+        slots_.assign(capacity, slot());
+        mask_ = capacity - 1;
+        size_ = 0;
+
+        bool inserted;
+        for (size_t i = 0; i < old.size(); i++)
+        {
+            if (old[i].value != kEmpty)
+                findOrInsert(old[i].key, old[i].value, inserted);
+        }
+    }
+
+    std::vector<slot> slots_;
+    size_t mask_;
+    size_t size_;
+};
 
 struct obj_shape
 {
@@ -314,6 +433,17 @@ static bool tryParseDouble(const char *s, const char *s_end, double *result)
             BEGIN PARSING.
     */
 
+    static const int kFractionTableSize = 32;
+    static const struct fraction_table
+    {
+        double scale[kFractionTableSize];
+        fraction_table()
+        {
+            for (int i = 0; i < kFractionTableSize; i++)
+                scale[i] = pow(10.0, -i);
+        }
+    } fractionTable;
+
     // Find out what sign we've got.
     if (*curr == '+' || *curr == '-')
     {
@@ -352,7 +482,10 @@ static bool tryParseDouble(const char *s, const char *s_end, double *result)
         while ((end_not_reached = (curr != s_end)) && IS_DIGIT(*curr))
         {
             // NOTE: Don't use powf here, it will absolutely murder precision.
-            mantissa += static_cast<int>(*curr - 0x30) * pow(10.0, -read);
+            // The table holds the exact pow() results, only the call is saved.
+            mantissa += static_cast<int>(*curr - 0x30) *
+                        (read < kFractionTableSize ? fractionTable.scale[read]
+                                                   : pow(10.0, -read));
             read++;
             curr++;
         }
@@ -402,6 +535,11 @@ static bool tryParseDouble(const char *s, const char *s_end, double *result)
     }
 
 assemble:
+    if (exponent == 0)
+    {
+        *result = (sign == '+' ? 1 : -1) * mantissa;
+        return true;
+    }
     *result =
         (sign == '+' ? 1 : -1) * ldexp(mantissa * pow(5.0, exponent), exponent);
     return true;
@@ -464,15 +602,22 @@ static tag_sizes parseTagTriple(const char *&token)
 }
 
 // Parse triples: i, i/j/k, i//k, i/j
+// When `relative` is given, bit 1/2/4 is set if the v/vt/vn index was
+// negative (relative to vsize/vtsize/vnsize).
 static vertex_index parseTriple(const char *&token, int vsize, int vnsize,
-                                int vtsize)
+                                int vtsize, int *relative = NULL)
 {
     vertex_index vi(-1);
+    int mask = 0;
 
-    vi.v_idx = fixIndex(atoi(token), vsize);
+    int idx = atoi(token);
+    mask |= (idx < 0) ? 1 : 0;
+    vi.v_idx = fixIndex(idx, vsize);
     token += strcspn(token, "/ \t\r");
     if (token[0] != '/')
     {
+        if (relative)
+            *relative = mask;
         return vi;
     }
     token++;
@@ -481,41 +626,98 @@ static vertex_index parseTriple(const char *&token, int vsize, int vnsize,
     if (token[0] == '/')
     {
         token++;
-        vi.vn_idx = fixIndex(atoi(token), vnsize);
+        idx = atoi(token);
+        mask |= (idx < 0) ? 4 : 0;
+        vi.vn_idx = fixIndex(idx, vnsize);
         token += strcspn(token, "/ \t\r");
+        if (relative)
+            *relative = mask;
         return vi;
     }
 
     // i/j/k or i/j
-    vi.vt_idx = fixIndex(atoi(token), vtsize);
+    idx = atoi(token);
+    mask |= (idx < 0) ? 2 : 0;
+    vi.vt_idx = fixIndex(idx, vtsize);
     token += strcspn(token, "/ \t\r");
     if (token[0] != '/')
     {
+        if (relative)
+            *relative = mask;
         return vi;
     }
 
     // i/j/k
     token++; // skip '/'
-    vi.vn_idx = fixIndex(atoi(token), vnsize);
+    idx = atoi(token);
+    mask |= (idx < 0) ? 4 : 0;
+    vi.vn_idx = fixIndex(idx, vnsize);
     token += strcspn(token, "/ \t\r");
+    if (relative)
+        *relative = mask;
     return vi;
 }
 
+// Faces of one group stored flat: all corners back to back plus the corner
+// count of every face (no heap allocation per face).
+struct face_group
+{
+    std::vector<vertex_index> vertices;
+    std::vector<unsigned int> sizes;
+
+    bool empty() const { return sizes.empty(); }
+    void clear()
+    {
+        vertices.clear();
+        sizes.clear();
+    }
+};
+
+// Parse the corners of an 'f' statement (token points after "f ") into
+// `group`. Corners using relative indices are appended to `relative` as
+// (corner index, mask) when it is given.
+static void parseFace(const char *token, face_group &group, int vsize,
+                      int vnsize, int vtsize,
+                      std::vector<std::pair<size_t, int> > *relative)
+{
+    size_t first = group.vertices.size();
+
+    while (!IS_NEW_LINE(token[0]))
+    {
+        int mask = 0;
+        vertex_index vi = parseTriple(token, vsize, vnsize, vtsize, &mask);
+        if (mask && relative)
+        {
+            relative->push_back(
+                std::pair<size_t, int>(group.vertices.size(), mask));
+        }
+        group.vertices.push_back(vi);
+        size_t n = strspn(token, " \t\r");
+        token += n;
+    }
+
+    if (group.vertices.size() > first)
+    {
+        group.sizes.push_back(
+            static_cast<unsigned int>(group.vertices.size() - first));
+    }
+}
+
 static unsigned int
-updateVertex(std::map<vertex_index, unsigned int> &vertexCache,
-             std::vector<float> &positions, std::vector<float> &normals,
-             std::vector<float> &texcoords,
+updateVertex(vertex_index_map &vertexCache, std::vector<float> &positions,
+             std::vector<float> &normals, std::vector<float> &texcoords,
              const std::vector<float> &in_positions,
              const std::vector<float> &in_normals,
              const std::vector<float> &in_texcoords, const vertex_index &i)
 {
-    const std::map<vertex_index, unsigned int>::iterator it =
-        vertexCache.find(i);
+    bool inserted;
+    const unsigned int idx = vertexCache.findOrInsert(
+        i, static_cast<unsigned int>(positions.size() / 3), inserted);
 
-    if (it != vertexCache.end())
+    if (!inserted)
     {
         // found cache
-        return it->second;
+        return idx;
     }
 
     assert(in_positions.size() > static_cast<unsigned int>(3 * i.v_idx + 2));
@@ -541,9 +743,6 @@ updateVertex(std::map<vertex_index, unsigned int> &vertexCache,
             in_texcoords[2 * static_cast<size_t>(i.vt_idx) + 1]);
     }
 
-    unsigned int idx = static_cast<unsigned int>(positions.size() / 3 - 1);
-    vertexCache[i] = idx;
-
     return idx;
 }
 
@@ -573,11 +772,11 @@ static void InitMaterial(material_t &material)
 }
 
 static bool exportFaceGroupToShape(
-    shape_t &shape, std::map<vertex_index, unsigned int> vertexCache,
+    shape_t &shape, vertex_index_map &vertexCache,
     const std::vector<float> &in_positions,
     const std::vector<float> &in_normals,
     const std::vector<float> &in_texcoords,
-    const std::vector<std::vector<vertex_index>> &faceGroup,
+    const face_group &faceGroup,
     std::vector<tag_t> &tags, const int material_id, const std::string &name,
     bool clearCache, bool triangulate)
 {
@@ -586,16 +785,30 @@ static bool exportFaceGroupToShape(
         return false;
     }
 
+    // Every corner may become a new vertex; size the outputs up front.
+    size_t numCorners = faceGroup.vertices.size();
+    size_t numTriangles = 0;
+    for (size_t i = 0; i < faceGroup.sizes.size(); i++)
+    {
+        if (faceGroup.sizes[i] > 2)
+            numTriangles += faceGroup.sizes[i] - 2;
+    }
+    vertexCache.reserve(numCorners);
+    shape.mesh.positions.reserve(shape.mesh.positions.size() + numCorners * 3);
+    shape.mesh.indices.reserve(shape.mesh.indices.size() +
+                               (triangulate ? numTriangles * 3 : numCorners));
+
     // Flatten vertices and indices
-    for (size_t i = 0; i < faceGroup.size(); i++)
+    size_t offset = 0;
+    for (size_t i = 0; i < faceGroup.sizes.size(); i++)
     {
-        const std::vector<vertex_index> &face = faceGroup[i];
+        const vertex_index *face = &faceGroup.vertices[offset];
+        size_t npolys = faceGroup.sizes[i];
+        offset += npolys;
 
         vertex_index i0 = face[0];
         vertex_index i1(-1);
-        vertex_index i2 = face[1];
-
-        size_t npolys = face.size();
+        vertex_index i2 = npolys > 1 ? face[1] : face[0];
 
         if (triangulate)
         {
@@ -966,27 +1179,220 @@ bool LoadObj(std::vector<shape_t> &shapes,       // [output]
     return LoadObj(shapes, materials, err, ifs, matFileReader, trianglulate);
 }
 
-bool LoadObj(std::vector<shape_t> &shapes,       // [output]
-             std::vector<material_t> &materials, // [output]
-             std::string &err, std::istream &inStream,
-             MaterialReader &readMatFn, bool triangulate)
+// Parser state shared by the serial and the parallel loader.
+struct obj_reader
 {
-    std::stringstream errss;
-
     std::vector<float> v;
     std::vector<float> vn;
     std::vector<float> vt;
     std::vector<tag_t> tags;
-    std::vector<std::vector<vertex_index>> faceGroup;
+    face_group faceGroup;
     std::string name;
 
     // material
     std::map<std::string, int> material_map;
-    std::map<vertex_index, unsigned int> vertexCache;
-    int material = -1;
+    vertex_index_map vertexCache;
+    int material;
 
     shape_t shape;
 
+    obj_reader() : material(-1) {}
+
+    bool exportShape(bool triangulate)
+    {
+        return exportFaceGroupToShape(shape, vertexCache, v, vn, vt, faceGroup,
+                                      tags, material, name, true, triangulate);
+    }
+};
+
+// Handles every statement except v/vn/vt/f. `token` points at the first
+// non-space character of the line. Returns false when loading must stop.
+static bool parseStatement(const char *token, obj_reader &r,
+                           std::vector<shape_t> &shapes,
+                           std::vector<material_t> &materials,
+                           std::string &err, MaterialReader &readMatFn,
+                           bool triangulate)
+{
+    // use mtl
+    if ((0 == strncmp(token, "usemtl", 6)) && IS_SPACE((token[6])))
+    {
+
+        char namebuf[TINYOBJ_SSCANF_BUFFER_SIZE];
+        token += 7;
+#ifdef _MSC_VER
+        sscanf_s(token, "%s", namebuf, (unsigned)_countof(namebuf));
+#else
+        sscanf(token, "%s", namebuf);
+#endif
+
+        int newMaterialId = -1;
+        if (r.material_map.find(namebuf) != r.material_map.end())
+        {
+            newMaterialId = r.material_map[namebuf];
+        }
+        else
+        {
+            // { error!! material not found }
+        }
+
+        if (newMaterialId != r.material)
+        {
+            // Create per-face material
+            r.exportShape(triangulate);
+            r.faceGroup.clear();
+            r.material = newMaterialId;
+        }
+
+        return true;
+    }
+
+    // load mtl
+    if ((0 == strncmp(token, "mtllib", 6)) && IS_SPACE((token[6])))
+    {
+        char namebuf[TINYOBJ_SSCANF_BUFFER_SIZE];
+        token += 7;
+#ifdef _MSC_VER
+        sscanf_s(token, "%s", namebuf, (unsigned)_countof(namebuf));
+#else
+        sscanf(token, "%s", namebuf);
+#endif
+
+        std::string err_mtl;
+        bool ok = readMatFn(namebuf, materials, r.material_map, err_mtl);
+        err += err_mtl;
+
+        if (!ok)
+        {
+            r.faceGroup.clear(); // for safety
+            return false;
+        }
+
+        return true;
+    }
+
+    // group name
+    if (token[0] == 'g' && IS_SPACE((token[1])))
+    {
+
+        // flush previous face group.
+        bool ret = r.exportShape(triangulate);
+        if (ret)
+        {
+            shapes.push_back(r.shape);
+        }
+
+        r.shape = shape_t();
+
+        // material = -1;
+        r.faceGroup.clear();
+
+        std::vector<std::string> names;
+        names.reserve(2);
+
+        while (!IS_NEW_LINE(token[0]))
+        {
+            std::string str = parseString(token);
+            names.push_back(str);
+            token += strspn(token, " \t\r"); // skip tag
+        }
+
+        assert(names.size() > 0);
+
+        // names[0] must be 'g', so skip the 0th element.
+        if (names.size() > 1)
+        {
+            r.name = names[1];
+        }
+        else
+        {
+            r.name = "";
+        }
+
+        return true;
+    }
+
+    // object name
+    if (token[0] == 'o' && IS_SPACE((token[1])))
+    {
+
+        // flush previous face group.
+        bool ret = r.exportShape(triangulate);
+        if (ret)
+        {
+            shapes.push_back(r.shape);
+        }
+
+        // material = -1;
+        r.faceGroup.clear();
+        r.shape = shape_t();
+
+        // @todo { multiple object name? }
+        char namebuf[TINYOBJ_SSCANF_BUFFER_SIZE];
+        token += 2;
+#ifdef _MSC_VER
+        sscanf_s(token, "%s", namebuf, (unsigned)_countof(namebuf));
+#else
+        sscanf(token, "%s", namebuf);
+#endif
+        r.name = std::string(namebuf);
+
+        return true;
+    }
+
+    if (token[0] == 't' && IS_SPACE(token[1]))
+    {
+        tag_t tag;
+
+        char namebuf[4096];
+        token += 2;
+        sscanf(token, "%s", namebuf);
+        tag.name = std::string(namebuf);
+
+        token += tag.name.size() + 1;
+
+        tag_sizes ts = parseTagTriple(token);
+
+        tag.intValues.resize(static_cast<size_t>(ts.num_ints));
+
+        for (size_t i = 0; i < static_cast<size_t>(ts.num_ints); ++i)
+        {
+            tag.intValues[i] = atoi(token);
+            token += strcspn(token, "/ \t\r") + 1;
+        }
+
+        tag.floatValues.resize(static_cast<size_t>(ts.num_floats));
+        for (size_t i = 0; i < static_cast<size_t>(ts.num_floats); ++i)
+        {
+            tag.floatValues[i] = parseFloat(token);
+            token += strcspn(token, "/ \t\r") + 1;
+        }
+
+        tag.stringValues.resize(static_cast<size_t>(ts.num_strings));
+        for (size_t i = 0; i < static_cast<size_t>(ts.num_strings); ++i)
+        {
+            char stringValueBuffer[4096];
+
+            sscanf(token, "%s", stringValueBuffer);
+            tag.stringValues[i] = stringValueBuffer;
+            token += tag.stringValues[i].size() + 1;
+        }
+
+        r.tags.push_back(tag);
+    }
+
+    // Ignore unknown command.
+    return true;
+}
+
+bool LoadObj(std::vector<shape_t> &shapes,       // [output]
+             std::vector<material_t> &materials, // [output]
+             std::string &err, std::istream &inStream,
+             MaterialReader &readMatFn, bool triangulate)
+{
+    std::stringstream errss;
+
+    obj_reader r;
+
     int maxchars = 8192;                                  // Alloc enough size.
     std::vector<char> buf(static_cast<size_t>(maxchars)); // Alloc enough size.
     while (inStream.peek() != -1)
@@ -1030,9 +1436,9 @@ bool LoadObj(std::vector<shape_t> &shapes,       // [output]
             token += 2;
             float x, y, z;
             parseFloat3(x, y, z, token);
-            v.push_back(x);
-            v.push_back(y);
-            v.push_back(z);
+            r.v.push_back(x);
+            r.v.push_back(y);
+            r.v.push_back(z);
             continue;
         }
 
@@ -1042,9 +1448,9 @@ bool LoadObj(std::vector<shape_t> &shapes,       // [output]
             token += 3;
             float x, y, z;
             parseFloat3(x, y, z, token);
-            vn.push_back(x);
-            vn.push_back(y);
-            vn.push_back(z);
+            r.vn.push_back(x);
+            r.vn.push_back(y);
+            r.vn.push_back(z);
             continue;
         }
 
@@ -1054,8 +1460,8 @@ bool LoadObj(std::vector<shape_t> &shapes,       // [output]
             token += 3;
             float x, y;
             parseFloat2(x, y, token);
-            vt.push_back(x);
-            vt.push_back(y);
+            r.vt.push_back(x);
+            r.vt.push_back(y);
             continue;
         }
 
@@ -1065,211 +1471,351 @@ bool LoadObj(std::vector<shape_t> &shapes,       // [output]
             token += 2;
             token += strspn(token, " \t");
 
-            std::vector<vertex_index> face;
-            face.reserve(3);
-
-            while (!IS_NEW_LINE(token[0]))
-            {
-                vertex_index vi =
-                    parseTriple(token, static_cast<int>(v.size() / 3),
-                                static_cast<int>(vn.size() / 3),
-                                static_cast<int>(vt.size() / 2));
-                face.push_back(vi);
-                size_t n = strspn(token, " \t\r");
-                token += n;
-            }
-
-            // replace with emplace_back + std::move on C++11
-            faceGroup.push_back(std::vector<vertex_index>());
-            faceGroup[faceGroup.size() - 1].swap(face);
+            parseFace(token, r.faceGroup, static_cast<int>(r.v.size() / 3),
+                      static_cast<int>(r.vn.size() / 3),
+                      static_cast<int>(r.vt.size() / 2), NULL);
 
             continue;
         }
 
-        // use mtl
-        if ((0 == strncmp(token, "usemtl", 6)) && IS_SPACE((token[6])))
+        if (!parseStatement(token, r, shapes, materials, err, readMatFn,
+                            triangulate))
         {
+            return false;
+        }
+    }
 
-            char namebuf[TINYOBJ_SSCANF_BUFFER_SIZE];
-            token += 7;
-#ifdef _MSC_VER
-            sscanf_s(token, "%s", namebuf, (unsigned)_countof(namebuf));
-#else
-            sscanf(token, "%s", namebuf);
-#endif
-
-            int newMaterialId = -1;
-            if (material_map.find(namebuf) != material_map.end())
-            {
-                newMaterialId = material_map[namebuf];
-            }
-            else
-            {
-                // { error!! material not found }
-            }
+    bool ret = r.exportShape(triangulate);
+    if (ret)
+    {
+        shapes.push_back(r.shape);
+    }
+    r.faceGroup.clear(); // for safety
 
-            if (newMaterialId != material)
-            {
-                // Create per-face material
-                exportFaceGroupToShape(shape, vertexCache, v, vn, vt, faceGroup,
-                                       tags, material, name, true, triangulate);
-                faceGroup.clear();
-                material = newMaterialId;
-            }
+    err += errss.str();
+    return true;
+}
 
-            continue;
-        }
+//
+// Parallel loader
+//
+// The file is mapped and cut into chunks at line boundaries. Worker threads
+// parse v/vt/vn/f records of their chunk into chunk-local arrays; relative
+// (negative) face indices are resolved against the chunk-local counts and
+// remembered. Every other statement (g, o, usemtl, mtllib, t) is kept as text
+// together with its position in the face stream. The main thread then
+// concatenates the attribute arrays using prefix sums of the chunk counts,
+// rebases the relative indices and replays faces and statements in file
+// order through the same code as the serial loader.
+//
 
-        // load mtl
-        if ((0 == strncmp(token, "mtllib", 6)) && IS_SPACE((token[6])))
-        {
-            char namebuf[TINYOBJ_SSCANF_BUFFER_SIZE];
-            token += 7;
-#ifdef _MSC_VER
-            sscanf_s(token, "%s", namebuf, (unsigned)_countof(namebuf));
-#else
-            sscanf(token, "%s", namebuf);
-#endif
+struct obj_chunk
+{
+    std::vector<float> v;
+    std::vector<float> vn;
+    std::vector<float> vt;
+    face_group faces;
+    std::vector<std::pair<size_t, int> > relative; // (corner, mask)
 
-            std::string err_mtl;
-            bool ok = readMatFn(namebuf, materials, material_map, err_mtl);
-            err += err_mtl;
+    // (number of faces before the statement, statement text)
+    std::vector<std::pair<size_t, std::string> > statements;
+};
 
-            if (!ok)
-            {
-                faceGroup.clear(); // for safety
-                return false;
-            }
+class mapped_file
+{
+public:
+    mapped_file() : data_(NULL), size_(0), mapped_(false) {}
+    ~mapped_file()
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        if (mapped_)
+            munmap(const_cast<char *>(data_), size_);
+#endif
+    }
 
-            continue;
+    bool open(const char *filename)
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        int fd = ::open(filename, O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            return false;
         }
-
-        // group name
-        if (token[0] == 'g' && IS_SPACE((token[1])))
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ == 0)
         {
+            ::close(fd);
+            data_ = "";
+            return true;
+        }
+        void *ptr = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (ptr == MAP_FAILED)
+            return false;
+        data_ = static_cast<const char *>(ptr);
+        mapped_ = true;
+        return true;
+#else
+        std::ifstream ifs(filename, std::ios::binary);
+        if (!ifs)
+            return false;
+        buffer_.assign(std::istreambuf_iterator<char>(ifs),
+                       std::istreambuf_iterator<char>());
+        data_ = buffer_.empty() ? "" : &buffer_[0];
+        size_ = buffer_.size();
+        return true;
+#endif
+    }
 
-            // flush previous face group.
-            bool ret =
-                exportFaceGroupToShape(shape, vertexCache, v, vn, vt, faceGroup,
-                                       tags, material, name, true, triangulate);
-            if (ret)
-            {
-                shapes.push_back(shape);
-            }
+    const char *data() const { return data_; }
+    size_t size() const { return size_; }
 
-            shape = shape_t();
+private:
+    const char *data_;
+    size_t size_;
+    bool mapped_;
+    std::vector<char> buffer_;
+};
 
-            // material = -1;
-            faceGroup.clear();
+static void parseChunk(const char *begin, const char *end, obj_chunk &chunk)
+{
+    char buf[8192];
 
-            std::vector<std::string> names;
-            names.reserve(2);
+    const char *p = begin;
+    while (p < end)
+    {
+        const char *eol =
+            static_cast<const char *>(memchr(p, '\n', static_cast<size_t>(end - p)));
+        if (!eol)
+            eol = end;
+
+        // Same view of the line as the serial loader: at most 8191 chars,
+        // NUL terminated, trailing '\r' removed.
+        size_t len = static_cast<size_t>(eol - p);
+        if (len > sizeof(buf) - 1)
+            len = sizeof(buf) - 1;
+        memcpy(buf, p, len);
+        buf[len] = '\0';
+        p = eol + 1;
+
+        len = strlen(buf);
+        if (len > 0 && buf[len - 1] == '\r')
+            buf[--len] = '\0';
+        if (len == 0)
+            continue;
 
-            while (!IS_NEW_LINE(token[0]))
-            {
-                std::string str = parseString(token);
-                names.push_back(str);
-                token += strspn(token, " \t\r"); // skip tag
-            }
+        const char *token = buf;
+        token += strspn(token, " \t");
 
-            assert(names.size() > 0);
+        if (token[0] == '\0')
+            continue; // empty line
 
-            // names[0] must be 'g', so skip the 0th element.
-            if (names.size() > 1)
-            {
-                name = names[1];
-            }
-            else
-            {
-                name = "";
-            }
+        if (token[0] == '#')
+            continue; // comment line
 
+        // vertex
+        if (token[0] == 'v' && IS_SPACE((token[1])))
+        {
+            token += 2;
+            float x, y, z;
+            parseFloat3(x, y, z, token);
+            chunk.v.push_back(x);
+            chunk.v.push_back(y);
+            chunk.v.push_back(z);
             continue;
         }
 
-        // object name
-        if (token[0] == 'o' && IS_SPACE((token[1])))
+        // normal
+        if (token[0] == 'v' && token[1] == 'n' && IS_SPACE((token[2])))
         {
+            token += 3;
+            float x, y, z;
+            parseFloat3(x, y, z, token);
+            chunk.vn.push_back(x);
+            chunk.vn.push_back(y);
+            chunk.vn.push_back(z);
+            continue;
+        }
 
-            // flush previous face group.
-            bool ret =
-                exportFaceGroupToShape(shape, vertexCache, v, vn, vt, faceGroup,
-                                       tags, material, name, true, triangulate);
-            if (ret)
-            {
-                shapes.push_back(shape);
-            }
-
-            // material = -1;
-            faceGroup.clear();
-            shape = shape_t();
+        // texcoord
+        if (token[0] == 'v' && token[1] == 't' && IS_SPACE((token[2])))
+        {
+            token += 3;
+            float x, y;
+            parseFloat2(x, y, token);
+            chunk.vt.push_back(x);
+            chunk.vt.push_back(y);
+            continue;
+        }
 
-            // @todo { multiple object name? }
-            char namebuf[TINYOBJ_SSCANF_BUFFER_SIZE];
+        // face
+        if (token[0] == 'f' && IS_SPACE((token[1])))
+        {
             token += 2;
-#ifdef _MSC_VER
-            sscanf_s(token, "%s", namebuf, (unsigned)_countof(namebuf));
-#else
-            sscanf(token, "%s", namebuf);
-#endif
-            name = std::string(namebuf);
+            token += strspn(token, " \t");
 
+            parseFace(token, chunk.faces, static_cast<int>(chunk.v.size() / 3),
+                      static_cast<int>(chunk.vn.size() / 3),
+                      static_cast<int>(chunk.vt.size() / 2), &chunk.relative);
             continue;
         }
 
-        if (token[0] == 't' && IS_SPACE(token[1]))
-        {
-            tag_t tag;
+        chunk.statements.push_back(std::pair<size_t, std::string>(
+            chunk.faces.sizes.size(), std::string(token)));
+    }
+}
 
-            char namebuf[4096];
-            token += 2;
-            sscanf(token, "%s", namebuf);
-            tag.name = std::string(namebuf);
+// Append faces [firstFace, lastFace) of a chunk to the current face group.
+static void appendFaces(face_group &group, const face_group &faces,
+                        size_t firstFace, size_t lastFace, size_t &corner)
+{
+    if (firstFace >= lastFace)
+        return;
+
+    size_t firstCorner = corner;
+    for (size_t f = firstFace; f < lastFace; f++)
+        corner += faces.sizes[f];
+
+    group.sizes.insert(group.sizes.end(), faces.sizes.begin() + firstFace,
+                       faces.sizes.begin() + lastFace);
+    group.vertices.insert(group.vertices.end(),
+                          faces.vertices.begin() + firstCorner,
+                          faces.vertices.begin() + corner);
+}
 
-            token += tag.name.size() + 1;
+bool LoadObjParallel(std::vector<shape_t> &shapes,
+                     std::vector<material_t> &materials, std::string &err,
+                     const char *filename, const char *mtl_basepath,
+                     bool triangulate, unsigned int num_threads)
+{
+    shapes.clear();
 
-            tag_sizes ts = parseTagTriple(token);
+    mapped_file file;
+    if (!file.open(filename))
+    {
+        std::stringstream errss;
+        errss << "Cannot open file [" << filename << "]" << std::endl;
+        err = errss.str();
+        return false;
+    }
 
-            tag.intValues.resize(static_cast<size_t>(ts.num_ints));
+    std::string basePath;
+    if (mtl_basepath)
+    {
+        basePath = mtl_basepath;
+    }
+    MaterialFileReader matFileReader(basePath);
 
-            for (size_t i = 0; i < static_cast<size_t>(ts.num_ints); ++i)
-            {
-                tag.intValues[i] = atoi(token);
-                token += strcspn(token, "/ \t\r") + 1;
-            }
+    if (num_threads == 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
 
-            tag.floatValues.resize(static_cast<size_t>(ts.num_floats));
-            for (size_t i = 0; i < static_cast<size_t>(ts.num_floats); ++i)
-            {
-                tag.floatValues[i] = parseFloat(token);
-                token += strcspn(token, "/ \t\r") + 1;
-            }
+    // Split into chunks of at least 256 KB, a few per thread for balance.
+    const char *data = file.data();
+    const size_t size = file.size();
+    const size_t minChunkSize = 256 * 1024;
+    size_t numChunks = std::max<size_t>(
+        1, std::min<size_t>(size / minChunkSize, num_threads * 4));
 
-            tag.stringValues.resize(static_cast<size_t>(ts.num_strings));
-            for (size_t i = 0; i < static_cast<size_t>(ts.num_strings); ++i)
-            {
-                char stringValueBuffer[4096];
+    std::vector<size_t> bounds(1, 0);
+    for (size_t c = 1; c < numChunks; c++)
+    {
+        size_t pos = std::max(bounds.back(), size * c / numChunks);
+        const char *eol = static_cast<const char *>(
+            memchr(data + pos, '\n', size - pos));
+        pos = eol ? static_cast<size_t>(eol - data) + 1 : size;
+        if (pos > bounds.back() && pos < size)
+            bounds.push_back(pos);
+    }
+    bounds.push_back(size);
+    numChunks = bounds.size() - 1;
 
-                sscanf(token, "%s", stringValueBuffer);
-                tag.stringValues[i] = stringValueBuffer;
-                token += tag.stringValues[i].size() + 1;
-            }
+    std::vector<obj_chunk> chunks(numChunks);
+    std::atomic<size_t> nextChunk(0);
+    const size_t numWorkers = std::min<size_t>(num_threads, numChunks);
 
-            tags.push_back(tag);
+    // The calling thread works too.
+    std::vector<std::thread> workers;
+    for (;;)
+    {
+        if (workers.size() + 1 >= numWorkers)
+            break;
+        workers.push_back(std::thread([&]() {
+            for (size_t c; (c = nextChunk++) < numChunks;)
+                parseChunk(data + bounds[c], data + bounds[c + 1], chunks[c]);
+        }));
+    }
+    for (size_t c; (c = nextChunk++) < numChunks;)
+        parseChunk(data + bounds[c], data + bounds[c + 1], chunks[c]);
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+
+    // Merge attribute arrays with prefix sums over the chunk counts and
+    // rebase relative indices.
+    obj_reader r;
+    size_t numV = 0, numVn = 0, numVt = 0;
+    for (size_t c = 0; c < numChunks; c++)
+    {
+        obj_chunk &chunk = chunks[c];
+        for (size_t i = 0; i < chunk.relative.size(); i++)
+        {
+            vertex_index &vi = chunk.faces.vertices[chunk.relative[i].first];
+            int mask = chunk.relative[i].second;
+            if (mask & 1)
+                vi.v_idx += static_cast<int>(numV / 3);
+            if (mask & 2)
+                vi.vt_idx += static_cast<int>(numVt / 2);
+            if (mask & 4)
+                vi.vn_idx += static_cast<int>(numVn / 3);
         }
+        numV += chunk.v.size();
+        numVn += chunk.vn.size();
+        numVt += chunk.vt.size();
+    }
+    r.v.reserve(numV);
+    r.vn.reserve(numVn);
+    r.vt.reserve(numVt);
+    for (size_t c = 0; c < numChunks; c++)
+    {
+        r.v.insert(r.v.end(), chunks[c].v.begin(), chunks[c].v.end());
+        r.vn.insert(r.vn.end(), chunks[c].vn.begin(), chunks[c].vn.end());
+        r.vt.insert(r.vt.end(), chunks[c].vt.begin(), chunks[c].vt.end());
+        std::vector<float>().swap(chunks[c].v);
+        std::vector<float>().swap(chunks[c].vn);
+        std::vector<float>().swap(chunks[c].vt);
+    }
 
-        // Ignore unknown command.
+    // Replay faces and statements in file order.
+    for (size_t c = 0; c < numChunks; c++)
+    {
+        const obj_chunk &chunk = chunks[c];
+        size_t face = 0, corner = 0;
+        for (size_t i = 0; i < chunk.statements.size(); i++)
+        {
+            appendFaces(r.faceGroup, chunk.faces, face,
+                        chunk.statements[i].first, corner);
+            face = chunk.statements[i].first;
+
+            if (!parseStatement(chunk.statements[i].second.c_str(), r, shapes,
+                                materials, err, matFileReader, triangulate))
+            {
+                return false;
+            }
+        }
+        appendFaces(r.faceGroup, chunk.faces, face, chunk.faces.sizes.size(),
+                    corner);
     }
 
-    bool ret = exportFaceGroupToShape(shape, vertexCache, v, vn, vt, faceGroup,
-                                      tags, material, name, true, triangulate);
+    bool ret = r.exportShape(triangulate);
     if (ret)
     {
-        shapes.push_back(shape);
+        shapes.push_back(r.shape);
     }
-    faceGroup.clear(); // for safety
+    r.faceGroup.clear(); // for safety
 
-    err += errss.str();
     return true;
 }
 
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include "header/AssetLoader.h"
+#include "header/stb_image.h"
+
+bool ImageData::load(const std::string& path, bool flipVertically){
+	release();
+	stbi_set_flip_vertically_on_load_thread(flipVertically ? 1 : 0);
+	pixels = stbi_load(path.c_str(), &width, &height, &channels, 0);
+	if (!pixels) {
+		width = height = channels = 0;
+		return false;
+	}
+	return true;
+}
+
+void ImageData::release(){
+	if (pixels) stbi_image_free(pixels);
+	pixels = nullptr;
+}
+
+AssetLoader::AssetLoader(unsigned int threadCount){
+	if (threadCount == 0) {
+		// leave a core for the render thread
+		unsigned int cores = std::thread::hardware_concurrency();
+		threadCount = cores > 2 ? cores - 1 : 1;
+	}
+	for (unsigned int i = 0; i < threadCount; i++) {
+		workers.emplace_back(&AssetLoader::workerLoop, this);
+	}
+}
+
+AssetLoader::~AssetLoader(){
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+		pending.clear();
+	}
+	jobAvailable.notify_all();
+	for (auto& worker : workers) worker.join();
+}
+
+void AssetLoader::submit(std::function<void()> decode, std::function<void()> upload){
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending.push_back({std::move(decode), std::move(upload)});
+	}
+	jobAvailable.notify_one();
+}
+
+void AssetLoader::workerLoop(){
+	for (;;) {
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobAvailable.wait(lock, [this] { return stopping || !pending.empty(); });
+			if (stopping) return;
+			job = std::move(pending.front());
+			pending.pop_front();
+			decoding++;
+		}
+
+		if (job.decode) job.decode();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			decoding--;
+			decoded.push_back(std::move(job));
+		}
+		jobDecoded.notify_all();
+	}
+}
+
+int AssetLoader::processUploads(double budgetMs){
+	auto start = std::chrono::steady_clock::now();
+	int uploads = 0;
+	for (;;) {
+		Job job;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (decoded.empty()) break;
+			job = std::move(decoded.front());
+			decoded.pop_front();
+		}
+
+		if (job.upload) job.upload();
+		uploads++;
+
+		double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		if (elapsed >= budgetMs) break;
+	}
+	return uploads;
+}
+
+bool AssetLoader::idle(){
+	std::lock_guard<std::mutex> lock(mutex);
+	return pending.empty() && decoding == 0 && decoded.empty();
+}
+
+void AssetLoader::finish(){
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobDecoded.wait(lock, [this] { return !decoded.empty() || (pending.empty() && decoding == 0); });
+			if (decoded.empty()) return;
+		}
+		processUploads(1e30);
+	}
+}
@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include "header/DepthSort.h"
+
+namespace {
+
+// 24 bit keys in two passes, the per-thread histograms (32 KB) still fit in L1 / L2
+const int DIGIT_BITS = 12;
+const size_t BUCKETS = 1 << DIGIT_BITS;
+
+// Unsigned order of the result = descending float order: negative floats have every bit flipped,
+// positive ones only the sign, which sorts them ascending, then everything is flipped once more.
+// The low 8 bits are dropped.
+uint32_t farFirstKey(float depth){
+	uint32_t bits;
+	memcpy(&bits, &depth, sizeof(bits));
+	uint32_t ascending = (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+	return ~ascending >> 8;
+}
+
+// Every thread waits until all 'count' have arrived
+class Barrier
+{
+public:
+	explicit Barrier(unsigned int count) : count(count) {}
+
+	void wait(){
+		if (count == 1) return;
+		std::unique_lock<std::mutex> lock(mutex);
+		unsigned int generation = passed;
+		if (++waiting == count) {
+			waiting = 0;
+			passed++;
+			arrived.notify_all();
+		} else {
+			arrived.wait(lock, [&]() { return passed != generation; });
+		}
+	}
+
+private:
+	unsigned int count;
+	unsigned int waiting = 0;
+	unsigned int passed = 0;
+	std::mutex mutex;
+	std::condition_variable arrived;
+};
+
+} // namespace
+
+DepthSorter::DepthSorter(unsigned int threadCount) : threads(threadCount){
+	if (threads == 0) threads = std::min(8u, std::max(1u, std::thread::hardware_concurrency()));
+}
+
+DepthSorter::~DepthSorter(){
+	{
+		std::lock_guard<std::mutex> lock(poolMutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (std::thread& helper : helpers) helper.join();
+}
+
+void DepthSorter::runOnAllThreads(const std::function<void(unsigned int)>& work){
+	if (helpers.empty()) {
+		for (unsigned int t = 1; t < threads; t++) helpers.emplace_back(&DepthSorter::helperLoop, this, t);
+	}
+	{
+		std::lock_guard<std::mutex> lock(poolMutex);
+		job = &work;
+		busy = (unsigned int)helpers.size();
+		jobGeneration++;
+	}
+	wake.notify_all();
+	work(0);
+
+	std::unique_lock<std::mutex> lock(poolMutex);
+	finished.wait(lock, [&]() { return busy == 0; });
+	job = nullptr;
+}
+
+void DepthSorter::helperLoop(unsigned int t){
+	unsigned int seen = 0;
+	std::unique_lock<std::mutex> lock(poolMutex);
+	for (;;) {
+		wake.wait(lock, [&]() { return stopping || jobGeneration != seen; });
+		if (stopping) return;
+		seen = jobGeneration;
+		const std::function<void(unsigned int)>* work = job;
+
+		lock.unlock();
+		(*work)(t);
+		lock.lock();
+		if (--busy == 0) finished.notify_one();
+	}
+}
+
+const char* DepthSorter::methodName(Method method){
+	switch (method) {
+	case Method::Presorted: return "already sorted";
+	case Method::Insertion: return "insertion";
+	default: return "radix";
+	}
+}
+
+const std::vector<uint32_t>& DepthSorter::sort(const float* depths, size_t count){
+	bool coherent = indices.size() == count && retryIn == 0;
+	if (retryIn > 0) retryIn--;
+	if (!coherent) {
+		indices.resize(count);
+		for (size_t i = 0; i < count; i++) indices[i] = (uint32_t)i;
+	}
+	keys.resize(count);
+	for (size_t i = 0; i < count; i++) keys[i] = farFirstKey(depths[indices[i]]);
+
+	if (coherent) {
+		size_t shifted = 0;
+		if (insertionSort(count * INSERTION_BUDGET, shifted)) {
+			method = shifted == 0 ? Method::Presorted : Method::Insertion;
+			backoff = 0;
+			return indices;
+		}
+		// moved too much since the last sort, probably again next frame
+		backoff = std::min(MAX_BACKOFF, std::max(1u, backoff * 2));
+		retryIn = backoff;
+	}
+	method = Method::Radix;
+	radixSort();
+	return indices;
+}
+
+// false once more than 'budget' items were shifted; what is done so far stays a valid order
+bool DepthSorter::insertionSort(size_t budget, size_t& shifted){
+	for (size_t i = 1; i < keys.size(); i++) {
+		uint32_t key = keys[i];
+		if (keys[i - 1] <= key) continue;
+		uint32_t index = indices[i];
+		size_t j = i;
+		do {
+			keys[j] = keys[j - 1];
+			indices[j] = indices[j - 1];
+			j--;
+		} while (j > 0 && keys[j - 1] > key);
+		keys[j] = key;
+		indices[j] = index;
+		shifted += i - j;
+		if (shifted > budget) return false;
+	}
+	return true;
+}
+
+void DepthSorter::radixSort(){
+	size_t n = keys.size();
+	if (n < 2) return;
+	scratchKeys.resize(n);
+	scratchIndices.resize(n);
+
+	unsigned int threadCount = n >= PARALLEL_MIN ? threads : 1;
+	size_t chunk = (n + threadCount - 1) / threadCount;
+	counts.assign(threadCount * BUCKETS, 0);
+	Barrier barrier(threadCount);
+	bool skip = false;
+	bool inScratch = false;
+
+	// Thread t owns the items [t * chunk, (t + 1) * chunk) of every pass' input
+	std::function<void(unsigned int)> work = [&](unsigned int t) {
+		size_t begin = std::min(n, t * chunk);
+		size_t end = std::min(n, begin + chunk);
+		uint32_t* srcKeys = keys.data();
+		uint32_t* srcIndices = indices.data();
+		uint32_t* dstKeys = scratchKeys.data();
+		uint32_t* dstIndices = scratchIndices.data();
+		size_t* offsets = &counts[t * BUCKETS];
+
+		for (int shift = 0; shift < 24; shift += DIGIT_BITS) {
+			std::fill(offsets, offsets + BUCKETS, 0);
+			for (size_t i = begin; i < end; i++) offsets[(srcKeys[i] >> shift) & (BUCKETS - 1)]++;
+			barrier.wait();
+
+			if (t == 0) {
+				size_t first = (srcKeys[0] >> shift) & (BUCKETS - 1);
+				size_t sharing = 0;
+				for (unsigned int u = 0; u < threadCount; u++) sharing += counts[u * BUCKETS + first];
+				skip = sharing == n; // every key has this digit
+				// digits in order, inside a digit the threads in order: keeps the sort stable
+				size_t offset = 0;
+				for (size_t b = 0; !skip && b < BUCKETS; b++) {
+					for (unsigned int u = 0; u < threadCount; u++) {
+						size_t count = counts[u * BUCKETS + b];
+						counts[u * BUCKETS + b] = offset;
+						offset += count;
+					}
+				}
+			}
+			barrier.wait();
+			if (skip) continue;
+
+			for (size_t i = begin; i < end; i++) {
+				uint32_t key = srcKeys[i];
+				size_t at = offsets[(key >> shift) & (BUCKETS - 1)]++;
+				dstKeys[at] = key;
+				dstIndices[at] = srcIndices[i];
+			}
+			barrier.wait();
+			std::swap(srcKeys, dstKeys);
+			std::swap(srcIndices, dstIndices);
+		}
+		if (t == 0) inScratch = srcKeys != keys.data();
+	};
+
+	if (threadCount > 1) runOnAllThreads(work);
+	else work(0);
+
+	if (inScratch) {
+		keys.swap(scratchKeys);
+		indices.swap(scratchIndices);
+	}
+}
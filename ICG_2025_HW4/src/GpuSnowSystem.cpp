@@ -0,0 +1,121 @@
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "header/GpuSnowSystem.h"
+#include "header/shader.h"
+
+const char* const GpuSnowSystem::INIT_VARYINGS[2] = {"outPosition", "outParams"};
+const char* const GpuSnowSystem::UPDATE_VARYINGS[1] = {"outPosition"};
+
+GpuSnowSystem::GpuSnowSystem(shader_program_t* initProgram, shader_program_t* updateProgram, const SnowVolume& volume)
+	: initProgram(initProgram), updateProgram(updateProgram), volume(volume){
+}
+
+GpuSnowSystem::~GpuSnowSystem(){
+	release();
+}
+
+void GpuSnowSystem::release(){
+	glDeleteVertexArrays(2, updateVAO);
+	glDeleteVertexArrays(2, renderVAO);
+	glDeleteVertexArrays(2, instancedVAO);
+	glDeleteBuffers(2, positions);
+	glDeleteBuffers(1, &params);
+	for (int i = 0; i < 2; i++) updateVAO[i] = renderVAO[i] = instancedVAO[i] = positions[i] = 0;
+	params = 0;
+	count = 0;
+}
+
+void GpuSnowSystem::reset(size_t flakes, uint32_t newSeed){
+	release();
+	count = flakes;
+	seed = newSeed;
+	step = 0;
+	current = 0;
+	if (count == 0) return;
+
+	glGenBuffers(2, positions);
+	glGenBuffers(1, &params);
+	for (int i = 0; i < 2; i++) {
+		glBindBuffer(GL_ARRAY_BUFFER, positions[i]);
+		glBufferData(GL_ARRAY_BUFFER, count * 3 * sizeof(float), nullptr, GL_DYNAMIC_COPY);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, params);
+	glBufferData(GL_ARRAY_BUFFER, count * 4 * sizeof(float), nullptr, GL_STATIC_COPY);
+
+	glGenVertexArrays(2, updateVAO);
+	glGenVertexArrays(2, renderVAO);
+	for (int i = 0; i < 2; i++) {
+		glBindVertexArray(updateVAO[i]);
+		glBindBuffer(GL_ARRAY_BUFFER, positions[i]);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+		glBindBuffer(GL_ARRAY_BUFFER, params);
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+
+		glBindVertexArray(renderVAO[i]);
+		bindFlakeAttributes(i, 0);
+		if (starMesh == 0) continue;
+
+		glGenVertexArrays(1, &instancedVAO[i]);
+		glBindVertexArray(instancedVAO[i]);
+		bindFlakeAttributes(i, 1);
+		glBindBuffer(GL_ARRAY_BUFFER, starMesh);
+		glEnableVertexAttribArray(3);
+		glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+	}
+	glBindVertexArray(0);
+
+	// snow_init.vert has no inputs: draw from an empty VAO, params must not be read while written
+	GLuint emptyVAO = 0;
+	glGenVertexArrays(1, &emptyVAO);
+	initProgram->use();
+	initProgram->set_uniform_value("seed", (int)seed);
+	initProgram->set_uniform_value("volume", glm::vec3(volume.areaSize, volume.heightMin, volume.heightMax));
+	GLuint outputs[2] = {positions[0], params};
+	runFeedback(emptyVAO, outputs, 2);
+	glDeleteVertexArrays(1, &emptyVAO);
+}
+
+void GpuSnowSystem::update(float time, float dt){
+	if (count == 0) return;
+
+	step++;
+	updateProgram->use();
+	updateProgram->set_uniform_value("swayTime", time * SnowSystem::SWAY_FREQUENCY);
+	updateProgram->set_uniform_value("swayAmount", SnowSystem::SWAY_AMPLITUDE * dt);
+	updateProgram->set_uniform_value("deltaTime", dt);
+	updateProgram->set_uniform_value("seed", (int)(seed ^ (step * 0x9E3779B9u)));
+	updateProgram->set_uniform_value("volume", glm::vec3(volume.areaSize, volume.heightMin, volume.heightMax));
+
+	int next = 1 - current;
+	runFeedback(updateVAO[current], &positions[next], 1);
+	current = next;
+}
+
+// snowflake.vert / snowflake_instanced.vert inputs into the bound vertex array: position, size, rotation
+void GpuSnowSystem::bindFlakeAttributes(int buffer, GLuint divisor){
+	glBindBuffer(GL_ARRAY_BUFFER, positions[buffer]);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+	glBindBuffer(GL_ARRAY_BUFFER, params);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(1 * sizeof(float)));
+	for (GLuint location = 0; location < 3; location++) glVertexAttribDivisor(location, divisor);
+}
+
+// Every flake through the bound program as one point, outputs to 'buffers' (binding i = buffers[i])
+void GpuSnowSystem::runFeedback(GLuint vertexArray, const GLuint* buffers, int bufferCount){
+	glEnable(GL_RASTERIZER_DISCARD);
+	glBindVertexArray(vertexArray);
+	for (int i = 0; i < bufferCount; i++) glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, i, buffers[i]);
+	glBeginTransformFeedback(GL_POINTS);
+	glDrawArrays(GL_POINTS, 0, (GLsizei)count);
+	glEndTransformFeedback();
+	for (int i = 0; i < bufferCount; i++) glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, i, 0);
+	glBindVertexArray(0);
+	glDisable(GL_RASTERIZER_DISCARD);
+}
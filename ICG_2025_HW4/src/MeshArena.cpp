@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "header/MeshArena.h"
+
+MeshArena::MeshArena(const VertexLayout& layout) : vertexLayout(layout){
+	glGenVertexArrays(1, &VAO);
+}
+
+MeshArena::~MeshArena(){
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+	glDeleteBuffers(1, &drawIdBuffer);
+	glDeleteVertexArrays(1, &VAO);
+}
+
+bool MeshArena::accepts(const VertexLayout& layout) const{
+	return memcmp(&layout, &vertexLayout, sizeof(VertexLayout)) == 0;
+}
+
+// New buffer of at least 'needed' bytes (doubling, so n meshes cost log n copies), old contents
+// copied over on the GPU
+void MeshArena::grow(GLenum target, GLuint& buffer, size_t& capacity, size_t used, size_t needed){
+	if (needed <= capacity) return;
+	size_t newCapacity = std::max(needed, capacity * 2);
+
+	GLuint newBuffer = 0;
+	glGenBuffers(1, &newBuffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, newCapacity, nullptr, GL_STATIC_DRAW);
+	if (used > 0) {
+		glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used);
+	}
+	glDeleteBuffers(1, &buffer);
+	buffer = newBuffer;
+	capacity = newCapacity;
+
+	// the element buffer binding is VAO state, the vertex buffer is captured by glVertexAttribPointer
+	glBindVertexArray(VAO);
+	if (target == GL_ELEMENT_ARRAY_BUFFER) glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+	else attachVertexBuffer();
+	glBindVertexArray(0);
+}
+
+void MeshArena::attachVertexBuffer(){
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	for (uint32_t i = 0; i < vertexLayout.attributeCount; i++) {
+		const VertexAttribute& attr = vertexLayout.attributes[i];
+		glVertexAttribPointer(attr.location, attr.components, attr.type, attr.normalized ? GL_TRUE : GL_FALSE,
+		                      vertexLayout.stride, (void*)(uintptr_t)attr.offset);
+		glEnableVertexAttribArray(attr.location);
+	}
+}
+
+MeshRange MeshArena::add(const MeshData& mesh){
+	MeshRange range;
+	if (!accepts(mesh.layout) || mesh.indexCount == 0) return range;
+
+	grow(GL_ARRAY_BUFFER, VBO, vertexCapacity, vertexUsed, vertexUsed + mesh.vertexBytes());
+	grow(GL_ELEMENT_ARRAY_BUFFER, EBO, indexCapacity, indexUsed, indexUsed + mesh.indexBytes());
+
+	range.baseVertex = (int32_t)(vertexUsed / vertexLayout.stride);
+	range.firstIndex = (uint32_t)(indexUsed / sizeof(unsigned int));
+	range.indexCount = mesh.indexCount;
+
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferSubData(GL_ARRAY_BUFFER, vertexUsed, mesh.vertexBytes(), mesh.vertexData());
+	// GL_ELEMENT_ARRAY_BUFFER would need the VAO bound, any target works for the upload itself
+	glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, indexUsed, mesh.indexBytes(), mesh.indexData());
+
+	vertexUsed += mesh.vertexBytes();
+	indexUsed += mesh.indexBytes();
+	return range;
+}
+
+void MeshArena::reserveDrawIds(uint32_t count){
+	if (count <= drawIdCapacity) return;
+	drawIdCapacity = std::max(count, drawIdCapacity * 2);
+
+	std::vector<uint32_t> ids(drawIdCapacity);
+	for (uint32_t i = 0; i < drawIdCapacity; i++) ids[i] = i;
+
+	if (drawIdBuffer == 0) glGenBuffers(1, &drawIdBuffer);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, drawIdBuffer);
+	glBufferData(GL_ARRAY_BUFFER, ids.size() * sizeof(uint32_t), ids.data(), GL_STATIC_DRAW);
+	glVertexAttribIPointer(DRAW_ID_LOCATION, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (void*)0);
+	glEnableVertexAttribArray(DRAW_ID_LOCATION);
+	glVertexAttribDivisor(DRAW_ID_LOCATION, 1); // one id per instance, offset by baseInstance
+	glBindVertexArray(0);
+}
@@ -0,0 +1,201 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+
+#include "header/MeshCache.h"
+
+static bool statFile(const std::string& path, uint64_t& size, int64_t& mtime){
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0) return false;
+	size = (uint64_t)st.st_size;
+	mtime = (int64_t)st.st_mtime;
+	return true;
+}
+
+// Only the mtime moved and the hash matched: store the new mtime so the next launch skips the hash.
+// The header is patched in place, the blobs (maybe mapped right now) are not touched.
+static void updateSourceMtime(const std::string& cachePath, int64_t sourceMtime){
+	std::fstream fs(cachePath, std::ios::binary | std::ios::in | std::ios::out);
+	if (!fs) return;
+	fs.seekp(offsetof(MeshCacheHeader, sourceMtime));
+	fs.write((const char*)&sourceMtime, sizeof(sourceMtime));
+}
+
+// pid + counter: other processes and other meshes of this one never share a temporary file
+static std::string uniqueTempPath(const std::string& path){
+	static std::atomic<unsigned int> counter(0);
+#if defined(__linux__) || defined(__APPLE__)
+	long pid = (long)getpid();
+#else
+	long pid = (long)_getpid();
+#endif
+	return path + "." + std::to_string(pid) + "." + std::to_string(counter++) + ".tmp";
+}
+
+bool MappedFile::open(const std::string& path){
+	close();
+
+#if defined(__linux__) || defined(__APPLE__)
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		::close(fd);
+		return false;
+	}
+
+	void* ptr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd); // the mapping keeps its own reference
+	if (ptr == MAP_FAILED) return false;
+
+	bytes = (const unsigned char*)ptr;
+	length = (size_t)st.st_size;
+	mapped = true;
+	return true;
+#else
+	std::ifstream fs(path, std::ios::binary | std::ios::ate);
+	if (!fs) return false;
+	std::streamsize size = fs.tellg();
+	if (size <= 0) return false;
+	fallback.resize((size_t)size);
+	fs.seekg(0);
+	if (!fs.read((char*)fallback.data(), size)) return false;
+
+	bytes = fallback.data();
+	length = fallback.size();
+	return true;
+#endif
+}
+
+void MappedFile::close(){
+#if defined(__linux__) || defined(__APPLE__)
+	if (mapped) munmap((void*)bytes, length);
+#endif
+	fallback.clear();
+	fallback.shrink_to_fit();
+	bytes = nullptr;
+	length = 0;
+	mapped = false;
+}
+
+uint64_t hashFileContents(const std::string& path){
+	MappedFile file;
+	if (!file.open(path)) return 0;
+
+	// FNV-1a 64
+	uint64_t h = 14695981039346656037ull;
+	const unsigned char* p = file.data();
+	for (size_t i = 0; i < file.size(); i++) {
+		h ^= p[i];
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+void MeshData::release(){
+	std::vector<unsigned char>().swap(vertices);
+	std::vector<unsigned int>().swap(indices);
+	vertexPtr = nullptr;
+	indexPtr = nullptr;
+	file.close();
+}
+
+bool MeshData::readCache(const std::string& cachePath, const std::string& sourcePath){
+	uint64_t sourceSize;
+	int64_t sourceMtime;
+	if (!statFile(sourcePath, sourceSize, sourceMtime)) return false;
+
+	if (!file.open(cachePath)) return false;
+	if (file.size() < sizeof(MeshCacheHeader)) {
+		file.close();
+		return false;
+	}
+
+	MeshCacheHeader header;
+	memcpy(&header, file.data(), sizeof(header));
+
+	bool valid = header.magic == MESH_CACHE_MAGIC && header.version == MESH_CACHE_VERSION &&
+	             header.sourceSize == sourceSize &&
+	             header.layout.attributeCount <= MAX_VERTEX_ATTRIBUTES &&
+	             header.vertexOffset + (uint64_t)header.vertexCount * header.layout.stride <= file.size() &&
+	             header.indexOffset + (uint64_t)header.indexCount * sizeof(unsigned int) <= file.size() &&
+	             header.indexOffset % sizeof(unsigned int) == 0;
+	if (valid && header.sourceMtime != sourceMtime) {
+		valid = header.sourceHash == hashFileContents(sourcePath);
+		if (valid) updateSourceMtime(cachePath, sourceMtime);
+	}
+	if (!valid) {
+		file.close();
+		return false;
+	}
+
+	layout = header.layout;
+	vertexCount = header.vertexCount;
+	indexCount = header.indexCount;
+	boundsMin = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+	boundsMax = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+	boundsRadius = header.boundsRadius;
+
+	vertices.clear();
+	indices.clear();
+	vertexPtr = file.data() + header.vertexOffset;
+	indexPtr = (const unsigned int*)(file.data() + header.indexOffset);
+	return true;
+}
+
+bool MeshData::writeCache(const std::string& cachePath, const std::string& sourcePath) const{
+	MeshCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = MESH_CACHE_MAGIC;
+	header.version = MESH_CACHE_VERSION;
+	if (!statFile(sourcePath, header.sourceSize, header.sourceMtime)) return false;
+	header.sourceHash = hashFileContents(sourcePath);
+
+	header.layout = layout;
+	header.vertexCount = vertexCount;
+	header.indexCount = indexCount;
+	for (int i = 0; i < 3; i++) {
+		header.boundsMin[i] = boundsMin[i];
+		header.boundsMax[i] = boundsMax[i];
+	}
+	header.boundsRadius = boundsRadius;
+	header.vertexOffset = sizeof(MeshCacheHeader);
+	header.indexOffset = header.vertexOffset + vertexBytes();
+	header.indexOffset = (header.indexOffset + 3) & ~(uint64_t)3;
+
+	// write to a temporary file first so a crash never leaves a truncated cache behind
+	std::string tmpPath = uniqueTempPath(cachePath);
+	{
+		std::ofstream fs(tmpPath, std::ios::binary | std::ios::trunc);
+		if (!fs) {
+			std::cerr << "Failed to write mesh cache: " << cachePath << std::endl;
+			return false;
+		}
+		fs.write((const char*)&header, sizeof(header));
+		fs.write((const char*)vertexData(), vertexBytes());
+		static const char padding[4] = {0, 0, 0, 0};
+		fs.write(padding, header.indexOffset - header.vertexOffset - vertexBytes());
+		fs.write((const char*)indexData(), indexBytes());
+		if (!fs) {
+			std::cerr << "Failed to write mesh cache: " << cachePath << std::endl;
+			fs.close();
+			std::remove(tmpPath.c_str());
+			return false;
+		}
+	}
+	std::remove(cachePath.c_str());
+	return std::rename(tmpPath.c_str(), cachePath.c_str()) == 0;
+}
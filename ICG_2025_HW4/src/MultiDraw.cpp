@@ -0,0 +1,81 @@
+#include <cstring>
+
+#include "header/MultiDraw.h"
+#include "header/Transform.h"
+
+bool MultiDrawBatch::supported(){
+	return GLAD_GL_VERSION_4_3 != 0;
+}
+
+MultiDrawBatch::~MultiDrawBatch(){
+	glDeleteBuffers(1, &dataBuffer);
+}
+
+void MultiDrawBatch::add(const MeshRange& range, const glm::mat4& model, const glm::mat4& decode, int materialIndex,
+                         const BoundingSphere& sphere, const BoundingBox& box){
+	glm::mat4 matrix = model * decode;
+	glm::mat3 normal = normalMatrix(matrix);
+
+	DrawData data = {};
+	data.model = matrix;
+	for (int i = 0; i < 3; i++) data.normalMatrix[i] = glm::vec4(normal[i], 0.0f);
+	data.materialIndex = materialIndex;
+
+	DrawElementsIndirectCommand command;
+	command.count = range.indexCount;
+	command.instanceCount = 1;
+	command.firstIndex = range.firstIndex;
+	command.baseVertex = range.baseVertex;
+	command.baseInstance = (uint32_t)drawData.size();
+
+	drawData.push_back(data);
+	allCommands.push_back(command);
+	commands.push_back(command);
+	culler.add(sphere, box);
+	dataDirty = true;
+
+	// binds the arena's VAO, so not from draw() where RenderQueue tracks the bound VAO
+	arena.reserveDrawIds((uint32_t)drawData.size());
+}
+
+void MultiDrawBatch::clear(){
+	drawData.clear();
+	allCommands.clear();
+	commands.clear();
+	culler.clear();
+	dataDirty = true;
+}
+
+void MultiDrawBatch::cull(const Frustum& frustum, CullStats& stats){
+	culler.cull(frustum, visible, stats);
+	commands.clear();
+	for (size_t i = 0; i < allCommands.size(); i++) {
+		if (visible[i]) commands.push_back(allCommands[i]);
+	}
+}
+
+void MultiDrawBatch::draw(){
+	if (drawData.empty()) return;
+
+	if (dataDirty) {
+		if (dataBuffer == 0) glGenBuffers(1, &dataBuffer);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, dataBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, drawData.size() * sizeof(DrawData), drawData.data(), GL_STATIC_DRAW);
+		dataDirty = false;
+	}
+	if (commands.empty()) return;
+
+	// the command list changes with the camera: streamed, room for every draw so reserve() only
+	// runs again after add()
+	size_t bytes = commands.size() * sizeof(DrawElementsIndirectCommand);
+	commandStream.reserve(allCommands.size() * sizeof(DrawElementsIndirectCommand));
+	void* mapped = commandStream.map(bytes);
+	if (mapped == nullptr) return;
+	memcpy(mapped, commands.data(), bytes);
+	size_t offset = commandStream.unmap();
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_DATA_BINDING, dataBuffer);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandStream.buffer());
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)offset, (GLsizei)commands.size(), 0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
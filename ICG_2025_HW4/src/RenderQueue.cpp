@@ -0,0 +1,201 @@
+#include <cstring>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "header/MultiDraw.h"
+#include "header/RenderQueue.h"
+#include "header/shader.h"
+
+void GLStateCache::invalidate(){
+	GLStateStats kept = counters;
+	*this = GLStateCache();
+	counters = kept;
+}
+
+bool GLStateCache::changed(GLuint& cached, GLuint value){
+	if (cached == value) {
+		counters.redundant++;
+		return false;
+	}
+	cached = value;
+	counters.issued++;
+	return true;
+}
+
+void GLStateCache::useProgram(shader_program_t* shader){
+	GLuint id = shader ? shader->get_program_id() : 0;
+	if (!changed(program, id)) return;
+	if (shader) shader->use(); // also finishes a pending link
+	else glUseProgram(0);
+}
+
+void GLStateCache::bindVertexArray(GLuint vao){
+	if (changed(vertexArray, vao)) glBindVertexArray(vao);
+}
+
+void GLStateCache::bindTexture(int unit, GLenum target, GLuint texture){
+	GLuint& cached = textures[unit][target == GL_TEXTURE_CUBE_MAP ? 1 : 0];
+	if (!changed(cached, texture)) return;
+	activeTexture(unit);
+	glBindTexture(target, texture);
+}
+
+void GLStateCache::activeTexture(int unit){
+	if (activeUnit == unit) return;
+	glActiveTexture(GL_TEXTURE0 + unit);
+	activeUnit = unit;
+}
+
+void GLStateCache::apply(const RenderState& state){
+	if (changed(blend, state.blend ? 1 : 0)) {
+		if (state.blend) glEnable(GL_BLEND);
+		else glDisable(GL_BLEND);
+	}
+	if (changed(depthWrite, state.depthWrite ? 1 : 0)) glDepthMask(state.depthWrite ? GL_TRUE : GL_FALSE);
+	if (changed(depthFunc, state.depthFunc)) glDepthFunc(state.depthFunc);
+}
+
+void radixSortKeys(std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch){
+	size_t n = entries.size();
+	if (n < 2) return;
+	scratch.resize(n);
+
+	SortEntry* src = entries.data();
+	SortEntry* dst = scratch.data();
+	for (int shift = 0; shift < 64; shift += 8) {
+		size_t counts[256] = {};
+		for (size_t i = 0; i < n; i++) counts[(src[i].key >> shift) & 0xFF]++;
+		if (counts[(src[0].key >> shift) & 0xFF] == n) continue; // every key has this byte
+
+		size_t offset = 0;
+		for (int b = 0; b < 256; b++) {
+			size_t count = counts[b];
+			counts[b] = offset;
+			offset += count;
+		}
+		for (size_t i = 0; i < n; i++) dst[counts[(src[i].key >> shift) & 0xFF]++] = src[i];
+		std::swap(src, dst);
+	}
+	if (src != entries.data()) memcpy(entries.data(), src, n * sizeof(SortEntry));
+}
+
+// Non-negative floats compare like their bit patterns; the top 24 bits keep the order
+static uint64_t depthBits(float depth){
+	if (!(depth > 0.0f)) return 0;
+	uint32_t bits;
+	memcpy(&bits, &depth, sizeof(bits));
+	return bits >> 8;
+}
+
+uint64_t RenderQueue::sortKey(const RenderItem& item){
+	uint64_t program = item.program ? (item.program->get_program_id() & 0x3FF) : 0;
+	uint64_t texture = item.textures[0].texture & 0xFFF;
+	uint64_t vao = item.vertexArray & 0xFFF;
+	uint64_t pass = (uint64_t)item.pass;
+	uint64_t depth = depthBits(item.depth);
+
+	if (item.pass == RenderPass::BLENDED) {
+		// blending needs far to near; state only breaks ties
+		return pass << 62 | (0xFFFFFFull - depth) << 38 | program << 28 | texture << 16 | vao << 4;
+	}
+	return pass << 62 | program << 52 | texture << 40 | vao << 28 | depth << 4;
+}
+
+// The same comparisons GLStateCache makes, without touching GL
+unsigned int RenderQueue::countStateChanges(const std::vector<SortEntry>& sequence) const{
+	unsigned int changes = 0;
+	const RenderItem* previous = nullptr;
+	for (const SortEntry& entry : sequence) {
+		const RenderItem& item = items[entry.index];
+		if (!previous) {
+			changes += 5; // program, vertex array, blend, depth mask, depth func
+			for (const TextureBinding& binding : item.textures) changes += binding.texture != 0;
+			previous = &item;
+			continue;
+		}
+		changes += item.program != previous->program;
+		changes += item.vertexArray != previous->vertexArray;
+		changes += item.state.blend != previous->state.blend;
+		changes += item.state.depthWrite != previous->state.depthWrite;
+		changes += item.state.depthFunc != previous->state.depthFunc;
+		for (int unit = 0; unit < GLStateCache::MAX_TEXTURE_UNITS; unit++) {
+			const TextureBinding& binding = item.textures[unit];
+			changes += binding.texture != 0 && binding.texture != previous->textures[unit].texture;
+		}
+		previous = &item;
+	}
+	return changes;
+}
+
+void RenderQueue::draw(const RenderItem& item, GLStateCache& state) const{
+	state.apply(item.state);
+	state.useProgram(item.program);
+	for (int unit = 0; unit < GLStateCache::MAX_TEXTURE_UNITS; unit++) {
+		const TextureBinding& binding = item.textures[unit];
+		if (binding.texture != 0) state.bindTexture(unit, binding.target, binding.texture);
+	}
+
+	// the program caches uniform values, unchanged ones are not uploaded again
+	if (item.hasModel) {
+		item.program->set_uniform_value("model", item.model);
+		item.program->set_uniform_value("normalMatrix", item.normalMatrix);
+	}
+	if (item.materialIndex >= 0) item.program->set_uniform_value("materialIndex", item.materialIndex);
+	for (int i = 0; i < item.floatCount; i++) {
+		item.program->set_uniform_value(item.floats[i].name, item.floats[i].value);
+	}
+
+	state.bindVertexArray(item.vertexArray);
+	if (item.before) item.before();
+	void* indices = (void*)(sizeof(GLuint) * item.firstIndex);
+	if (item.batch) item.batch->draw();
+	else if (item.instanceCount > 0 && item.indexed) glDrawElementsInstancedBaseVertex(item.mode, item.count, GL_UNSIGNED_INT,
+	                                                                                   indices, item.instanceCount, item.baseVertex);
+	else if (item.instanceCount > 0 && item.baseInstance > 0) glDrawArraysInstancedBaseInstance(item.mode, item.firstIndex, item.count,
+	                                                                                            item.instanceCount, item.baseInstance);
+	else if (item.instanceCount > 0) glDrawArraysInstanced(item.mode, item.firstIndex, item.count, item.instanceCount);
+	else if (item.indexed) glDrawElementsBaseVertex(item.mode, item.count, GL_UNSIGNED_INT, indices, item.baseVertex);
+	else glDrawArrays(item.mode, item.firstIndex, item.count);
+	if (item.after) item.after();
+}
+
+void RenderQueue::execute(GLStateCache& state, const Frustum* frustum){
+	lastStats.cull = CullStats();
+	visible.assign(items.size(), 1);
+	if (frustum) {
+		culler.clear();
+		bounded.clear();
+		for (size_t i = 0; i < items.size(); i++) {
+			if (!items[i].hasBounds) continue;
+			culler.add(items[i].sphere, items[i].box);
+			bounded.push_back((uint32_t)i);
+		}
+		culler.cull(*frustum, inside, lastStats.cull);
+		for (size_t j = 0; j < bounded.size(); j++) visible[bounded[j]] = inside[j];
+	}
+
+	order.clear();
+	for (size_t i = 0; i < items.size(); i++) {
+		if (visible[i]) order.push_back({sortKey(items[i]), (uint32_t)i});
+	}
+
+	lastStats.draws = (unsigned int)order.size();
+	lastStats.batchedDraws = 0;
+	for (const SortEntry& entry : order) {
+		if (items[entry.index].batch) lastStats.batchedDraws += (unsigned int)items[entry.index].batch->visibleCount();
+	}
+	lastStats.changesSubmitted = countStateChanges(order);
+	radixSortKeys(order, scratch);
+	lastStats.changesSorted = countStateChanges(order);
+
+	// uploads, reloads and lazily linked programs bind things between frames
+	state.invalidate();
+	for (const SortEntry& entry : order) draw(items[entry.index], state);
+
+	state.apply(RenderState());
+	state.bindVertexArray(0);
+	state.useProgram(nullptr);
+	state.activeTexture(0); // texture uploads outside the queue bind on the active unit
+	items.clear();
+}
@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <iostream>
+#include <sys/stat.h>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "header/ShaderWatcher.h"
+#include "header/shader.h"
+
+// "dir/" part of a path, empty if there is none
+static std::string directoryOf(const std::string& path){
+	size_t slash = path.find_last_of("/\\");
+	return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+ShaderWatcher::ShaderWatcher(){
+#if defined(__linux__)
+	inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (inotifyFd < 0) std::cout << "ShaderWatcher: inotify unavailable, shader hot reload is off" << std::endl;
+#else
+	lastScan = std::chrono::steady_clock::now();
+#endif
+}
+
+ShaderWatcher::~ShaderWatcher(){
+#if defined(__linux__)
+	if (inotifyFd >= 0) close(inotifyFd);
+#endif
+}
+
+void ShaderWatcher::watch(shader_program_t* program){
+	for (const auto& path : program->source_files()) {
+		addFile(path, program);
+	}
+}
+
+void ShaderWatcher::unwatch(shader_program_t* program){
+	for (auto& entry : users) {
+		auto& programs = entry.second;
+		programs.erase(std::remove(programs.begin(), programs.end(), program), programs.end());
+	}
+}
+
+void ShaderWatcher::addFile(const std::string& path, shader_program_t* program){
+	auto& programs = users[path];
+	if (std::find(programs.begin(), programs.end(), program) == programs.end()) programs.push_back(program);
+
+#if defined(__linux__)
+	if (inotifyFd < 0) return;
+	std::string dir = directoryOf(path);
+	int wd = inotify_add_watch(inotifyFd, dir.empty() ? "." : dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+	if (wd >= 0 && watchedDirs.find(wd) == watchedDirs.end()) watchedDirs[wd] = dir;
+#else
+	struct stat info;
+	if (modifiedTimes.find(path) == modifiedTimes.end())
+		modifiedTimes[path] = stat(path.c_str(), &info) == 0 ? (long long)info.st_mtime : 0;
+#endif
+}
+
+void ShaderWatcher::markChanged(const std::string& path, std::vector<shader_program_t*>& changed){
+	auto found = users.find(path);
+	if (found == users.end()) return;
+	for (auto program : found->second) {
+		if (std::find(changed.begin(), changed.end(), program) == changed.end()) changed.push_back(program);
+	}
+}
+
+std::vector<shader_program_t*> ShaderWatcher::poll(){
+	std::vector<shader_program_t*> changed;
+
+#if defined(__linux__)
+	if (inotifyFd < 0) return changed;
+
+	alignas(inotify_event) char buffer[4096];
+	while (true) {
+		ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+		if (length <= 0) break;
+		for (char* p = buffer; p < buffer + length; ) {
+			const inotify_event* event = (const inotify_event*)p;
+			p += sizeof(inotify_event) + event->len;
+
+			auto dir = watchedDirs.find(event->wd);
+			if (dir == watchedDirs.end() || event->len == 0) continue;
+			markChanged(dir->second + event->name, changed);
+		}
+	}
+#else
+	// a few stat() calls per program, no need to do them every frame
+	auto now = std::chrono::steady_clock::now();
+	if (now - lastScan < std::chrono::milliseconds(250)) return changed;
+	lastScan = now;
+
+	for (auto& entry : modifiedTimes) {
+		struct stat info;
+		if (stat(entry.first.c_str(), &info) != 0) continue;   // mid-save, try again next scan
+		if ((long long)info.st_mtime == entry.second) continue;
+		entry.second = (long long)info.st_mtime;
+		markChanged(entry.first, changed);
+	}
+#endif
+	return changed;
+}
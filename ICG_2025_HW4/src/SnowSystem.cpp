@@ -0,0 +1,362 @@
+#include <cmath>
+
+#include "header/SnowSystem.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define SNOW_SSE2 1
+// AVX2 is compiled in as well and picked at run time, the rest of the build stays SSE2
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define SNOW_TARGET_AVX2
+#else
+#define SNOW_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+const float PI = 3.14159265f;
+const float TWO_PI = 6.28318531f;
+// 2pi split in two (Cody-Waite) so x - k * 2pi stays accurate for large x: k * TWO_PI_HI is exact
+const float TWO_PI_HI = 6.28125f;
+const float TWO_PI_LO = 1.93530717e-3f;
+const float INV_TWO_PI = 0.159154943f;
+
+// minimax odd polynomial for sin on [0, pi/2], |error| < 7e-7
+const float SIN_C1 = 0.99999660f;
+const float SIN_C3 = -0.16664824f;
+const float SIN_C5 = 0.00830629f;
+const float SIN_C7 = -0.00018363f;
+
+inline uint32_t xorshift32(uint32_t s){
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	return s;
+}
+
+// top 24 bits -> [0, 1)
+inline float unitFloat(uint32_t s){
+	return (float)(int32_t)(s >> 8) * (1.0f / 16777216.0f);
+}
+
+// Distinct non-zero start state per flake (xorshift stays at 0 forever)
+inline uint32_t seedFor(uint32_t seed, uint32_t i){
+	uint32_t h = seed ^ (i * 0x9E3779B9u);
+	h = (h ^ (h >> 16)) * 0x85EBCA6Bu;
+	h = (h ^ (h >> 13)) * 0xC2B2AE35u;
+	h ^= h >> 16;
+	return h ? h : 0x6D2B79F5u;
+}
+
+} // namespace
+
+float SnowSystem::fastSin(float x){
+	// x - k * 2pi in [-pi, pi], then sin(|x|) = sin(min(|x|, pi - |x|)) with the sign of x
+	float k = std::nearbyint(x * INV_TWO_PI);
+	float r = (x - k * TWO_PI_HI) - k * TWO_PI_LO;
+	float a = std::fabs(r);
+	a = std::fmin(a, PI - a);
+	float a2 = a * a;
+	float s = a * (SIN_C1 + a2 * (SIN_C3 + a2 * (SIN_C5 + a2 * SIN_C7)));
+	return r < 0.0f ? -s : s;
+}
+
+bool SnowSystem::kernelSupported(Kernel kernel){
+	switch (kernel) {
+	case Kernel::Scalar:
+		return true;
+#ifdef SNOW_SSE2
+	case Kernel::SSE2:
+		return true;
+	case Kernel::AVX2: {
+#if defined(_MSC_VER) && !defined(__clang__)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) return false;
+		__cpuid(info, 1);
+		bool osxsave = (info[2] & (1 << 27)) != 0, avx = (info[2] & (1 << 28)) != 0;
+		// the OS saves the YMM registers on context switches
+		if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2") != 0;
+#endif
+	}
+#endif
+	default:
+		return false;
+	}
+}
+
+SnowSystem::Kernel SnowSystem::bestKernel(){
+	static const Kernel best = kernelSupported(Kernel::AVX2) ? Kernel::AVX2
+	                         : kernelSupported(Kernel::SSE2) ? Kernel::SSE2
+	                                                         : Kernel::Scalar;
+	return best;
+}
+
+const char* SnowSystem::kernelName(Kernel kernel){
+	switch (kernel) {
+	case Kernel::SSE2: return "SSE2";
+	case Kernel::AVX2: return "AVX2";
+	default: return "scalar";
+	}
+}
+
+void SnowSystem::reset(size_t count, uint32_t seed){
+	xs.resize(count);
+	ys.resize(count);
+	zs.resize(count);
+	fallSpeeds.resize(count);
+	swayPhases.resize(count);
+	sizes.resize(count);
+	rotations.resize(count);
+	seeds.resize(count);
+
+	float half = volume.areaSize * 0.5f;
+	for (size_t i = 0; i < count; i++) {
+		uint32_t s = seedFor(seed, (uint32_t)i);
+		auto next = [&s](float lo, float hi) {
+			s = xorshift32(s);
+			return lo + unitFloat(s) * (hi - lo);
+		};
+		xs[i] = next(-half, half);
+		ys[i] = next(volume.heightMin, volume.heightMax);
+		zs[i] = next(-half, half);
+		sizes[i] = next(2.0f, 6.0f);
+		rotations[i] = next(0.0f, TWO_PI);
+		fallSpeeds[i] = next(20.0f, 60.0f);
+		swayPhases[i] = next(0.0f, TWO_PI);
+		seeds[i] = s;
+	}
+}
+
+void SnowSystem::writeStaticAttributes(float* out) const{
+	for (size_t i = 0; i < sizes.size(); i++) {
+		out[i * 2 + 0] = sizes[i];
+		out[i * 2 + 1] = rotations[i];
+	}
+}
+
+void SnowSystem::writeOrdered(const uint32_t* order, float* out) const{
+	for (size_t i = 0; i < xs.size(); i++) {
+		uint32_t flake = order[i];
+		out[i * 5 + 0] = xs[flake];
+		out[i * 5 + 1] = ys[flake];
+		out[i * 5 + 2] = zs[flake];
+		out[i * 5 + 3] = sizes[flake];
+		out[i * 5 + 4] = rotations[flake];
+	}
+}
+
+void SnowSystem::writeStarMesh(float* out){
+	const float pi = 3.14159265f;
+	const float inner = 0.3f;
+	auto corner = [&out](float angle, float radius) {
+		*out++ = std::cos(angle) * radius;
+		*out++ = std::sin(angle) * radius;
+	};
+	for (int i = 0; i < 6; i++) {
+		float angle = i * pi / 3.0f;
+		// hexagon slice, then the branch from the hexagon out to the tip
+		*out++ = 0.0f;
+		*out++ = 0.0f;
+		corner(angle, inner);
+		corner((i + 1) * pi / 3.0f, inner);
+		corner(angle - 0.15f, inner);
+		corner(angle, 1.0f);
+		corner(angle + 0.15f, inner);
+	}
+}
+
+void SnowSystem::update(float time, float dt, float* out, Kernel kernel){
+	if (!kernelSupported(kernel)) kernel = Kernel::Scalar;
+
+	float swayTime = time * SWAY_FREQUENCY;
+	float swayAmount = SWAY_AMPLITUDE * dt;
+	size_t done = 0;
+	if (kernel == Kernel::AVX2) done = updateAVX2(swayTime, swayAmount, dt, out);
+	else if (kernel == Kernel::SSE2) done = updateSSE2(swayTime, swayAmount, dt, out);
+	// the kernels leave the last count % lanes flakes
+	updateScalar(done, xs.size(), swayTime, swayAmount, dt, out);
+}
+
+void SnowSystem::updateScalar(size_t begin, size_t end, float swayTime, float swayAmount, float dt, float* out){
+	float half = volume.areaSize * 0.5f;
+	for (size_t i = begin; i < end; i++) {
+		float x = xs[i] + fastSin(swayTime + swayPhases[i]) * swayAmount;
+		float y = ys[i] - fallSpeeds[i] * dt;
+		float z = zs[i];
+		if (y < volume.heightMin) {
+			uint32_t s1 = xorshift32(seeds[i]);
+			uint32_t s2 = xorshift32(s1);
+			x = -half + unitFloat(s1) * volume.areaSize;
+			z = -half + unitFloat(s2) * volume.areaSize;
+			y = volume.heightMax;
+			seeds[i] = s2;
+		}
+		xs[i] = x;
+		ys[i] = y;
+		zs[i] = z;
+		out[i * 3 + 0] = x;
+		out[i * 3 + 1] = y;
+		out[i * 3 + 2] = z;
+	}
+}
+
+#ifdef SNOW_SSE2
+
+namespace {
+
+inline __m128 select(__m128 mask, __m128 a, __m128 b){
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+inline __m128 sin4(__m128 x){
+	__m128 k = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(INV_TWO_PI)))); // round to nearest
+	__m128 r = _mm_sub_ps(_mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(TWO_PI_HI))), _mm_mul_ps(k, _mm_set1_ps(TWO_PI_LO)));
+	__m128 signBit = _mm_set1_ps(-0.0f);
+	__m128 a = _mm_andnot_ps(signBit, r);
+	a = _mm_min_ps(a, _mm_sub_ps(_mm_set1_ps(PI), a));
+	__m128 a2 = _mm_mul_ps(a, a);
+	__m128 p = _mm_add_ps(_mm_set1_ps(SIN_C5), _mm_mul_ps(a2, _mm_set1_ps(SIN_C7)));
+	p = _mm_add_ps(_mm_set1_ps(SIN_C3), _mm_mul_ps(a2, p));
+	p = _mm_add_ps(_mm_set1_ps(SIN_C1), _mm_mul_ps(a2, p));
+	return _mm_xor_ps(_mm_mul_ps(a, p), _mm_and_ps(signBit, r));
+}
+
+inline __m128i xorshift4(__m128i s){
+	s = _mm_xor_si128(s, _mm_slli_epi32(s, 13));
+	s = _mm_xor_si128(s, _mm_srli_epi32(s, 17));
+	return _mm_xor_si128(s, _mm_slli_epi32(s, 5));
+}
+
+inline __m128 unitFloat4(__m128i s){
+	return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(s, 8)), _mm_set1_ps(1.0f / 16777216.0f));
+}
+
+// x0..3, y0..3, z0..3 -> x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3, three full 16 byte stores so
+// write-combined (mapped) memory gets whole, sequential writes
+inline void storeXYZ4(float* out, __m128 x, __m128 y, __m128 z){
+	__m128 xyLo = _mm_unpacklo_ps(x, y); // x0 y0 x1 y1
+	__m128 xyHi = _mm_unpackhi_ps(x, y); // x2 y2 x3 y3
+	__m128 zx = _mm_shuffle_ps(z, xyLo, _MM_SHUFFLE(2, 2, 0, 0));   // z0 z0 x1 x1
+	__m128 yz = _mm_shuffle_ps(xyLo, z, _MM_SHUFFLE(1, 1, 3, 3));   // y1 y1 z1 z1
+	__m128 zx2 = _mm_shuffle_ps(z, xyHi, _MM_SHUFFLE(2, 2, 2, 2));  // z2 z2 x3 x3
+	__m128 yz3 = _mm_shuffle_ps(xyHi, z, _MM_SHUFFLE(3, 3, 3, 3));  // y3 y3 z3 z3
+	_mm_storeu_ps(out + 0, _mm_shuffle_ps(xyLo, zx, _MM_SHUFFLE(2, 0, 1, 0)));
+	_mm_storeu_ps(out + 4, _mm_shuffle_ps(yz, xyHi, _MM_SHUFFLE(1, 0, 2, 0)));
+	_mm_storeu_ps(out + 8, _mm_shuffle_ps(zx2, yz3, _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+} // namespace
+
+size_t SnowSystem::updateSSE2(float swayTime, float swayAmount, float dt, float* out){
+	const __m128 time4 = _mm_set1_ps(swayTime), sway4 = _mm_set1_ps(swayAmount), dt4 = _mm_set1_ps(dt);
+	const __m128 minY = _mm_set1_ps(volume.heightMin), maxY = _mm_set1_ps(volume.heightMax);
+	const __m128 area = _mm_set1_ps(volume.areaSize), lo = _mm_set1_ps(-volume.areaSize * 0.5f);
+
+	size_t n = xs.size(), i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128 x = _mm_loadu_ps(&xs[i]);
+		__m128 y = _mm_loadu_ps(&ys[i]);
+		__m128 z = _mm_loadu_ps(&zs[i]);
+		x = _mm_add_ps(x, _mm_mul_ps(sin4(_mm_add_ps(time4, _mm_loadu_ps(&swayPhases[i]))), sway4));
+		y = _mm_sub_ps(y, _mm_mul_ps(_mm_loadu_ps(&fallSpeeds[i]), dt4));
+
+		__m128 respawn = _mm_cmplt_ps(y, minY);
+		if (_mm_movemask_ps(respawn)) {
+			__m128i s = _mm_loadu_si128((const __m128i*)&seeds[i]);
+			__m128i s1 = xorshift4(s), s2 = xorshift4(s1);
+			x = select(respawn, _mm_add_ps(lo, _mm_mul_ps(unitFloat4(s1), area)), x);
+			z = select(respawn, _mm_add_ps(lo, _mm_mul_ps(unitFloat4(s2), area)), z);
+			y = select(respawn, maxY, y);
+			__m128i keep = _mm_castps_si128(respawn);
+			s = _mm_or_si128(_mm_and_si128(keep, s2), _mm_andnot_si128(keep, s));
+			_mm_storeu_si128((__m128i*)&seeds[i], s);
+		}
+
+		_mm_storeu_ps(&xs[i], x);
+		_mm_storeu_ps(&ys[i], y);
+		_mm_storeu_ps(&zs[i], z);
+		storeXYZ4(out + i * 3, x, y, z);
+	}
+	return i;
+}
+
+namespace {
+
+SNOW_TARGET_AVX2 inline __m256 sin8(__m256 x){
+	__m256 k = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(INV_TWO_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	__m256 r = _mm256_sub_ps(_mm256_sub_ps(x, _mm256_mul_ps(k, _mm256_set1_ps(TWO_PI_HI))),
+	                         _mm256_mul_ps(k, _mm256_set1_ps(TWO_PI_LO)));
+	__m256 signBit = _mm256_set1_ps(-0.0f);
+	__m256 a = _mm256_andnot_ps(signBit, r);
+	a = _mm256_min_ps(a, _mm256_sub_ps(_mm256_set1_ps(PI), a));
+	__m256 a2 = _mm256_mul_ps(a, a);
+	__m256 p = _mm256_add_ps(_mm256_set1_ps(SIN_C5), _mm256_mul_ps(a2, _mm256_set1_ps(SIN_C7)));
+	p = _mm256_add_ps(_mm256_set1_ps(SIN_C3), _mm256_mul_ps(a2, p));
+	p = _mm256_add_ps(_mm256_set1_ps(SIN_C1), _mm256_mul_ps(a2, p));
+	return _mm256_xor_ps(_mm256_mul_ps(a, p), _mm256_and_ps(signBit, r));
+}
+
+SNOW_TARGET_AVX2 inline __m256i xorshift8(__m256i s){
+	s = _mm256_xor_si256(s, _mm256_slli_epi32(s, 13));
+	s = _mm256_xor_si256(s, _mm256_srli_epi32(s, 17));
+	return _mm256_xor_si256(s, _mm256_slli_epi32(s, 5));
+}
+
+SNOW_TARGET_AVX2 inline __m256 unitFloat8(__m256i s){
+	return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(s, 8)), _mm256_set1_ps(1.0f / 16777216.0f));
+}
+
+} // namespace
+
+SNOW_TARGET_AVX2 size_t SnowSystem::updateAVX2(float swayTime, float swayAmount, float dt, float* out){
+	const __m256 time8 = _mm256_set1_ps(swayTime), sway8 = _mm256_set1_ps(swayAmount), dt8 = _mm256_set1_ps(dt);
+	const __m256 minY = _mm256_set1_ps(volume.heightMin), maxY = _mm256_set1_ps(volume.heightMax);
+	const __m256 area = _mm256_set1_ps(volume.areaSize), lo = _mm256_set1_ps(-volume.areaSize * 0.5f);
+
+	size_t n = xs.size(), i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256 x = _mm256_loadu_ps(&xs[i]);
+		__m256 y = _mm256_loadu_ps(&ys[i]);
+		__m256 z = _mm256_loadu_ps(&zs[i]);
+		x = _mm256_add_ps(x, _mm256_mul_ps(sin8(_mm256_add_ps(time8, _mm256_loadu_ps(&swayPhases[i]))), sway8));
+		y = _mm256_sub_ps(y, _mm256_mul_ps(_mm256_loadu_ps(&fallSpeeds[i]), dt8));
+
+		__m256 respawn = _mm256_cmp_ps(y, minY, _CMP_LT_OQ);
+		if (_mm256_movemask_ps(respawn)) {
+			__m256i s = _mm256_loadu_si256((const __m256i*)&seeds[i]);
+			__m256i s1 = xorshift8(s), s2 = xorshift8(s1);
+			x = _mm256_blendv_ps(x, _mm256_add_ps(lo, _mm256_mul_ps(unitFloat8(s1), area)), respawn);
+			z = _mm256_blendv_ps(z, _mm256_add_ps(lo, _mm256_mul_ps(unitFloat8(s2), area)), respawn);
+			y = _mm256_blendv_ps(y, maxY, respawn);
+			s = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(s), _mm256_castsi256_ps(s2), respawn));
+			_mm256_storeu_si256((__m256i*)&seeds[i], s);
+		}
+
+		_mm256_storeu_ps(&xs[i], x);
+		_mm256_storeu_ps(&ys[i], y);
+		_mm256_storeu_ps(&zs[i], z);
+		// the xyz interleave works within 128 bit lanes: flakes 0-3, then 4-7
+		storeXYZ4(out + i * 3, _mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm256_castps256_ps128(z));
+		storeXYZ4(out + i * 3 + 12, _mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1));
+	}
+	return i;
+}
+
+#else
+
+size_t SnowSystem::updateSSE2(float, float, float, float*){
+	return 0;
+}
+
+size_t SnowSystem::updateAVX2(float, float, float, float*){
+	return 0;
+}
+
+#endif
@@ -0,0 +1,86 @@
+#include "header/StreamBuffer.h"
+
+bool StreamBuffer::persistentSupported(){
+	return GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage;
+}
+
+StreamBuffer::~StreamBuffer(){
+	release();
+}
+
+void StreamBuffer::release(){
+	for (GLsync& fence : fences) {
+		if (fence) glDeleteSync(fence);
+		fence = 0;
+	}
+	if (mapped) {
+		glBindBuffer(target, name);
+		glUnmapBuffer(target);
+		mapped = nullptr;
+	}
+	glDeleteBuffers(1, &name);
+	name = 0;
+}
+
+void StreamBuffer::reserve(size_t bytes){
+	bytes = (bytes + 3) & ~(size_t)3; // offsets of indirect commands and vertex data must be 4 byte aligned
+	if (bytes <= regionBytes) return;
+
+	release();
+	regionBytes = bytes;
+	region = REGIONS - 1;
+	written = false;
+	GLsizeiptr total = (GLsizeiptr)(regionBytes * REGIONS);
+
+	glGenBuffers(1, &name);
+	glBindBuffer(target, name);
+	if (persistentSupported()) {
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(target, total, nullptr, flags);
+		mapped = static_cast<unsigned char*>(glMapBufferRange(target, 0, total, flags));
+		if (mapped) return;
+		// immutable storage can't take glBufferData, start over with a plain buffer
+		glDeleteBuffers(1, &name);
+		glGenBuffers(1, &name);
+		glBindBuffer(target, name);
+	}
+	glBufferData(target, total, nullptr, GL_STREAM_DRAW);
+}
+
+void* StreamBuffer::map(size_t bytes){
+	if (name == 0 || bytes > regionBytes) return nullptr;
+	glBindBuffer(target, name);
+
+	if (mapped) {
+		// every command reading the region handed out last was issued before this call
+		if (written) fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		region = (region + 1) % REGIONS;
+		written = true;
+		if (fences[region]) {
+			GLenum result = glClientWaitSync(fences[region], 0, 0);
+			if (result == GL_TIMEOUT_EXPIRED) {
+				stallCount++;
+				while (result == GL_TIMEOUT_EXPIRED) {
+					result = glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms
+				}
+			}
+			glDeleteSync(fences[region]);
+			fences[region] = 0;
+		}
+		return mapped + region * regionBytes;
+	}
+
+	region = (region + 1) % REGIONS;
+	if (region == 0) glBufferData(target, (GLsizeiptr)(regionBytes * REGIONS), nullptr, GL_STREAM_DRAW);
+	// regions after the orphaning point are never in flight: no need for the driver to check
+	return glMapBufferRange(target, (GLintptr)(region * regionBytes), (GLsizeiptr)bytes,
+	                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+}
+
+size_t StreamBuffer::unmap(){
+	if (!mapped) {
+		glBindBuffer(target, name);
+		glUnmapBuffer(target); // GL_FALSE = contents lost, the next frame rewrites them anyway
+	}
+	return region * regionBytes;
+}
@@ -0,0 +1,195 @@
+#include <cstring>
+#include <iostream>
+
+#include "header/MeshCache.h"
+#include "header/TextureCache.h"
+
+TextureSampler TextureSampler::cubemap(){
+	TextureSampler sampler;
+	sampler.target = GL_TEXTURE_CUBE_MAP;
+	sampler.wrapS = GL_CLAMP_TO_EDGE;
+	sampler.wrapT = GL_CLAMP_TO_EDGE;
+	sampler.wrapR = GL_CLAMP_TO_EDGE;
+	sampler.minFilter = GL_LINEAR;
+	sampler.magFilter = GL_LINEAR;
+	sampler.flipVertically = false;
+	return sampler;
+}
+
+bool TextureKey::operator==(const TextureKey& other) const{
+	return contentHash == other.contentHash &&
+	       sampler.target == other.sampler.target &&
+	       sampler.wrapS == other.sampler.wrapS &&
+	       sampler.wrapT == other.sampler.wrapT &&
+	       sampler.wrapR == other.sampler.wrapR &&
+	       sampler.minFilter == other.sampler.minFilter &&
+	       sampler.magFilter == other.sampler.magFilter &&
+	       sampler.flipVertically == other.sampler.flipVertically;
+}
+
+size_t TextureKeyHash::operator()(const TextureKey& key) const{
+	// FNV-1a over the sampler fields, seeded with the content hash
+	uint64_t fields[7] = {key.sampler.target, (uint64_t)key.sampler.wrapS, (uint64_t)key.sampler.wrapT,
+	                      (uint64_t)key.sampler.wrapR, (uint64_t)key.sampler.minFilter,
+	                      (uint64_t)key.sampler.magFilter, key.sampler.flipVertically ? 1u : 0u};
+	uint64_t h = key.contentHash;
+	for (uint64_t field : fields) {
+		h ^= field;
+		h *= 1099511628211ull;
+	}
+	return (size_t)h;
+}
+
+TextureCache& TextureCache::shared(){
+	static TextureCache cache;
+	return cache;
+}
+
+bool TextureCache::contains(const TextureKey& key){
+	std::lock_guard<std::mutex> lock(mutex);
+	return entries.count(key) != 0;
+}
+
+TextureRequest TextureCache::prepare(const std::vector<std::string>& paths, const TextureSampler& sampler){
+	TextureRequest request;
+	request.paths = paths;
+	request.key.sampler = sampler;
+
+	// combine the per-file hashes in order, so swapping two cubemap faces is a different texture
+	uint64_t h = 14695981039346656037ull;
+	for (const auto& path : paths) {
+		h ^= hashFileContents(path);
+		h *= 1099511628211ull;
+	}
+	request.key.contentHash = h;
+
+	if (contains(request.key)) return request;
+
+	for (const auto& path : paths) {
+		std::unique_ptr<ImageData> image(new ImageData());
+		if (!image->load(path, sampler.flipVertically)) {
+			std::cerr << "Failed to load texture: " << path << std::endl;
+		}
+		request.images.push_back(std::move(image));
+	}
+	return request;
+}
+
+TextureRequest TextureCache::prepare2D(const std::string& path, const TextureSampler& sampler){
+	return prepare(std::vector<std::string>{path}, sampler);
+}
+
+TextureRequest TextureCache::prepareCubemap(const std::vector<std::string>& faces, const TextureSampler& sampler){
+	return prepare(faces, sampler);
+}
+
+unsigned int TextureCache::finish(TextureRequest& request){
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = entries.find(request.key);
+		if (it != entries.end()) {
+			it->second.refCount++;
+			counters.hits++;
+			counters.bytesSaved += it->second.bytes;
+			request.images.clear();
+			return it->second.texture;
+		}
+	}
+
+	// skipped decoding because the texture was cached, but it has been released since
+	if (request.images.empty()) {
+		for (const auto& path : request.paths) {
+			std::unique_ptr<ImageData> image(new ImageData());
+			image->load(path, request.key.sampler.flipVertically);
+			request.images.push_back(std::move(image));
+		}
+	}
+
+	uint64_t bytes = 0;
+	unsigned int texture = upload(request, bytes);
+	request.images.clear();
+	if (texture == 0) return 0;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	entries[request.key] = {texture, 1, bytes};
+	keyOf[texture] = request.key;
+	counters.misses++;
+	counters.bytesUploaded += bytes;
+	return texture;
+}
+
+unsigned int TextureCache::upload(const TextureRequest& request, uint64_t& bytes){
+	const TextureSampler& sampler = request.key.sampler;
+	bool cubemap = sampler.target == GL_TEXTURE_CUBE_MAP;
+	if (request.images.empty() || (cubemap && request.images.size() != 6)) return 0;
+
+	// a 2D texture needs its image, a cubemap keeps going with missing faces (as before)
+	if (!cubemap && !request.images[0]->pixels) return 0;
+
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(sampler.target, texture);
+
+	// rows of 1 / 3 channel images are not 4 byte aligned in general
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	bytes = 0;
+	for (size_t i = 0; i < request.images.size(); i++) {
+		const ImageData& image = *request.images[i];
+		if (!image.pixels) continue;
+
+		GLenum format = GL_RGB;
+		if (image.channels == 1) format = GL_RED;
+		else if (image.channels == 3) format = GL_RGB;
+		else if (image.channels == 4) format = GL_RGBA;
+
+		GLenum face = cubemap ? (GLenum)(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i) : GL_TEXTURE_2D;
+		glTexImage2D(face, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.pixels);
+		bytes += image.bytes();
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	glTexParameteri(sampler.target, GL_TEXTURE_WRAP_S, sampler.wrapS);
+	glTexParameteri(sampler.target, GL_TEXTURE_WRAP_T, sampler.wrapT);
+	if (cubemap) glTexParameteri(sampler.target, GL_TEXTURE_WRAP_R, sampler.wrapR);
+	glTexParameteri(sampler.target, GL_TEXTURE_MIN_FILTER, sampler.minFilter);
+	glTexParameteri(sampler.target, GL_TEXTURE_MAG_FILTER, sampler.magFilter);
+	if (sampler.usesMipmaps()) {
+		glGenerateMipmap(sampler.target);
+		bytes = bytes * 4 / 3;
+	}
+	return texture;
+}
+
+unsigned int TextureCache::load2D(const std::string& path, const TextureSampler& sampler){
+	TextureRequest request = prepare2D(path, sampler);
+	return finish(request);
+}
+
+unsigned int TextureCache::loadCubemap(const std::vector<std::string>& faces, const TextureSampler& sampler){
+	TextureRequest request = prepareCubemap(faces, sampler);
+	return finish(request);
+}
+
+void TextureCache::release(unsigned int texture){
+	std::lock_guard<std::mutex> lock(mutex);
+	auto key = keyOf.find(texture);
+	if (key == keyOf.end()) return;
+
+	auto it = entries.find(key->second);
+	if (--it->second.refCount > 0) return;
+
+	glDeleteTextures(1, &texture);
+	entries.erase(it);
+	keyOf.erase(key);
+}
+
+TextureCache::Stats TextureCache::stats(){
+	std::lock_guard<std::mutex> lock(mutex);
+	return counters;
+}
+
+void TextureCache::printStats(){
+	Stats s = stats();
+	std::cout << "texture cache: " << s.hits << " hits, " << s.misses << " misses, "
+	          << s.bytesUploaded / 1024 << " KB uploaded, " << s.bytesSaved / 1024 << " KB saved" << std::endl;
+}
@@ -0,0 +1,57 @@
+#include <cstring>
+
+#include "header/UniformBlocks.h"
+
+static unsigned int g_block_uploads = 0;
+static unsigned int g_block_skipped = 0;
+
+UniformBuffer::~UniformBuffer(){
+	release();
+}
+
+void UniformBuffer::create(unsigned int binding, size_t bytes){
+	release();
+	bindingPoint = binding;
+	shadow.assign(bytes, 0);
+
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+	glBufferData(GL_UNIFORM_BUFFER, bytes, shadow.data(), GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, buffer);
+}
+
+void UniformBuffer::release(){
+	if (buffer != 0) glDeleteBuffers(1, &buffer);
+	buffer = 0;
+	shadow.clear();
+}
+
+bool UniformBuffer::update(const void* data, size_t bytes, size_t offset){
+	if (buffer == 0 || offset + bytes > shadow.size()) return false;
+
+	if (memcmp(&shadow[offset], data, bytes) == 0) {
+		g_block_skipped++;
+		return false;
+	}
+	memcpy(&shadow[offset], data, bytes);
+
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, offset, bytes, data);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	g_block_uploads++;
+	return true;
+}
+
+unsigned int UniformBuffer::uploads(){
+	return g_block_uploads;
+}
+
+unsigned int UniformBuffer::skipped(){
+	return g_block_skipped;
+}
+
+void UniformBuffer::resetStats(){
+	g_block_uploads = 0;
+	g_block_skipped = 0;
+}
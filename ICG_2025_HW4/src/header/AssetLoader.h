@@ -0,0 +1,76 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Background asset loading.
+//
+// A job is split in two: decode() runs on a worker thread (file IO, OBJ parsing, image decoding, no GL
+// calls allowed), upload() runs later on the GL thread from processUploads(). Uploads are drained in the
+// order decoding finished until the per-frame time budget is used up, so a large asset costs at most one
+// upload of stall per frame instead of blocking start-up.
+
+// Decoded pixels waiting for upload
+class ImageData
+{
+public:
+	int width = 0;
+	int height = 0;
+	int channels = 0;
+	unsigned char* pixels = nullptr;
+
+	ImageData() {}
+	~ImageData() { release(); }
+	ImageData(const ImageData&) = delete;
+	ImageData& operator=(const ImageData&) = delete;
+
+	// Thread safe: the flip flag is set per thread
+	bool load(const std::string& path, bool flipVertically);
+	void release();
+
+	size_t bytes() const { return (size_t)width * height * channels; }
+};
+
+class AssetLoader
+{
+public:
+	explicit AssetLoader(unsigned int threadCount = 0);
+	~AssetLoader();
+	AssetLoader(const AssetLoader&) = delete;
+	AssetLoader& operator=(const AssetLoader&) = delete;
+
+	void submit(std::function<void()> decode, std::function<void()> upload);
+
+	// GL thread: run finished uploads until budgetMs is spent (at least one if any is ready).
+	// Returns the number of uploads done.
+	int processUploads(double budgetMs);
+
+	// Nothing queued, decoding or waiting for upload
+	bool idle();
+
+	// Block until every submitted job is uploaded (loading screens, tests)
+	void finish();
+
+private:
+	struct Job
+	{
+		std::function<void()> decode;
+		std::function<void()> upload;
+	};
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable jobAvailable;
+	std::condition_variable jobDecoded;
+	std::deque<Job> pending;  // waiting for a worker
+	std::deque<Job> decoded;  // waiting for the GL thread
+	size_t decoding = 0;
+	bool stopping = false;
+
+	void workerLoop();
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Far to near order of many blended things (snowflakes) by view depth, rebuilt every frame.
+//
+// Depths are floats turned into 24 bit keys whose unsigned order is far to near (the top 24 bits
+// keep the order like RenderQueue's depthBits, 1 / 65536 of the depth is plenty for blending), then
+// LSD radix sorted 12 bits per pass, a pass where every key has the same digit is skipped. From
+// PARALLEL_MIN items on, each pass is split over the threads: per-thread histograms, offsets per
+// (digit, thread), stable scatter. The helper threads are started by the first parallel sort and
+// sleep between sorts, so a sort per frame does not create threads. They are not shared with
+// AssetLoader: every pass waits for all threads at a barrier, a worker busy decoding would stall it.
+//
+// The previous frame's order is the starting point. Particles barely move between frames, so it is
+// usually sorted already or a few shifts away: an insertion sort finishes it in O(n + shifts), and
+// gives up for the radix sort once the shifts pass INSERTION_BUDGET per item. Dense particles swap
+// places every frame; after a give up the next tries wait for 1, 2, 4 ... MAX_BACKOFF frames, the
+// sorts in between start from scratch and skip reading the depths in the old order.
+//
+// No GL here, bench/depth_sort_bench uses it without a context.
+class DepthSorter
+{
+public:
+	enum class Method { Presorted, Insertion, Radix };
+
+	static const size_t PARALLEL_MIN = 1 << 16;
+	static const size_t INSERTION_BUDGET = 4;
+	static const unsigned int MAX_BACKOFF = 64;
+
+	// 0 = one per core (at most 8)
+	explicit DepthSorter(unsigned int threadCount = 0);
+	~DepthSorter();
+	DepthSorter(const DepthSorter&) = delete;
+	DepthSorter& operator=(const DepthSorter&) = delete;
+
+	// depths[i]: view space depth of item i, larger is farther. Returns the item indices far to near,
+	// valid until the next call. A different count than last time starts from scratch.
+	const std::vector<uint32_t>& sort(const float* depths, size_t count);
+	const std::vector<uint32_t>& order() const { return indices; }
+
+	// How the last sort() got there
+	Method lastMethod() const { return method; }
+	static const char* methodName(Method method);
+
+	// Start the next sort() from scratch (the items were regenerated)
+	void forget() { indices.clear(); backoff = retryIn = 0; }
+
+private:
+	unsigned int threads;
+	std::vector<uint32_t> indices, keys;
+	std::vector<uint32_t> scratchIndices, scratchKeys;
+	std::vector<size_t> counts; // threads x digit values
+	Method method = Method::Radix;
+	unsigned int backoff = 0; // frames to wait after the next give up / 2
+	unsigned int retryIn = 0; // sorts left until the previous order is tried again
+
+	// Threads 1 .. threads - 1, thread 0 is the caller of sort()
+	std::vector<std::thread> helpers;
+	std::mutex poolMutex;
+	std::condition_variable wake;     // a new job or stopping
+	std::condition_variable finished; // busy dropped to 0
+	const std::function<void(unsigned int)>* job = nullptr;
+	unsigned int jobGeneration = 0;
+	unsigned int busy = 0; // helpers still running the current job
+	bool stopping = false;
+
+	bool insertionSort(size_t budget, size_t& shifted);
+	void radixSort();
+	// work(t) on every thread, t = 0 on the calling one; returns when all are done
+	void runOnAllThreads(const std::function<void(unsigned int)>& work);
+	void helperLoop(unsigned int t);
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glad/glad.h>
+#include "SnowSystem.h"
+
+class shader_program_t;
+
+// SnowSystem's simulation moved to the GPU (GL 3.3 transform feedback): the positions live in two
+// buffers, a vertex shader (shaders/snow_update.vert) reads one and writes the next step into the
+// other, and the draw reads whichever was written last. Size, rotation, fall speed and sway phase
+// are generated once on the GPU as well (shaders/snow_init.vert), respawns use a hash of the flake
+// index and a per-step seed, so the CPU never touches a flake.
+//
+// vertexArray() has the same attributes as the CPU snowflakes (0 position, 1 size, 2 rotation), so
+// both draw with snowflake.vert. instancedVertexArray() has them once per instance plus the star
+// mesh at 3, for snowflake_instanced.vert.
+class GpuSnowSystem
+{
+public:
+	// Outputs of the two programs, pass them to shader_program_t::set_feedback_varyings()
+	static const char* const INIT_VARYINGS[2];    // GL_SEPARATE_ATTRIBS: position, params
+	static const char* const UPDATE_VARYINGS[1];  // position
+
+	// The programs are not owned and may still be linking
+	GpuSnowSystem(shader_program_t* initProgram, shader_program_t* updateProgram,
+	              const SnowVolume& volume = SnowVolume());
+	~GpuSnowSystem();
+	GpuSnowSystem(const GpuSnowSystem&) = delete;
+	GpuSnowSystem& operator=(const GpuSnowSystem&) = delete;
+
+	// SnowSystem::writeStarMesh() vertices, used by the instanced vertex arrays of the next reset().
+	// Not owned.
+	void setStarMesh(GLuint buffer) { starMesh = buffer; }
+
+	// (Re)create the buffers for 'count' flakes and fill them. GL thread.
+	void reset(size_t count, uint32_t seed);
+	size_t size() const { return count; }
+
+	// One step: fall for 'dt' seconds at 'time', sway, respawn what left the volume
+	void update(float time, float dt);
+
+	// Current positions + size / rotation
+	GLuint vertexArray() const { return renderVAO[current]; }
+	// Same, one instance per flake; 0 without setStarMesh()
+	GLuint instancedVertexArray() const { return instancedVAO[current]; }
+
+private:
+	shader_program_t* initProgram;
+	shader_program_t* updateProgram;
+	SnowVolume volume;
+	size_t count = 0;
+	uint32_t seed = 0;
+	uint32_t step = 0;
+
+	GLuint positions[2] = {};
+	GLuint params = 0;             // vec4 size, rotation, fall speed, sway phase
+	GLuint updateVAO[2] = {};      // reads positions[i] + params
+	GLuint renderVAO[2] = {};      // reads positions[i] + size / rotation out of params
+	GLuint instancedVAO[2] = {};   // the same per instance + starMesh per vertex
+	GLuint starMesh = 0;
+	int current = 0;               // positions[current] holds the latest step
+
+	void release();
+	void bindFlakeAttributes(int buffer, GLuint divisor);
+	void runFeedback(GLuint vertexArray, const GLuint* buffers, int bufferCount);
+};
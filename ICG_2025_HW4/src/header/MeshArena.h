@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glad/glad.h>
+#include "MeshCache.h"
+
+// Where one mesh lives inside a MeshArena: the arguments of glDrawElementsBaseVertex
+struct MeshRange
+{
+	uint32_t firstIndex = 0;
+	uint32_t indexCount = 0;
+	int32_t baseVertex = 0;
+};
+
+// Shared vertex and index buffers, plus one VAO, for every mesh with the same VertexLayout. Meshes
+// are appended and never freed, so this is meant for static scene content. Draws from one arena
+// need no VAO or buffer change between them, and MultiDrawBatch can issue all of them at once.
+//
+// The VAO also has DRAW_ID_LOCATION bound to an instanced 0, 1, 2, ... buffer: with baseInstance = i
+// a draw reads i there, which is how the multi-draw shader finds its per-draw data.
+class MeshArena
+{
+public:
+	static const GLuint DRAW_ID_LOCATION = 3;
+
+	// GL thread only, like everything else here
+	explicit MeshArena(const VertexLayout& layout);
+	~MeshArena();
+	MeshArena(const MeshArena&) = delete;
+	MeshArena& operator=(const MeshArena&) = delete;
+
+	bool accepts(const VertexLayout& layout) const;
+
+	// Copy the mesh into the arena (growing it if needed). Indices stay relative to the mesh.
+	MeshRange add(const MeshData& mesh);
+
+	// Make sure draw ids 0 .. count-1 exist
+	void reserveDrawIds(uint32_t count);
+
+	GLuint vertexArray() const { return VAO; }
+	const VertexLayout& layout() const { return vertexLayout; }
+	size_t vertexBytes() const { return vertexUsed; }
+	size_t indexBytes() const { return indexUsed; }
+	size_t capacityBytes() const { return vertexCapacity + indexCapacity + drawIdCapacity * sizeof(uint32_t); }
+
+private:
+	VertexLayout vertexLayout;
+	GLuint VAO = 0;
+	GLuint VBO = 0;
+	GLuint EBO = 0;
+	GLuint drawIdBuffer = 0;
+	size_t vertexUsed = 0, vertexCapacity = 0;
+	size_t indexUsed = 0, indexCapacity = 0;
+	uint32_t drawIdCapacity = 0;
+
+	void grow(GLenum target, GLuint& buffer, size_t& capacity, size_t used, size_t needed);
+	void attachVertexBuffer();
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Binary mesh cache written next to the .obj on first load ("<file>.meshcache").
+//
+// file layout (little endian, offsets from the start of the file):
+//   MeshCacheHeader
+//   vertex blob  : vertexCount * layout.stride bytes, interleaved
+//   index blob   : indexCount * uint32
+//
+// The cache is rejected when the version differs or the source file changed. A matching size and
+// mtime is accepted directly; if only the mtime moved (e.g. after a checkout) the content hash decides,
+// and on a match the new mtime is written back so the next load skips the hash.
+
+const uint32_t MESH_CACHE_MAGIC = 0x4d474349; // "ICGM"
+const uint32_t MESH_CACHE_VERSION = 2; // 2: boundsRadius
+const int MAX_VERTEX_ATTRIBUTES = 4;
+
+struct VertexAttribute
+{
+	uint32_t location;   // shader attribute location
+	uint32_t components; // 1 ~ 4
+	uint32_t type;       // GL_FLOAT, GL_HALF_FLOAT, GL_SHORT, ...
+	uint32_t normalized;
+	uint32_t offset;     // byte offset inside one vertex
+};
+
+struct VertexLayout
+{
+	uint32_t stride;
+	uint32_t attributeCount;
+	VertexAttribute attributes[MAX_VERTEX_ATTRIBUTES];
+};
+
+struct MeshCacheHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t sourceSize;
+	int64_t sourceMtime;
+	uint64_t sourceHash;
+
+	VertexLayout layout;
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	float boundsMin[3];
+	float boundsMax[3];
+	float boundsRadius;
+
+	uint64_t vertexOffset;
+	uint64_t indexOffset;
+};
+
+// Read-only view of a whole file, memory mapped where the platform allows it
+class MappedFile
+{
+public:
+	MappedFile() {}
+	~MappedFile() { close(); }
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const std::string& path);
+	void close();
+	const unsigned char* data() const { return bytes; }
+	size_t size() const { return length; }
+
+private:
+	const unsigned char* bytes = nullptr;
+	size_t length = 0;
+	bool mapped = false;
+	std::vector<unsigned char> fallback; // used when mmap is not available
+};
+
+// Vertex / index data ready for glBufferData, either owned or pointing into a mapped cache file
+class MeshData
+{
+public:
+	VertexLayout layout = {};
+	uint32_t vertexCount = 0;
+	uint32_t indexCount = 0;
+	glm::vec3 boundsMin = glm::vec3(0.0f);
+	glm::vec3 boundsMax = glm::vec3(0.0f);
+	float boundsRadius = 0.0f; // sphere around the box center that holds every vertex
+
+	std::vector<unsigned char> vertices;
+	std::vector<unsigned int> indices;
+
+	const void* vertexData() const { return vertexPtr ? vertexPtr : vertices.data(); }
+	const unsigned int* indexData() const { return indexPtr ? indexPtr : indices.data(); }
+	size_t vertexBytes() const { return (size_t)vertexCount * layout.stride; }
+	size_t indexBytes() const { return (size_t)indexCount * sizeof(unsigned int); }
+	// Heap allocations plus the mapped cache file, 0 after release()
+	size_t cpuBytes() const { return vertices.capacity() + indices.capacity() * sizeof(unsigned int) + file.size(); }
+
+	// Drop the blobs (or the mapping) once they are on the GPU; layout, counts and bounds stay
+	void release();
+
+	bool readCache(const std::string& cachePath, const std::string& sourcePath);
+	bool writeCache(const std::string& cachePath, const std::string& sourcePath) const;
+
+private:
+	MappedFile file;
+	const void* vertexPtr = nullptr;
+	const unsigned int* indexPtr = nullptr;
+};
+
+uint64_t hashFileContents(const std::string& path);
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "Frustum.h"
+#include "MeshArena.h"
+#include "StreamBuffer.h"
+
+// Shader storage binding of the per-draw data, keep in sync with shaders/multidraw.vert
+const GLuint DRAW_DATA_BINDING = 0;
+
+// One entry of the per-draw SSBO, std430: 128 bytes
+struct DrawData
+{
+	glm::mat4 model;          // includes the mesh's position decode
+	glm::vec4 normalMatrix[3]; // mat3 columns, padded to 16 bytes each like std430 does
+	int32_t materialIndex;
+	int32_t pad[3];
+};
+
+static_assert(sizeof(DrawData) == 128, "DrawData must match the std430 layout");
+
+// GL's DrawElementsIndirectCommand
+struct DrawElementsIndirectCommand
+{
+	uint32_t count;
+	uint32_t instanceCount;
+	uint32_t firstIndex;
+	int32_t baseVertex;
+	uint32_t baseInstance; // = draw index, see MeshArena::DRAW_ID_LOCATION
+};
+
+// Many draws of meshes from one MeshArena sharing one program and texture, issued with a single
+// glMultiDrawElementsIndirect (GL 4.3). The per-draw data is static: it is uploaded once to a
+// shader storage buffer, and a frame only rewrites the command list, so culled draws are simply
+// left out of it.
+//
+// Usage:
+//     batch.add(object->meshRange(), model, material, sphere, box); // once, at scene build time
+//     batch.cull(frustum, stats);                                     // every frame, optional
+//     item.batch = &batch;                                            // RenderQueue calls draw()
+class MultiDrawBatch
+{
+public:
+	// The context is 4.3+ (glMultiDrawElementsIndirect and shader storage buffers)
+	static bool supported();
+
+	explicit MultiDrawBatch(MeshArena& arena) : arena(arena) {}
+	~MultiDrawBatch();
+	MultiDrawBatch(const MultiDrawBatch&) = delete;
+	MultiDrawBatch& operator=(const MultiDrawBatch&) = delete;
+
+	// 'model' is the object's model matrix, 'decode' its Object::positionDecode(). GL thread.
+	void add(const MeshRange& range, const glm::mat4& model, const glm::mat4& decode, int materialIndex,
+	         const BoundingSphere& sphere, const BoundingBox& box);
+	void clear();
+	size_t size() const { return drawData.size(); }
+
+	// Keep only the draws inside the frustum for the following draw() calls. Without cull() every
+	// draw is issued.
+	void cull(const Frustum& frustum, CullStats& stats);
+	size_t visibleCount() const { return commands.size(); }
+
+	// Upload what changed and issue the draws. The caller binds the program, the textures and
+	// arena.vertexArray() (RenderQueue does, for an item with 'batch' set).
+	void draw();
+
+	MeshArena& meshArena() const { return arena; }
+
+private:
+	MeshArena& arena;
+	std::vector<DrawData> drawData;
+	std::vector<DrawElementsIndirectCommand> allCommands; // one per add(), in draw order
+	std::vector<DrawElementsIndirectCommand> commands;    // what draw() issues
+	FrustumCuller culler;
+	std::vector<unsigned char> visible;
+
+	GLuint dataBuffer = 0;
+	StreamBuffer commandStream{GL_DRAW_INDIRECT_BUFFER};
+	bool dataDirty = false;
+};
@@ -1,10 +1,20 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <cstring>
+#include <cfloat>
+#include <unordered_map>
 #include <glm/glm.hpp>
 #include <glad/glad.h>
 #include <tiny_obj_loader.h>
 #include "stb_image.h"
+#include "MeshOptimizer.h"
+#include "MeshCache.h"
+#include "VertexFormat.h"
+#include "Frustum.h"
+#include "MeshArena.h"
+#include "AssetLoader.h"
+#include "TextureCache.h"
 
 using namespace std;
 
@@ -14,68 +24,182 @@ enum class FACETYPE
 	QUAD
 };
 
+// Full attribute tuple of one vertex, used to merge identical face corners
+struct VertexKey
+{
+	float data[8]; // position(3) + normal(3) + texcoord(2)
+
+	bool operator==(const VertexKey& other) const {
+		return memcmp(data, other.data, sizeof(data)) == 0;
+	}
+};
+
+struct VertexKeyHash
+{
+	size_t operator()(const VertexKey& key) const {
+		// FNV-1a over the raw float bits
+		uint32_t bits[8];
+		memcpy(bits, key.data, sizeof(bits));
+		uint64_t h = 14695981039346656037ull;
+		for (int i = 0; i < 8; i++) {
+			h ^= bits[i];
+			h *= 1099511628211ull;
+		}
+		return static_cast<size_t>(h);
+	}
+};
+
+// What an Object keeps in CPU memory once its buffers are on the GPU
+enum class Residency
+{
+	GPU_ONLY,     // every CPU copy is freed after upload()
+	KEEP_CPU_COPY // positions + indices stay (object space floats) for picking / physics
+};
+
+struct MeshMemory
+{
+	size_t cpuBytes; // attribute / index vectors, interleaved blob, mapped cache file
+	size_t gpuBytes; // vertex + index buffers
+};
+
 class Object
 {
 public:
 	vector<float> positions;
 	vector<float> normals;
 	vector<float> texcoords;
+	vector<unsigned int> indices;
 	FACETYPE faceType = FACETYPE::TRIANGLE;
 
 	void draw(){
+		if(!ready) return;
 		if(hasTexture){
 			glActiveTexture(GL_TEXTURE0);
 			glBindTexture(GL_TEXTURE_2D, textureID);
 		}
 		glBindVertexArray(VAO);
-		glDrawArrays(GL_TRIANGLES, 0, vertex_cnt);
+		glDrawElementsBaseVertex(GL_TRIANGLES, index_cnt, GL_UNSIGNED_INT,
+		                         (void*)(sizeof(unsigned int) * range.firstIndex), range.baseVertex);
 	}
 
-	Object(const string& filename)
+	~Object()
 	{
-		loadOBJ(filename);
-		set_VAO();
+		// no-op for textures that are not from the TextureCache (e.g. a placeholder)
+		if (textureID != 0) TextureCache::shared().release(textureID);
+		// arena meshes share the arena's VAO and buffers; 0 (never uploaded) is ignored by GL
+		if (arena == nullptr) {
+			glDeleteVertexArrays(1, &VAO);
+			glDeleteBuffers(1, &VBO);
+			glDeleteBuffers(1, &EBO);
+		}
 	}
 
-	void loadTexture(const string& filepath){
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		int width, height, nrChannels;
-        stbi_set_flip_vertically_on_load(true);
-		unsigned char *data = stbi_load(filepath.c_str(), &width, &height, &nrChannels, 0);
-		if (data) {
-			GLenum format = GL_RGB;
-			if (nrChannels == 1) format = GL_RED;
-			else if (nrChannels == 3) format = GL_RGB;
-			else if (nrChannels == 4) format = GL_RGBA;
-
-			glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-			glGenerateMipmap(GL_TEXTURE_2D);
-			hasTexture = true;
+	// Empty object, filled later with loadMesh() (any thread) + upload() (GL thread)
+	Object() {}
+
+	Object(const string& filename, VertexFormat format = VertexFormat::full(),
+	       Residency residency = Residency::GPU_ONLY)
+	{
+		loadMesh(filename, format, residency);
+		upload();
+	}
+
+	// CPU side of loading: mesh cache or OBJ parse + optimize. No GL calls, safe on a worker thread
+	void loadMesh(const string& filename, VertexFormat format = VertexFormat::full(),
+	              Residency residency = Residency::GPU_ONLY)
+	{
+		// one cache file per vertex format, full float keeps the plain name
+		string cachePath = filename + (format == VertexFormat::full() ? "" : "." + format.name()) + ".meshcache";
+		if (mesh.readCache(cachePath, filename) && layoutMatches(format)) {
+			cout << filename << ": loaded from " << cachePath << endl;
 		} else {
-			std::cerr << "Failed to load texture: " << filepath << std::endl;
+			mesh.release();
+			bool parsed = loadOBJ(filename);
+			optimizeMesh(filename);
+			buildMeshData(filename, format);
+			// an empty mesh would be served from the cache until the OBJ changes
+			if (parsed && mesh.vertexCount > 0) mesh.writeCache(cachePath, filename);
 		}
-		stbi_image_free(data);
+
+		// picking / physics copy, decoded from the upload layout so cache hits get the same data
+		if (residency == Residency::KEEP_CPU_COPY) {
+			unpackPositions(mesh.layout, mesh.vertexData(), mesh.vertexCount, mesh.boundsMin, mesh.boundsMax, positions);
+			indices.assign(mesh.indexData(), mesh.indexData() + mesh.indexCount);
+		}
+
+		size_t floatBytes = (size_t)mesh.vertexCount * VertexFormat::full().layout().stride;
+		cout << filename << ": " << mesh.layout.stride << " B/vertex, vertices " << mesh.vertexBytes() / 1024
+		     << " KB (" << floatBytes / 1024 << " KB as float32), indices " << mesh.indexBytes() / 1024 << " KB" << endl;
+	}
+
+	// GL side of loading, draw() does nothing until this ran. With an arena of the same vertex layout
+	// the mesh goes into its shared buffers instead of buffers of its own.
+	void upload(MeshArena* arena = nullptr)
+	{
+		if (arena && arena->accepts(mesh.layout)) {
+			set_arena(*arena);
+		} else {
+			set_VAO();
+		}
+		ready = true;
+	}
+
+	bool isReady() const { return ready; }
+
+	// For RenderQueue, which binds the VAO and texture itself (GL_UNSIGNED_INT indices)
+	unsigned int vertexArray() const { return VAO; }
+	int indexCount() const { return index_cnt; }
+	// Index range inside vertexArray(): firstIndex 0 / baseVertex 0 unless the mesh is in an arena
+	const MeshRange& meshRange() const { return range; }
+	bool inArena() const { return arena != nullptr; }
+	unsigned int texture() const { return hasTexture ? textureID : 0; }
+
+	MeshMemory memoryUsage() const {
+		size_t cpuBytes = (positions.capacity() + normals.capacity() + texcoords.capacity()) * sizeof(float) +
+		                  indices.capacity() * sizeof(unsigned int) + mesh.cpuBytes();
+		return {cpuBytes, gpuBytes};
+	}
+
+	// Object space bounds of the source positions (quantization does not change them), for culling
+	BoundingBox bounds() const { return {mesh.boundsMin, mesh.boundsMax}; }
+	BoundingSphere boundingSphere() const { return {(mesh.boundsMin + mesh.boundsMax) * 0.5f, mesh.boundsRadius}; }
+
+	// Multiply into the model matrix: maps quantized positions back to object space (identity for float)
+	glm::mat4 positionDecode() const { return positionDecodeMatrix(mesh.layout, mesh.boundsMin, mesh.boundsMax); }
+
+	void loadTexture(const string& filepath){
+		setTexture(TextureCache::shared().load2D(filepath));
+	}
+
+	// Takes over the caller's TextureCache reference and gives back the one of the old texture
+	void setTexture(unsigned int texture){
+		if (textureID != 0) TextureCache::shared().release(textureID);
+		textureID = texture;
+		hasTexture = texture != 0;
 	}
 
 private:
-	unsigned int VAO;
+	MeshData mesh;
+	MeshRange range;
+	MeshArena* arena = nullptr; // owns VAO and the buffers if set
+	unsigned int VAO = 0;
+	unsigned int VBO = 0;
+	unsigned int EBO = 0;
 	unsigned int textureID = 0;
 	bool hasTexture = false;
+	bool ready = false;
+	size_t gpuBytes = 0;
 	int vertex_cnt;
+	int index_cnt;
 
-	void loadOBJ(const string& filename) {
+	// false if the file is missing or tinyobj could not parse it
+	bool loadOBJ(const string& filename) {
 		vector<tinyobj::shape_t> shapes;
 		vector<tinyobj::material_t> materials;
 		string err;
 
-		bool ret = tinyobj::LoadObj(shapes, materials, err, filename.c_str());
+		// chunked multithreaded parse, same result as tinyobj::LoadObj
+		bool ret = tinyobj::LoadObjParallel(shapes, materials, err, filename.c_str());
 
 		if (!err.empty()) {
 			cerr << "Error loading OBJ: " << err << endl;
@@ -83,9 +207,18 @@ private:
 
 		if (!ret) {
 			cerr << "Failed to load OBJ file: " << filename << endl;
-			return;
+			return false;
 		}
 
+		// (position, normal, texcoord) -> index of the unique vertex
+		size_t cornerCount = 0;
+		for (const auto& shape : shapes) {
+			cornerCount += shape.mesh.indices.size();
+		}
+		unordered_map<VertexKey, unsigned int, VertexKeyHash> vertexCache;
+		vertexCache.reserve(cornerCount);
+		indices.reserve(cornerCount);
+
 		// Process all shapes
 		for (const auto& shape : shapes) {
 			const tinyobj::mesh_t& mesh = shape.mesh;
@@ -106,161 +239,189 @@ private:
 				if (fv == 3) {
 					// Triangle
 					for (size_t v = 0; v < 3; v++) {
-						unsigned int idx = mesh.indices[index_offset + v];
-						
-						// Positions
-						if (idx * 3 + 2 < mesh.positions.size()) {
-							positions.push_back(mesh.positions[idx * 3 + 0]);
-							positions.push_back(mesh.positions[idx * 3 + 1]);
-							positions.push_back(mesh.positions[idx * 3 + 2]);
-						} else {
-							positions.push_back(0.0f);
-							positions.push_back(0.0f);
-							positions.push_back(0.0f);
-						}
-
-						// Texture coordinates
-						if (!mesh.texcoords.empty() && idx * 2 + 1 < mesh.texcoords.size()) {
-							texcoords.push_back(mesh.texcoords[idx * 2 + 0]);
-							texcoords.push_back(mesh.texcoords[idx * 2 + 1]);
-						} else {
-							texcoords.push_back(0.0f);
-							texcoords.push_back(0.0f);
-						}
-
-						// Normals
-						if (!mesh.normals.empty() && idx * 3 + 2 < mesh.normals.size()) {
-							normals.push_back(mesh.normals[idx * 3 + 0]);
-							normals.push_back(mesh.normals[idx * 3 + 1]);
-							normals.push_back(mesh.normals[idx * 3 + 2]);
-						} else {
-							normals.push_back(0.0f);
-							normals.push_back(1.0f);
-							normals.push_back(0.0f);
-						}
+						addVertex(vertexCache, mesh, mesh.indices[index_offset + v]);
 					}
 				} else if (fv == 4) {
-					// Quad - convert to two triangles
-					vector<unsigned int> quad_indices;
-					for (size_t v = 0; v < 4; v++) {
-						quad_indices.push_back(mesh.indices[index_offset + v]);
-					}
-
-					// First triangle: 0, 1, 2
-					for (int i : {0, 1, 2}) {
-						unsigned int idx = quad_indices[i];
-						
-						// Positions
-						if (idx * 3 + 2 < mesh.positions.size()) {
-							positions.push_back(mesh.positions[idx * 3 + 0]);
-							positions.push_back(mesh.positions[idx * 3 + 1]);
-							positions.push_back(mesh.positions[idx * 3 + 2]);
-						} else {
-							positions.push_back(0.0f);
-							positions.push_back(0.0f);
-							positions.push_back(0.0f);
-						}
-
-						// Texture coordinates
-						if (!mesh.texcoords.empty() && idx * 2 + 1 < mesh.texcoords.size()) {
-							texcoords.push_back(mesh.texcoords[idx * 2 + 0]);
-							texcoords.push_back(mesh.texcoords[idx * 2 + 1]);
-						} else {
-							texcoords.push_back(0.0f);
-							texcoords.push_back(0.0f);
-						}
-
-						// Normals
-						if (!mesh.normals.empty() && idx * 3 + 2 < mesh.normals.size()) {
-							normals.push_back(mesh.normals[idx * 3 + 0]);
-							normals.push_back(mesh.normals[idx * 3 + 1]);
-							normals.push_back(mesh.normals[idx * 3 + 2]);
-						} else {
-							normals.push_back(0.0f);
-							normals.push_back(1.0f);
-							normals.push_back(0.0f);
-						}
-					}
-
-					// Second triangle: 0, 2, 3
-					for (int i : {0, 2, 3}) {
-						unsigned int idx = quad_indices[i];
-						
-						// Positions
-						if (idx * 3 + 2 < mesh.positions.size()) {
-							positions.push_back(mesh.positions[idx * 3 + 0]);
-							positions.push_back(mesh.positions[idx * 3 + 1]);
-							positions.push_back(mesh.positions[idx * 3 + 2]);
-						} else {
-							positions.push_back(0.0f);
-							positions.push_back(0.0f);
-							positions.push_back(0.0f);
-						}
-
-						// Texture coordinates
-						if (!mesh.texcoords.empty() && idx * 2 + 1 < mesh.texcoords.size()) {
-							texcoords.push_back(mesh.texcoords[idx * 2 + 0]);
-							texcoords.push_back(mesh.texcoords[idx * 2 + 1]);
-						} else {
-							texcoords.push_back(0.0f);
-							texcoords.push_back(0.0f);
-						}
-
-						// Normals
-						if (!mesh.normals.empty() && idx * 3 + 2 < mesh.normals.size()) {
-							normals.push_back(mesh.normals[idx * 3 + 0]);
-							normals.push_back(mesh.normals[idx * 3 + 1]);
-							normals.push_back(mesh.normals[idx * 3 + 2]);
-						} else {
-							normals.push_back(0.0f);
-							normals.push_back(1.0f);
-							normals.push_back(0.0f);
-						}
+					// Quad - convert to two triangles (0, 1, 2) and (0, 2, 3)
+					for (int i : {0, 1, 2, 0, 2, 3}) {
+						addVertex(vertexCache, mesh, mesh.indices[index_offset + i]);
 					}
 				}
 				
 				index_offset += fv;
 			}
 		}
+		return true;
 	}
 
-	void set_VAO(){
-		unsigned int VBO[3];
-		glGenVertexArrays(1, &VAO);
-		glBindVertexArray(VAO);
-		glGenBuffers(3, VBO);
+	// Emit one face corner, reusing an existing vertex when the same attributes were seen before
+	void addVertex(unordered_map<VertexKey, unsigned int, VertexKeyHash>& vertexCache,
+	               const tinyobj::mesh_t& mesh, unsigned int idx) {
+		VertexKey key;
 
 		// Positions
-		if (!positions.empty()) {
-			glBindBuffer(GL_ARRAY_BUFFER, VBO[0]);
-			glBufferData(GL_ARRAY_BUFFER, sizeof(GL_FLOAT) * positions.size(), positions.data(), GL_STATIC_DRAW);
-			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GL_FLOAT), (void*)0);
-			glEnableVertexAttribArray(0);
+		if (idx * 3 + 2 < mesh.positions.size()) {
+			key.data[0] = mesh.positions[idx * 3 + 0];
+			key.data[1] = mesh.positions[idx * 3 + 1];
+			key.data[2] = mesh.positions[idx * 3 + 2];
+		} else {
+			key.data[0] = 0.0f;
+			key.data[1] = 0.0f;
+			key.data[2] = 0.0f;
 		}
 
 		// Normals
-		if (!normals.empty()) {
-			glBindBuffer(GL_ARRAY_BUFFER, VBO[1]);
-			glBufferData(GL_ARRAY_BUFFER, sizeof(GL_FLOAT) * normals.size(), normals.data(), GL_STATIC_DRAW);
-			glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GL_FLOAT), (void*)0);
-			glEnableVertexAttribArray(1);
+		if (!mesh.normals.empty() && idx * 3 + 2 < mesh.normals.size()) {
+			key.data[3] = mesh.normals[idx * 3 + 0];
+			key.data[4] = mesh.normals[idx * 3 + 1];
+			key.data[5] = mesh.normals[idx * 3 + 2];
+		} else {
+			key.data[3] = 0.0f;
+			key.data[4] = 1.0f;
+			key.data[5] = 0.0f;
 		}
 
 		// Texture coordinates
-		if (!texcoords.empty()) {
-			glBindBuffer(GL_ARRAY_BUFFER, VBO[2]);
-			glBufferData(GL_ARRAY_BUFFER, sizeof(GL_FLOAT) * texcoords.size(), texcoords.data(), GL_STATIC_DRAW);
-			glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GL_FLOAT), (void*)0);
-			glEnableVertexAttribArray(2);
+		if (!mesh.texcoords.empty() && idx * 2 + 1 < mesh.texcoords.size()) {
+			key.data[6] = mesh.texcoords[idx * 2 + 0];
+			key.data[7] = mesh.texcoords[idx * 2 + 1];
+		} else {
+			key.data[6] = 0.0f;
+			key.data[7] = 0.0f;
+		}
+
+		unsigned int newIndex = static_cast<unsigned int>(positions.size() / 3);
+		auto inserted = vertexCache.emplace(key, newIndex);
+		if (!inserted.second) {
+			indices.push_back(inserted.first->second);
+			return;
 		}
 
+		positions.insert(positions.end(), key.data + 0, key.data + 3);
+		normals.insert(normals.end(), key.data + 3, key.data + 6);
+		texcoords.insert(texcoords.end(), key.data + 6, key.data + 8);
+		indices.push_back(newIndex);
+	}
+
+	// Reorder triangles for the post-transform cache and overdraw, then vertices for fetch locality
+	void optimizeMesh(const string& filename) {
+		size_t vertexCount = positions.size() / 3;
+		if (indices.empty() || vertexCount == 0) return;
+
+		VertexCacheStats before = analyzeVertexCache(indices, vertexCount);
+
+		vector<unsigned int> clusters;
+		optimizeVertexCache(indices, vertexCount, clusters);
+		optimizeOverdraw(indices, positions, clusters);
+
+		vector<unsigned int> remap;
+		size_t newVertexCount = optimizeVertexFetch(indices, vertexCount, remap);
+		remapVertexAttribute(positions, 3, remap, newVertexCount);
+		remapVertexAttribute(normals, 3, remap, newVertexCount);
+		remapVertexAttribute(texcoords, 2, remap, newVertexCount);
+
+		VertexCacheStats after = analyzeVertexCache(indices, newVertexCount);
+		cout << filename << ": " << newVertexCount << " vertices, " << indices.size() / 3 << " triangles, "
+		     << "ACMR " << before.acmr << " -> " << after.acmr << ", "
+		     << "ATVR " << before.atvr << " -> " << after.atvr << endl;
+	}
+
+	// A cached mesh is usable if it was written with the requested format (or its UNORM16 uv fallback)
+	bool layoutMatches(VertexFormat format) const {
+		VertexLayout wanted = format.layout();
+		if (memcmp(&mesh.layout, &wanted, sizeof(wanted)) == 0) return true;
+		if (format.texcoord != TexcoordFormat::UNORM16) return false;
+		format.texcoord = TexcoordFormat::HALF;
+		wanted = format.layout();
+		return memcmp(&mesh.layout, &wanted, sizeof(wanted)) == 0;
+	}
+
+	// Interleave position / normal / texcoord into the upload (and cache) layout
+	void buildMeshData(const string& filename, VertexFormat format) {
+		size_t vertexCount = positions.size() / 3;
+
+		glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+		for (size_t v = 0; v < vertexCount; v++) {
+			glm::vec3 p(positions[v * 3 + 0], positions[v * 3 + 1], positions[v * 3 + 2]);
+			boundsMin = glm::min(boundsMin, p);
+			boundsMax = glm::max(boundsMax, p);
+		}
+		mesh.boundsMin = vertexCount ? boundsMin : glm::vec3(0.0f);
+		mesh.boundsMax = vertexCount ? boundsMax : glm::vec3(0.0f);
+
+		// tighter than half the box diagonal for anything that is not box shaped
+		glm::vec3 center = (mesh.boundsMin + mesh.boundsMax) * 0.5f;
+		float radius2 = 0.0f;
+		for (size_t v = 0; v < vertexCount; v++) {
+			glm::vec3 d = glm::vec3(positions[v * 3 + 0], positions[v * 3 + 1], positions[v * 3 + 2]) - center;
+			radius2 = std::max(radius2, glm::dot(d, d));
+		}
+		mesh.boundsRadius = std::sqrt(radius2);
+
+		// normalized shorts cannot hold repeating uvs
+		if (format.texcoord == TexcoordFormat::UNORM16) {
+			for (float t : texcoords) {
+				if (t < 0.0f || t > 1.0f) {
+					cout << filename << ": texcoords outside [0, 1], storing them as half floats" << endl;
+					format.texcoord = TexcoordFormat::HALF;
+					break;
+				}
+			}
+		}
+
+		mesh.layout = format.layout();
+		mesh.vertexCount = static_cast<uint32_t>(vertexCount);
+		mesh.indexCount = static_cast<uint32_t>(indices.size());
+		packVertices(mesh.layout, positions, normals, texcoords, mesh.boundsMin, mesh.boundsMax, mesh.vertices);
+		mesh.indices = indices;
+
+		// Free the separate arrays (clear() would keep the capacity), the interleaved copy is what gets uploaded
+		vector<float>().swap(positions);
+		vector<float>().swap(texcoords);
+		vector<float>().swap(normals);
+		vector<unsigned int>().swap(indices);
+	}
+
+	void set_VAO(){
+		glGenVertexArrays(1, &VAO);
+		glBindVertexArray(VAO);
+		glGenBuffers(1, &VBO);
+		glGenBuffers(1, &EBO);
+
+		// Interleaved vertices, straight from the parsed mesh or from the mapped cache file
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferData(GL_ARRAY_BUFFER, mesh.vertexBytes(), mesh.vertexData(), GL_STATIC_DRAW);
+		for (uint32_t i = 0; i < mesh.layout.attributeCount; i++) {
+			const VertexAttribute& attr = mesh.layout.attributes[i];
+			glVertexAttribPointer(attr.location, attr.components, attr.type, attr.normalized ? GL_TRUE : GL_FALSE,
+			                      mesh.layout.stride, (void*)(uintptr_t)attr.offset);
+			glEnableVertexAttribArray(attr.location);
+		}
+
+		// Indices (the element buffer binding is stored in the VAO)
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBytes(), mesh.indexData(), GL_STATIC_DRAW);
+
 		glBindVertexArray(0);
 
-		vertex_cnt = positions.size() / 3;
-		
-		// Clear vectors to save memory after uploading to GPU
-		positions.clear();
-		texcoords.clear();
-		normals.clear();
+		vertex_cnt = mesh.vertexCount;
+		index_cnt = mesh.indexCount;
+		range.indexCount = mesh.indexCount;
+		gpuBytes = mesh.vertexBytes() + mesh.indexBytes();
+
+		// Unmap / free the CPU copy after uploading to GPU
+		mesh.release();
+	}
+
+	void set_arena(MeshArena& target){
+		arena = &target;
+		range = target.add(mesh);
+		VAO = target.vertexArray();
+
+		vertex_cnt = mesh.vertexCount;
+		index_cnt = mesh.indexCount;
+		gpuBytes = mesh.vertexBytes() + mesh.indexBytes();
+
+		mesh.release();
 	}
 };
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "Frustum.h"
+
+class MultiDrawBatch;
+
+// header/shader.h has no include guard, the .cpp includes it
+class shader_program_t;
+
+// Fixed-function state a draw depends on. Anything not listed here is left alone by the queue.
+struct RenderState
+{
+	bool blend = false;       // glBlendFunc is set once in setup() (SRC_ALPHA, ONE_MINUS_SRC_ALPHA)
+	bool depthWrite = true;
+	GLenum depthFunc = GL_LESS;
+};
+
+// Counters kept by GLStateCache since the last resetStats()
+struct GLStateStats
+{
+	unsigned int issued = 0;    // glUseProgram / glBindTexture / glBindVertexArray / glEnable ... calls made
+	unsigned int redundant = 0; // skipped, GL already had that value
+};
+
+// Shadow copy of the GL binding and enable state the render queue touches. Every setter compares
+// against the shadow and only calls GL when the value changes.
+//
+// Code outside the queue (asset uploads, shader reloads, TextureCache) binds things behind its back,
+// so the shadow is only trusted between invalidate() and the end of one RenderQueue::execute().
+class GLStateCache
+{
+public:
+	static const int MAX_TEXTURE_UNITS = 4;
+
+	void invalidate();
+
+	void useProgram(shader_program_t* program); // nullptr = glUseProgram(0)
+	void bindVertexArray(GLuint vertexArray);
+	void bindTexture(int unit, GLenum target, GLuint texture);
+	void activeTexture(int unit);
+	void apply(const RenderState& state);
+
+	const GLStateStats& stats() const { return counters; }
+	void resetStats() { counters = GLStateStats(); }
+
+private:
+	// ~0u = unknown, the next set always goes to GL
+	GLuint program = ~0u;
+	GLuint vertexArray = ~0u;
+	int activeUnit = -1;
+	GLuint textures[MAX_TEXTURE_UNITS][2] = {{~0u, ~0u}, {~0u, ~0u}, {~0u, ~0u}, {~0u, ~0u}}; // [unit][2D, cube]
+	GLuint blend = ~0u, depthWrite = ~0u;
+	GLenum depthFunc = ~0u;
+	GLStateStats counters;
+
+	bool changed(GLuint& cached, GLuint value);
+};
+
+// Draws are grouped into passes, executed in this order
+enum class RenderPass : unsigned int
+{
+	SOLID = 0,   // opaque, sorted by state, then front to back
+	SKY = 1,     // after every opaque draw, relies on depth = 1 with GL_LEQUAL
+	BLENDED = 2, // transparent, sorted back to front, then by state
+};
+
+struct TextureBinding
+{
+	GLenum target = GL_TEXTURE_2D;
+	GLuint texture = 0; // 0 = leave the unit as it is
+};
+
+// Everything one draw needs. Per-draw uniforms are limited to what the HW4 scene uses: the model
+// matrix (+ normal matrix), a material index and a couple of named floats.
+struct RenderItem
+{
+	RenderPass pass = RenderPass::SOLID;
+	shader_program_t* program = nullptr;
+	GLuint vertexArray = 0;
+	GLenum mode = GL_TRIANGLES;
+	GLsizei count = 0;
+	bool indexed = true; // GL_UNSIGNED_INT elements from the VAO's element buffer
+	GLuint firstIndex = 0; // where the mesh starts in a shared (MeshArena) vertex array, not indexed: first vertex
+	GLint baseVertex = 0;
+	GLsizei instanceCount = 0; // > 0: instanced draw of 'count' vertices / indices
+	GLuint baseInstance = 0;   // first instance of a non-indexed instanced draw, needs GL 4.2
+	MultiDrawBatch* batch = nullptr; // set: batch->draw() instead of one draw call, count is ignored
+	TextureBinding textures[GLStateCache::MAX_TEXTURE_UNITS];
+	RenderState state;
+	float depth = 0.0f; // view space distance, orders draws inside a pass
+
+	bool hasBounds = false; // world space, execute() skips the draw when both miss the frustum
+	BoundingSphere sphere;
+	BoundingBox box;
+
+	bool hasModel = false;
+	glm::mat4 model = glm::mat4(1.0f);
+	glm::mat3 normalMatrix = glm::mat3(1.0f);
+	int materialIndex = -1; // < 0 = not set
+
+	struct FloatUniform
+	{
+		const char* name; // must outlive the frame (string literals)
+		float value;
+	};
+	FloatUniform floats[2] = {};
+	int floatCount = 0;
+
+	// Called right before / after the draw call, e.g. for GL_TIME_ELAPSED queries
+	void (*before)() = nullptr;
+	void (*after)() = nullptr;
+
+	void setFloat(const char* name, float value) { floats[floatCount++] = {name, value}; }
+};
+
+struct RenderQueueStats
+{
+	unsigned int draws = 0;            // items drawn, a MultiDrawBatch counts once
+	unsigned int batchedDraws = 0;     // meshes drawn by the MultiDrawBatch items
+	unsigned int changesSubmitted = 0; // state changes the draws would need in submission order
+	unsigned int changesSorted = 0;    // ... and after sorting by key
+	CullStats cull;                    // items with bounds; culled ones are not in 'draws'
+};
+
+// (key, item index) pairs sorted by key; the sort is stable
+struct SortEntry
+{
+	uint64_t key;
+	uint32_t index;
+};
+
+// LSD radix sort, 8 bits per pass. Passes where every key has the same byte are skipped, so a
+// queue that only differs in a few fields costs a few passes. 'scratch' is resized as needed.
+void radixSortKeys(std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch);
+
+// Per-frame list of draws. render() submits in whatever order is convenient, execute() sorts them by
+//
+//   solid / sky:  pass(2) | program(10) | unit 0 texture(12) | vertex array(12) | depth(24) | 0(4)
+//   blended:      pass(2) | far-to-near depth(24) | program(10) | unit 0 texture(12) | vertex array(12) | 0(4)
+//
+// and issues them through a GLStateCache, so consecutive draws sharing a program, texture or VAO
+// do not rebind it.
+class RenderQueue
+{
+public:
+	void clear() { items.clear(); }
+	void submit(const RenderItem& item) { items.push_back(item); }
+	size_t size() const { return items.size(); }
+
+	// Drop items whose bounds are outside 'frustum' (if given), sort and draw the rest, then put the
+	// default RenderState back with program 0 / VAO 0 bound (glClear needs depth writes on).
+	// The queue is empty afterwards.
+	void execute(GLStateCache& state, const Frustum* frustum = nullptr);
+
+	// Of the last execute()
+	const RenderQueueStats& stats() const { return lastStats; }
+
+private:
+	std::vector<RenderItem> items;
+	std::vector<SortEntry> order, scratch;
+	FrustumCuller culler;
+	std::vector<uint32_t> bounded; // item index of each culler entry
+	std::vector<unsigned char> inside, visible; // per culler entry / per item
+	RenderQueueStats lastStats;
+
+	static uint64_t sortKey(const RenderItem& item);
+	unsigned int countStateChanges(const std::vector<SortEntry>& sequence) const;
+	void draw(const RenderItem& item, GLStateCache& state) const;
+};
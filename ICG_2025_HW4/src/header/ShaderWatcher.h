@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+class shader_program_t;
+
+// Watches the source files (includes too) of registered programs. Linux uses inotify on the
+// containing directories, so editors that save through a temp file + rename are caught as well;
+// elsewhere the modification times are polled a few times per second.
+//
+// poll() only reports which programs are stale; reloading them (shader_program_t::reload) and
+// re-binding their uniform blocks stays with the caller, on the GL thread.
+class ShaderWatcher
+{
+public:
+	ShaderWatcher();
+	~ShaderWatcher();
+	ShaderWatcher(const ShaderWatcher&) = delete;
+	ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+	void watch(shader_program_t* program);
+	void unwatch(shader_program_t* program);
+
+	// Programs with a file written since the last call, each listed once. Never blocks.
+	std::vector<shader_program_t*> poll();
+
+private:
+	// path as the program spells it -> programs built from it
+	std::map<std::string, std::vector<shader_program_t*>> users;
+
+#if defined(__linux__)
+	int inotifyFd = -1;
+	std::map<int, std::string> watchedDirs;     // watch descriptor -> "dir/"
+#else
+	std::map<std::string, long long> modifiedTimes;
+	std::chrono::steady_clock::time_point lastScan;
+#endif
+
+	void addFile(const std::string& path, shader_program_t* program);
+	void markChanged(const std::string& path, std::vector<shader_program_t*>& changed);
+};
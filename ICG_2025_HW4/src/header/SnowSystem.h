@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Area the flakes fall through, in world units
+struct SnowVolume
+{
+	float areaSize = 1200.0f;  // x and z in [-areaSize / 2, areaSize / 2]
+	float heightMin = -200.0f; // a flake below this respawns at heightMax
+	float heightMax = 600.0f;
+};
+
+// Snowflake particles stored as structure of arrays so the update runs 4 (SSE2) or 8 (AVX2) flakes
+// per instruction. Each flake carries its own xorshift32 state, so every kernel produces the same
+// flakes no matter how many lanes it processes at once, and sin() is replaced by a polynomial
+// (fastSin) that all kernels share.
+//
+// update() writes the new positions straight into 'out', tightly packed xyz per flake: pass the
+// mapped vertex buffer. Size and rotation never change after reset(); writeStaticAttributes() fills
+// them once into a second buffer.
+//
+// No GL here, bench/snow_update_bench uses it without a context.
+class SnowSystem
+{
+public:
+	enum class Kernel { Scalar, SSE2, AVX2 };
+
+	// Sideways speed at the peak of the sway (units/s) and how fast it swings (rad/s)
+	static constexpr float SWAY_AMPLITUDE = 15.0f;
+	static constexpr float SWAY_FREQUENCY = 2.0f;
+
+	// Widest kernel the CPU (and the build) supports, checked once
+	static Kernel bestKernel();
+	static bool kernelSupported(Kernel kernel);
+	static const char* kernelName(Kernel kernel);
+
+	// sin() as a degree 7 polynomial, |error| < 1e-6 for |x| < 100. What update() uses for the sway.
+	static float fastSin(float x);
+
+	explicit SnowSystem(const SnowVolume& volume = SnowVolume()) : volume(volume) {}
+
+	void reset(size_t count, uint32_t seed);
+	size_t size() const { return xs.size(); }
+	const SnowVolume& bounds() const { return volume; }
+
+	// Fall for 'dt' seconds at 'time', sway, respawn what left the volume, then store
+	// 3 * size() floats to 'out'. 'out' is only written, never read.
+	void update(float time, float dt, float* out) { update(time, dt, out, bestKernel()); }
+	void update(float time, float dt, float* out, Kernel kernel);
+
+	// size, rotation per flake: 2 * size() floats
+	void writeStaticAttributes(float* out) const;
+	// x, y, z, size, rotation of flake order[0], order[1] ...: 5 * size() floats, the layout of a
+	// draw in a different order every frame (back to front sorted snow)
+	void writeOrdered(const uint32_t* order, float* out) const;
+
+	// The star snowflake.geom builds around every flake, as STAR_VERTICES xy pairs (GL_TRIANGLES) for a
+	// flake of size 1: the mesh shaders/snowflake_instanced.vert scales, rotates and instances
+	static const int STAR_VERTICES = 36;
+	static void writeStarMesh(float* out);
+
+	// Current positions, for the bench's comparison of the kernels
+	const float* x() const { return xs.data(); }
+	const float* y() const { return ys.data(); }
+	const float* z() const { return zs.data(); }
+
+private:
+	SnowVolume volume;
+	std::vector<float> xs, ys, zs;
+	std::vector<float> fallSpeeds, swayPhases;
+	std::vector<float> sizes, rotations;
+	std::vector<uint32_t> seeds;
+
+	void updateScalar(size_t begin, size_t end, float swayTime, float swayAmount, float fall, float* out);
+	size_t updateSSE2(float swayTime, float swayAmount, float fall, float* out);
+	size_t updateAVX2(float swayTime, float swayAmount, float fall, float* out);
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <glad/glad.h>
+
+// Per-frame data (vertices, draw commands...) written by the CPU while the GPU may still read what
+// the previous frames wrote. The buffer is split into REGIONS regions used round-robin, one per
+// map() / unmap():
+//
+//  - GL 4.4 / ARB_buffer_storage: immutable storage mapped once with GL_MAP_PERSISTENT_BIT |
+//    GL_MAP_COHERENT_BIT. map() fences the region written before and waits for the fence of the
+//    region it hands out (written REGIONS maps ago), which normally has long signaled.
+//  - otherwise: glMapBufferRange(GL_MAP_UNSYNCHRONIZED_BIT) on the region, and the whole buffer is
+//    orphaned (glBufferData(nullptr)) each time the ring wraps around, so the driver swaps in
+//    fresh memory instead of waiting for the GPU.
+//
+// Usage:
+//     stream.reserve(count * stride);          // once, creates buffer()
+//     void* data = stream.map(bytes);          // every frame
+//     ...write 'bytes' bytes, never read them back...
+//     size_t offset = stream.unmap();          // then draw from buffer() at 'offset': the
+//                                              // glVertexAttribPointer offset, the indirect offset...
+class StreamBuffer
+{
+public:
+	static const int REGIONS = 3;
+
+	static bool persistentSupported();
+
+	explicit StreamBuffer(GLenum target) : target(target) {}
+	~StreamBuffer();
+	StreamBuffer(const StreamBuffer&) = delete;
+	StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+	// Make every region at least 'regionBytes' bytes. Growing creates a new buffer() (immutable
+	// storage cannot be resized), so point VAOs at it again and only call this between frames.
+	void reserve(size_t regionBytes);
+
+	// Next region, bound to the target. Write-only, valid until unmap(). nullptr if 'bytes' is more
+	// than regionSize() or the map failed, then skip unmap().
+	void* map(size_t bytes);
+	// Byte offset of what map() returned inside buffer()
+	size_t unmap();
+
+	GLuint buffer() const { return name; }
+	size_t regionSize() const { return regionBytes; }
+	bool persistent() const { return mapped != nullptr; }
+
+	// map() calls that had to wait for the GPU to finish reading a region
+	unsigned int stalls() const { return stallCount; }
+
+private:
+	GLenum target;
+	GLuint name = 0;
+	size_t regionBytes = 0;
+	int region = REGIONS - 1; // the last one handed out
+	bool written = false;     // the current region was mapped since its fence
+
+	unsigned char* mapped = nullptr; // persistent mapping of the whole buffer
+	GLsync fences[REGIONS] = {};
+	unsigned int stallCount = 0;
+
+	void release();
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+
+#include "AssetLoader.h"
+
+// Textures keyed by file content + sampler state, so the same image loaded from two paths (or twice)
+// is decoded and uploaded once. Handles are reference counted: every load returns a reference that
+// is given back with release(); the GL texture is deleted when the last reference goes.
+//
+// Loading is split like AssetLoader jobs: prepare*() hashes and decodes (any thread, skips decoding
+// when the texture is already resident), finish() creates or shares the GL texture (GL thread).
+
+struct TextureSampler
+{
+	GLenum target = GL_TEXTURE_2D;
+	GLint wrapS = GL_REPEAT;
+	GLint wrapT = GL_REPEAT;
+	GLint wrapR = GL_REPEAT;
+	GLint minFilter = GL_LINEAR_MIPMAP_LINEAR;
+	GLint magFilter = GL_LINEAR;
+	bool flipVertically = true;
+
+	bool usesMipmaps() const { return minFilter != GL_NEAREST && minFilter != GL_LINEAR; }
+
+	static TextureSampler texture2D() { return TextureSampler(); }
+	static TextureSampler cubemap();
+};
+
+struct TextureKey
+{
+	uint64_t contentHash = 0; // hash of every source file, in face order
+	TextureSampler sampler;
+
+	bool operator==(const TextureKey& other) const;
+};
+
+struct TextureKeyHash
+{
+	size_t operator()(const TextureKey& key) const;
+};
+
+// Everything finish() needs, filled by prepare2D() / prepareCubemap()
+struct TextureRequest
+{
+	TextureKey key;
+	std::vector<std::string> paths;
+	std::vector<std::unique_ptr<ImageData>> images; // empty when the texture was already cached
+};
+
+class TextureCache
+{
+public:
+	struct Stats
+	{
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t bytesUploaded = 0; // estimated GPU bytes, mip chain included
+		uint64_t bytesSaved = 0;    // bytes hits did not have to upload again
+	};
+
+	// One cache for the whole program (Object::loadTexture uses it)
+	static TextureCache& shared();
+
+	TextureRequest prepare2D(const std::string& path, const TextureSampler& sampler = TextureSampler::texture2D());
+	TextureRequest prepareCubemap(const std::vector<std::string>& faces,
+	                              const TextureSampler& sampler = TextureSampler::cubemap());
+	// GL thread. Returns a new reference, or 0 if the image could not be loaded
+	unsigned int finish(TextureRequest& request);
+
+	// Synchronous prepare + finish
+	unsigned int load2D(const std::string& path, const TextureSampler& sampler = TextureSampler::texture2D());
+	unsigned int loadCubemap(const std::vector<std::string>& faces,
+	                         const TextureSampler& sampler = TextureSampler::cubemap());
+
+	// Drop one reference. Handles the cache does not own are ignored
+	void release(unsigned int texture);
+
+	Stats stats();
+	void printStats();
+
+private:
+	struct Entry
+	{
+		unsigned int texture;
+		int refCount;
+		uint64_t bytes;
+	};
+
+	std::mutex mutex;
+	std::unordered_map<TextureKey, Entry, TextureKeyHash> entries;
+	std::unordered_map<unsigned int, TextureKey> keyOf; // texture handle -> key
+	Stats counters;
+
+	bool contains(const TextureKey& key);
+	TextureRequest prepare(const std::vector<std::string>& paths, const TextureSampler& sampler);
+	unsigned int upload(const TextureRequest& request, uint64_t& bytes);
+};
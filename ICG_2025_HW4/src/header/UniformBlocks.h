@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// std140 uniform blocks shared by every HW4 program. Each block lives in one buffer bound at a fixed
+// binding point; render() fills Camera and Lights once per frame, Materials only when a material
+// changes. A draw then only sets "model" and "materialIndex".
+//
+// The GLSL side declares the same blocks (see the top of any .vert / .frag in shaders/):
+//
+//   layout (std140) uniform Camera { mat4 view; mat4 projection; vec3 viewPos; float time; };
+//   layout (std140) uniform Lights { light_t light; };
+//   layout (std140) uniform Materials { material_t materials[MAX_MATERIALS]; };
+//
+// GLSL 3.30 has no layout(binding = N), so shader_program_t::bind_uniform_block() assigns the
+// binding points after linking.
+
+enum UniformBlockBinding : unsigned int
+{
+	CAMERA_BLOCK_BINDING = 0,
+	LIGHT_BLOCK_BINDING = 1,
+	MATERIAL_BLOCK_BINDING = 2,
+};
+
+// Keep in sync with MAX_MATERIALS in the shaders
+const int MAX_MATERIALS = 16;
+
+// 144 bytes. viewPos and time share one 16 byte slot
+struct CameraBlock
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec3 viewPos;
+	float time;
+};
+
+// 64 bytes, every vec3 padded to 16
+struct LightBlock
+{
+	glm::vec3 position; float pad0;
+	glm::vec3 ambient;  float pad1;
+	glm::vec3 diffuse;  float pad2;
+	glm::vec3 specular; float pad3;
+};
+
+// 48 bytes, gloss fills the padding after specular
+struct MaterialBlock
+{
+	glm::vec3 ambient;  float pad0;
+	glm::vec3 diffuse;  float pad1;
+	glm::vec3 specular;
+	float gloss;
+};
+
+static_assert(sizeof(CameraBlock) == 144, "CameraBlock must match the std140 layout");
+static_assert(sizeof(LightBlock) == 64, "LightBlock must match the std140 layout");
+static_assert(sizeof(MaterialBlock) == 48, "MaterialBlock must match the std140 layout");
+
+// One GL uniform buffer bound to a fixed binding point. Keeps a CPU copy so updates that do not
+// change anything are dropped.
+class UniformBuffer
+{
+public:
+	UniformBuffer() = default;
+	UniformBuffer(const UniformBuffer&) = delete;
+	UniformBuffer& operator=(const UniformBuffer&) = delete;
+	~UniformBuffer();
+
+	void create(unsigned int binding, size_t bytes);
+	void release();
+
+	// Copy 'bytes' at 'offset' into the buffer if they differ from what it already holds
+	bool update(const void* data, size_t bytes, size_t offset = 0);
+	// Whole-block update for the *Block structs above
+	template <typename T> bool updateBlock(const T& block) { return update(&block, sizeof(T)); }
+
+	unsigned int id() const { return buffer; }
+	unsigned int binding() const { return bindingPoint; }
+
+	// glBufferSubData calls issued / skipped over all buffers since the last reset
+	static unsigned int uploads();
+	static unsigned int skipped();
+	static void resetStats();
+
+private:
+	unsigned int buffer = 0;
+	unsigned int bindingPoint = 0;
+	std::vector<unsigned char> shadow;
+};
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include "MeshCache.h"
+
+// Per-mesh choice of how position / normal / texcoord are stored in the interleaved vertex buffer.
+//
+//   position  FLOAT32  12 B   UNORM16  8 B (3 x 16 bit + pad, relative to the mesh AABB)
+//   normal    FLOAT32  12 B   INT_2_10_10_10  4 B (GL_INT_2_10_10_10_REV, normalized)
+//   texcoord  FLOAT32   8 B   HALF  4 B   UNORM16  4 B (only if every uv is inside [0, 1])
+//
+// The vertex shaders are unchanged: UNORM16 positions arrive in [0, 1] and are mapped back by
+// positionDecodeMatrix(), which the caller multiplies into the model matrix. It uses one uniform
+// scale for all axes, so shaders that transform normals with the model matrix stay correct.
+
+enum class PositionFormat { FLOAT32, UNORM16 };
+enum class NormalFormat { FLOAT32, INT_2_10_10_10 };
+enum class TexcoordFormat { FLOAT32, HALF, UNORM16 };
+
+struct VertexFormat
+{
+	PositionFormat position = PositionFormat::FLOAT32;
+	NormalFormat normal = NormalFormat::FLOAT32;
+	TexcoordFormat texcoord = TexcoordFormat::FLOAT32;
+
+	// 32 bytes per vertex
+	static VertexFormat full() { return VertexFormat(); }
+
+	// 20 bytes per vertex
+	static VertexFormat compact() {
+		VertexFormat format;
+		format.normal = NormalFormat::INT_2_10_10_10;
+		format.texcoord = TexcoordFormat::HALF;
+		return format;
+	}
+
+	// 16 bytes per vertex
+	static VertexFormat quantized() {
+		VertexFormat format = compact();
+		format.position = PositionFormat::UNORM16;
+		return format;
+	}
+
+	bool operator==(const VertexFormat& other) const {
+		return position == other.position && normal == other.normal && texcoord == other.texcoord;
+	}
+
+	// Short tag used in log output and mesh cache file names, e.g. "p32n32t32", "p16n10t16"
+	std::string name() const {
+		std::string s = position == PositionFormat::FLOAT32 ? "p32" : "p16";
+		s += normal == NormalFormat::FLOAT32 ? "n32" : "n10";
+		s += texcoord == TexcoordFormat::FLOAT32 ? "t32" : (texcoord == TexcoordFormat::HALF ? "t16" : "tu16");
+		return s;
+	}
+
+	VertexLayout layout() const {
+		VertexLayout layout = {};
+		uint32_t offset = 0;
+
+		if (position == PositionFormat::FLOAT32) {
+			layout.attributes[0] = {0, 3, GL_FLOAT, GL_FALSE, offset};
+			offset += 3 * sizeof(float);
+		} else {
+			layout.attributes[0] = {0, 3, GL_UNSIGNED_SHORT, GL_TRUE, offset};
+			offset += 4 * sizeof(uint16_t); // padded to keep the next attribute 4 byte aligned
+		}
+
+		if (normal == NormalFormat::FLOAT32) {
+			layout.attributes[1] = {1, 3, GL_FLOAT, GL_FALSE, offset};
+			offset += 3 * sizeof(float);
+		} else {
+			layout.attributes[1] = {1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offset};
+			offset += sizeof(uint32_t);
+		}
+
+		if (texcoord == TexcoordFormat::FLOAT32) {
+			layout.attributes[2] = {2, 2, GL_FLOAT, GL_FALSE, offset};
+			offset += 2 * sizeof(float);
+		} else if (texcoord == TexcoordFormat::HALF) {
+			layout.attributes[2] = {2, 2, GL_HALF_FLOAT, GL_FALSE, offset};
+			offset += 2 * sizeof(uint16_t);
+		} else {
+			layout.attributes[2] = {2, 2, GL_UNSIGNED_SHORT, GL_TRUE, offset};
+			offset += 2 * sizeof(uint16_t);
+		}
+
+		layout.attributeCount = 3;
+		layout.stride = offset;
+		return layout;
+	}
+};
+
+// Maps UNORM16 positions (in [0, 1]) back to object space; identity for float positions
+inline glm::mat4 positionDecodeMatrix(const VertexLayout& layout, const glm::vec3& boundsMin,
+                                      const glm::vec3& boundsMax)
+{
+	if (layout.attributeCount == 0 || layout.attributes[0].type == GL_FLOAT) return glm::mat4(1.0f);
+
+	glm::vec3 extent = boundsMax - boundsMin;
+	float scale = glm::max(glm::max(extent.x, extent.y), glm::max(extent.z, 1e-20f));
+	return glm::scale(glm::translate(glm::mat4(1.0f), boundsMin), glm::vec3(scale));
+}
+
+// Encode de-indexed attribute arrays (3 / 3 / 2 floats per vertex) into 'out' using 'layout'.
+// Bounds must already cover every position.
+inline void packVertices(const VertexLayout& layout, const std::vector<float>& positions,
+                         const std::vector<float>& normals, const std::vector<float>& texcoords,
+                         const glm::vec3& boundsMin, const glm::vec3& boundsMax,
+                         std::vector<unsigned char>& out)
+{
+	size_t vertexCount = positions.size() / 3;
+	out.assign(vertexCount * layout.stride, 0);
+
+	glm::mat4 decode = positionDecodeMatrix(layout, boundsMin, boundsMax);
+	float invScale = decode[0][0] > 0.0f ? 1.0f / decode[0][0] : 0.0f;
+
+	const VertexAttribute& pos = layout.attributes[0];
+	const VertexAttribute& nrm = layout.attributes[1];
+	const VertexAttribute& uv = layout.attributes[2];
+
+	for (size_t v = 0; v < vertexCount; v++) {
+		unsigned char* vertex = out.data() + v * layout.stride;
+
+		glm::vec3 p(positions[v * 3 + 0], positions[v * 3 + 1], positions[v * 3 + 2]);
+		if (pos.type == GL_FLOAT) {
+			memcpy(vertex + pos.offset, &p, sizeof(p));
+		} else {
+			glm::vec3 q = (p - boundsMin) * invScale;
+			uint16_t packed[3] = {glm::packUnorm1x16(q.x), glm::packUnorm1x16(q.y), glm::packUnorm1x16(q.z)};
+			memcpy(vertex + pos.offset, packed, sizeof(packed));
+		}
+
+		glm::vec3 n(normals[v * 3 + 0], normals[v * 3 + 1], normals[v * 3 + 2]);
+		if (nrm.type == GL_FLOAT) {
+			memcpy(vertex + nrm.offset, &n, sizeof(n));
+		} else {
+			float length = glm::length(n);
+			if (length > 0.0f) n /= length;
+			uint32_t packed = glm::packSnorm3x10_1x2(glm::vec4(n, 0.0f));
+			memcpy(vertex + nrm.offset, &packed, sizeof(packed));
+		}
+
+		glm::vec2 t(texcoords[v * 2 + 0], texcoords[v * 2 + 1]);
+		if (uv.type == GL_FLOAT) {
+			memcpy(vertex + uv.offset, &t, sizeof(t));
+		} else if (uv.type == GL_HALF_FLOAT) {
+			uint16_t packed[2] = {glm::packHalf1x16(t.x), glm::packHalf1x16(t.y)};
+			memcpy(vertex + uv.offset, packed, sizeof(packed));
+		} else {
+			uint16_t packed[2] = {glm::packUnorm1x16(t.x), glm::packUnorm1x16(t.y)};
+			memcpy(vertex + uv.offset, packed, sizeof(packed));
+		}
+	}
+}
+
+// Inverse of the position part of packVertices: 3 floats per vertex, object space
+inline void unpackPositions(const VertexLayout& layout, const void* vertices, uint32_t vertexCount,
+                            const glm::vec3& boundsMin, const glm::vec3& boundsMax, std::vector<float>& out)
+{
+	out.resize((size_t)vertexCount * 3);
+	const VertexAttribute& pos = layout.attributes[0];
+	glm::mat4 decode = positionDecodeMatrix(layout, boundsMin, boundsMax);
+
+	for (uint32_t v = 0; v < vertexCount; v++) {
+		const unsigned char* vertex = (const unsigned char*)vertices + (size_t)v * layout.stride;
+		glm::vec3 p;
+		if (pos.type == GL_FLOAT) {
+			memcpy(&p, vertex + pos.offset, sizeof(p));
+		} else {
+			uint16_t packed[3];
+			memcpy(packed, vertex + pos.offset, sizeof(packed));
+			glm::vec3 q(glm::unpackUnorm1x16(packed[0]), glm::unpackUnorm1x16(packed[1]), glm::unpackUnorm1x16(packed[2]));
+			p = glm::vec3(decode * glm::vec4(q, 1.0f));
+		}
+		memcpy(&out[(size_t)v * 3], &p, sizeof(p));
+	}
+}
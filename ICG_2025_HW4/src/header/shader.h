@@ -1,11 +1,56 @@
 #include <bits/stdc++.h>
 
+// Pre-resolved uniform of one program, from shader_program_t::uniform()
+struct uniform_handle_t{
+    int location = -1;
+    int slot = -1;      // index into the program's value cache, -1 = uniform is not active
+};
+
+// Counters over all programs since the last reset_uniform_stats()
+struct uniform_stats_t{
+    unsigned int uploads = 0;       // glUniform* calls issued
+    unsigned int redundant = 0;     // skipped, the program already had that value
+    unsigned int lookups = 0;       // glGetUniformLocation calls avoided by the name table
+};
+
+// Build timings over all programs since startup, see shader_program_t::build_stats()
+struct program_build_stats_t{
+    unsigned int programs = 0;
+    unsigned int from_cache = 0;    // restored with glProgramBinary, nothing compiled
+    double compile_ms = 0.0;
+    double link_ms = 0.0;
+    double load_ms = 0.0;           // reading + glProgramBinary for cached programs
+    double wait_ms = 0.0;           // blocked on GL_LINK_STATUS in finish_link()
+};
+
 class shader_program_t{
 public:
     shader_program_t();
     ~shader_program_t();
+    // Reads the file and expands #include "file" (relative to it). Defines added before the call
+    // are inserted after the #version line.
     void add_shader(std::string& filepath, unsigned int type);
-    void link_shader();
+    // Feature flag for the following add_shader() calls: "NAME" or "NAME VALUE"
+    void add_define(const std::string& define);
+    // Vertex shader outputs captured by transform feedback (GL_INTERLEAVED_ATTRIBS or
+    // GL_SEPARATE_ATTRIBS). They are part of the link, so call this before link_shader().
+    void set_feedback_varyings(const std::vector<std::string>& names, unsigned int buffer_mode);
+    void link_shader();             // submit_link() + finish_link()
+    // Queue compile + link without waiting for the driver. The result is only checked on first
+    // use: use(), bind_uniform_block(), uniform lookups, or an explicit finish_link().
+    void submit_link();
+    // Polls GL_COMPLETION_STATUS_KHR, never blocks while the driver is still busy. Without
+    // KHR/ARB_parallel_shader_compile there is no way to ask, so this finishes the link instead.
+    bool is_ready();
+    // Waits for the link result (cheap once done); false if it failed
+    bool finish_link();
+
+    // Every file the program was built from, #includes too (for ShaderWatcher)
+    std::vector<std::string> source_files() const;
+    // Re-read and rebuild from the same files and defines. The new program replaces this one only
+    // if it links; otherwise the log is printed and the old program stays. Uniform block bindings
+    // and uniform values have to be set again after a successful reload.
+    bool reload();
     void create();
     void use();
     void release();
@@ -15,8 +60,100 @@ public:
     void set_uniform_value(const char* name, const float value);
     void set_uniform_value(const char* name, const int value);
     unsigned int get_program_id() const { return program_handle; }
-    
+
+    // Attach a std140 block to a binding point; returns false if the program has no such block or
+    // failed to link
+    bool bind_uniform_block(const char* name, unsigned int binding);
+
+    // Hot uniforms: resolve once after link_shader(), then set without any name lookup
+    uniform_handle_t uniform(const char* name);
+    void set_uniform_value(const uniform_handle_t& u, const glm::mat4& mat);
+    void set_uniform_value(const uniform_handle_t& u, const glm::mat3& mat);
+    void set_uniform_value(const uniform_handle_t& u, const glm::vec3& vec);
+    void set_uniform_value(const uniform_handle_t& u, const float value);
+    void set_uniform_value(const uniform_handle_t& u, const int value);
+
+    static uniform_stats_t uniform_stats();
+    static void reset_uniform_stats();
+
+    // Linked programs are stored in 'dir' with glGetProgramBinary, keyed on a hash of the stage
+    // sources and the driver strings, and restored on the next launch. Empty = no cache (default).
+    static void set_binary_cache_dir(const std::string& dir);
+    static program_build_stats_t build_stats();
+
+    // Let the driver compile on its own threads (glMaxShaderCompilerThreadsKHR), once after gladLoadGL
+    static void enable_parallel_compile();
+
 private:
+    struct shader_stage_t{
+        unsigned int type;
+        std::string path;
+        std::string source;             // after #include / #define expansion
+        std::vector<std::string> files; // index = #line source string number
+    };
+
     unsigned int program_handle;
     std::vector<unsigned int> shader_handles;
-};
\ No newline at end of file
+    std::vector<shader_stage_t> stages;     // add_shader() only reads, link_shader() compiles
+    std::string defines;                    // "#define ...\n" lines from add_define()
+    std::vector<std::string> feedback_varyings;
+    unsigned int feedback_mode = 0;
+
+    static bool expand_source(const std::string& path, const std::string& defines,
+                              std::vector<std::string>& files, std::ostream& out);
+
+    bool link_pending = false;              // submitted, GL_LINK_STATUS not read yet
+    bool linked_from_binary = false;
+    bool link_ok = false;
+    double pending_compile_ms = 0.0;
+    double pending_link_ms = 0.0;
+    double pending_load_ms = 0.0;
+
+    std::string label() const;
+    void submit_compile();
+    void report_compile_errors() const;
+    uint64_t binary_key() const;
+    std::string binary_path() const;
+    bool submit_binary();
+    void save_binary();
+
+    // Active uniforms, filled from glGetActiveUniform after linking. Open addressing on the
+    // FNV-1a hash of the name, so lookups by const char* never allocate.
+    struct uniform_entry_t{
+        std::string name;
+        uint32_t hash;
+        int location;
+        int slot;
+    };
+    std::vector<uniform_entry_t> uniform_table;     // power of two, empty name = free
+    std::vector<unsigned char> uniform_values;      // last uploaded value, 64 bytes per slot
+    std::vector<unsigned char> uniform_valid;       // slot has a known value
+
+    void reflect_uniforms();
+    const uniform_entry_t* find_uniform(const char* name) const;
+    bool uniform_changed(const uniform_handle_t& u, const void* data, size_t bytes);
+};
+
+// One program per permutation (stage files + defines). A permutation is submitted for linking the
+// first time it is requested and returned right away, possibly still linking (is_ready()). Asking
+// for it again returns the same program. Owns its programs.
+class shader_variant_cache_t{
+public:
+    struct stage_t{
+        std::string path;
+        unsigned int type;
+    };
+
+    ~shader_variant_cache_t();
+
+    // Called once for every new program, right after submit_link()
+    void set_on_submit(std::function<void(shader_program_t*)> callback) { on_submit = callback; }
+
+    shader_program_t* get(const std::vector<stage_t>& stages, std::vector<std::string> defines);
+    void clear();
+    size_t size() const { return programs.size(); }
+
+private:
+    std::map<std::string, shader_program_t*> programs;
+    std::function<void(shader_program_t*)> on_submit;
+};
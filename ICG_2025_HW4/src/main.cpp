@@ -7,7 +7,19 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "header/cube.h"
+#include "header/AssetLoader.h"
+#include "header/DepthSort.h"
+#include "header/GpuSnowSystem.h"
+#include "header/MeshArena.h"
+#include "header/MultiDraw.h"
 #include "header/Object.h"
+#include "header/RenderQueue.h"
+#include "header/ShaderWatcher.h"
+#include "header/SnowSystem.h"
+#include "header/StreamBuffer.h"
+#include "header/TextureCache.h"
+#include "header/Transform.h"
+#include "header/UniformBlocks.h"
 #include "header/shader.h"
 #include "header/stb_image.h"
 
@@ -70,6 +82,32 @@ int shaderProgramIndex = 0;
 std::vector<shader_program_t*> shaderPrograms;
 shader_program_t* cubemapShader;
 
+// 2~7: shaders/lit.vert + lit.frag, 每個shading method是一個#define permutation, 第一次選到才compile
+shader_variant_cache_t litShaders;
+const std::vector<std::string> litShadingMethods = {
+    "SHADING_UNLIT", "SHADING_BLINN_PHONG", "SHADING_GOURAUD", "SHADING_METALLIC", "SHADING_GLASS_SCHLICK", "SHADING_TOON"
+};
+
+// Camera / Lights / Materials uniform blocks, 所有program共用 (binding point 見 UniformBlocks.h)
+UniformBuffer cameraBlock, lightBlock, materialBlock;
+std::vector<MaterialBlock> materials;
+const int SCENE_MATERIAL = 0;
+const int FROG_MATERIAL = 1;
+
+// sampler固定的texture unit, link之後設一次
+const int OBJECT_TEXTURE_UNIT = 0;
+const int SKYBOX_TEXTURE_UNIT = 1;
+
+// U 印出上一幀的uniform上傳統計
+uniform_stats_t lastFrameUniformStats;
+unsigned int lastFrameBlockUploads = 0, lastFrameBlockSkipped = 0;
+
+// render()只把draw排進queue, 最後一次排序 (pass, program, texture, VAO, depth) 再畫, 重複的bind/enable由glState略過
+RenderQueue renderQueue;
+GLStateCache glState;
+RenderQueueStats lastFrameQueueStats;
+GLStateStats lastFrameStateStats;
+
 // 如果要個別obj用自己個shader，在這邊加 然後去 shader_setup_w_geo...那邊新增
 shader_program_t* portalShader = nullptr;
 shader_program_t* meteorShader = nullptr;
@@ -82,9 +120,27 @@ camera_t camera;
 Object* cubeModel = nullptr;
 bool isCube = false;
 
+// 背景載入: OBJ / PNG 在 worker thread 解析, GL 上傳在主執行緒每幀最多花 ASSET_UPLOAD_BUDGET_MS
+AssetLoader* assetLoader = nullptr;
+const double ASSET_UPLOAD_BUDGET_MS = 4.0;
+unsigned int placeholderTexture = 0; // 1x1 白色, 貼圖還沒好之前先用這個
+
 // marada init
 Object* maradaModel = nullptr;
 glm::mat4 maradaMatrix(1.0f);
+std::string maradaObjPath;
+std::string maradaTexturePath;
+
+// V 切換marada的vertex格式, T 量marada draw call的GPU時間 (比較不同格式)
+const VertexFormat MARADA_FORMATS[] = {VertexFormat::quantized(), VertexFormat::compact(), VertexFormat::full()};
+int maradaFormatIndex = 0;
+int maradaGeneration = 0; // +1 每次V換掉maradaModel, 晚到的貼圖callback靠這個認出舊的物件
+bool profileMarada = false;
+unsigned int maradaTimerQueries[2] = {0, 0};
+int maradaTimerFrame = 0;
+double maradaGpuMs = 0.0;
+double maradaCpuMs = 0.0;
+int maradaTimerSamples = 0;
 
 // portal init
 Object* portalModel = nullptr;
@@ -124,27 +180,209 @@ glm::mat4 frogMatrix(1.0f);
 bool showFrog = false;          
 glm::vec3 frogPosition = glm::vec3(0.0f, METEOR_GROUND_Y - 500, 0.0f); // 青蛙位置
 
+// G: 地上撒一堆石頭跟青蛙 (static field), 共用staticArena的buffer
+// GL 4.3: 每種texture一個MultiDrawBatch, 一次glMultiDrawElementsIndirect畫完; 3.3 (或按B) 就每個一個draw call
+struct StaticInstance {
+    Object* model;
+    glm::mat4 matrix;
+    int materialIndex;
+};
+MeshArena* staticArena = nullptr; // VertexFormat::quantized(): meteor, frog
+MultiDrawBatch* rockBatch = nullptr;
+MultiDrawBatch* frogBatch = nullptr;
+std::vector<StaticInstance> staticField;
+bool showStaticField = false;
+bool useMultiDraw = true;
+const int STATIC_FIELD_COUNT = 4000;
+const float STATIC_FIELD_SIZE = 5000.0f;
+CullStats lastFrameFieldCull, fieldCull;
+
 float currentTime = 0.0f;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
-// Snowflake particle system
-struct Snowflake {
-    glm::vec3 position;
-    float size;
-    float rotation;
-    float fallSpeed;
-    float swayPhase;   // for horizontal swaying
-};
-
-std::vector<Snowflake> snowflakes;
-unsigned int snowflakeVAO, snowflakeVBO;
+// Snowflake particle system (SoA + SIMD update, see header/SnowSystem.h)
+SnowSystem snowSystem;  // default SnowVolume: 1200 x 1200 area, height -200 .. 600
+unsigned int snowflakeVAO, snowflakeStaticVBO;  // size + rotation, uploaded once
+StreamBuffer* snowflakePositions = nullptr;      // rewritten every frame (whole flakes when sorted)
 shader_program_t* snowflakeShader = nullptr;
 bool snowflakeEnabled = false;
 const int SNOWFLAKE_COUNT = 2000;
-const float SNOW_AREA_SIZE = 1200.0f;  // snowflake distribution area
-const float SNOW_HEIGHT_MAX = 600.0f;  // maximum snowflake height
-const float SNOW_HEIGHT_MIN = -200.0f; // minimum snowflake height
+
+// H: the same snow simulated on the GPU (transform feedback), J: how many flakes (either simulation)
+GpuSnowSystem* gpuSnow = nullptr;
+shader_program_t* snowInitShader = nullptr;
+shader_program_t* snowUpdateShader = nullptr;
+bool snowOnGpu = false;
+const int SNOWFLAKE_COUNTS[] = {SNOWFLAKE_COUNT, 100000, 1000000};
+int snowCountIndex = 0;
+
+// Z: CPU snow drawn back to front. The flakes are sorted by view depth every frame (DepthSorter) and
+// written to the ring in that order, x y z size rotation each; renderSnowflakes() cuts the draw
+// where other blended draws (the portal) lie between them. The GPU simulation draws unsorted.
+DepthSorter snowSorter;
+bool snowSorted = true;
+std::vector<float> snowScratch;  // where SnowSystem::update puts the positions when sorted
+std::vector<float> snowDepths;   // per flake (not sorted), this frame's camera
+double snowSortMs = 0.0;
+
+// K: draw the flakes as instances of a static star mesh instead of expanding every point in
+// snowflake.geom, L: GPU time of the snow draw (compare the two across the J counts)
+unsigned int snowflakeInstancedVAO, snowflakeStarVBO;
+shader_program_t* snowflakeInstancedShader = nullptr;
+bool snowInstanced = false;
+bool profileSnow = false;
+unsigned int snowTimerQueries[2] = {0, 0};
+int snowTimerFrame = 0;
+double snowGpuMs = 0.0;
+double snowCpuMs = 0.0;
+double snowSortSumMs = 0.0;
+int snowTimerSamples = 0;
+
+// Parse on a worker, create the VAO (or append to the arena) on the GL thread
+void loadModelAsync(Object* model, const std::string& objPath, VertexFormat format = VertexFormat::full(),
+                    MeshArena* arena = nullptr){
+    assetLoader->submit([model, objPath, format]() { model->loadMesh(objPath, format); },
+                        [model, arena]() { model->upload(arena); });
+}
+
+// Hash + decode on a worker, get the texture from the TextureCache on the GL thread and hand it to onReady
+void loadTextureAsync(const std::string& path, std::function<void(unsigned int)> onReady){
+    std::shared_ptr<TextureRequest> request = std::make_shared<TextureRequest>();
+    assetLoader->submit(
+        [request, path]() { *request = TextureCache::shared().prepare2D(path); },
+        [request, onReady]() {
+            unsigned int texture = TextureCache::shared().finish(*request);
+            if (texture != 0) onReady(texture);
+        });
+}
+
+// explode.geom (shaderPrograms[1]) 跟 meteor.geom 沿法向量把三角形推出去 (隕石最遠10000), 原本的bounds包不住
+bool displacesGeometry(shader_program_t* shader){
+    return shader == meteorShader || (shaderPrograms.size() > 1 && shader == shaderPrograms[1]);
+}
+
+// model matrix, material跟貼圖填進一個RenderItem (還沒submit), 還沒上傳完的模型先畫一個cube代替
+// texture = 0 用模型自己的貼圖
+RenderItem modelItem(Object* model, shader_program_t* shader, const glm::mat4& modelMatrix, const glm::mat4& view,
+                     int materialIndex = SCENE_MATERIAL, unsigned int texture = 0){
+    if (texture == 0) texture = model->texture();
+    if (!model->isReady()) {
+        texture = placeholderTexture;
+        model = cubeModel;
+    }
+    // quantized positions need the decode transform in front of the vertices
+    glm::mat4 matrix = modelMatrix * model->positionDecode();
+
+    RenderItem item;
+    item.program = shader;
+    item.vertexArray = model->vertexArray();
+    item.count = model->indexCount();
+    item.firstIndex = model->meshRange().firstIndex;
+    item.baseVertex = model->meshRange().baseVertex;
+    item.textures[OBJECT_TEXTURE_UNIT] = {GL_TEXTURE_2D, texture};
+    item.textures[SKYBOX_TEXTURE_UNIT] = {GL_TEXTURE_CUBE_MAP, cubemapTexture}; // cubemap texture for reflection
+    item.hasModel = true;
+    item.model = matrix;
+    item.normalMatrix = normalMatrix(matrix);
+    item.materialIndex = materialIndex;
+    // bounds是原始座標, 不用乘decode; 碎片會飛出bounds的就不cull
+    item.hasBounds = !displacesGeometry(shader);
+    item.sphere = transformSphere(model->boundingSphere(), modelMatrix);
+    item.box = transformBox(model->bounds(), modelMatrix);
+    // bounding sphere中心在view space的深度 (quantized的matrix[3]是AABB的min角, 不是原點)
+    item.depth = -(view * glm::vec4(item.sphere.center, 1.0f)).z;
+    return item;
+}
+
+// CPU / GPU bytes of every mesh, printed once loading is done
+void printMeshMemory(){
+    std::pair<const char*, Object*> models[] = {
+        {"cube", cubeModel}, {"marada", maradaModel}, {"portal", portalModel},
+        {"meteor", meteorModel}, {"frog", frogModel}
+    };
+    for (const auto& model : models) {
+        MeshMemory memory = model.second->memoryUsage();
+        std::cout << "mesh " << model.first << ": CPU " << memory.cpuBytes / 1024 << " KB, GPU "
+                  << memory.gpuBytes / 1024 << " KB" << std::endl;
+    }
+}
+
+// Rebuild marada with the next vertex format (mesh cache per format, texture comes from the TextureCache)
+void switchMaradaFormat(){
+    if (!maradaModel->isReady()) return; // still being loaded by a worker
+
+    maradaFormatIndex = (maradaFormatIndex + 1) % 3;
+    Object* model = new Object(maradaObjPath, MARADA_FORMATS[maradaFormatIndex]);
+    model->loadTexture(maradaTexturePath);
+    delete maradaModel;
+    maradaModel = model;
+    maradaGeneration++;
+
+    maradaGpuMs = maradaCpuMs = 0.0;
+    maradaTimerSamples = 0;
+}
+
+// GL_TIME_ELAPSED around the marada draw; the result of the previous frame is read so nothing stalls
+void beginMaradaTimer(){
+    if (!profileMarada) return;
+    if (maradaTimerQueries[0] == 0) glGenQueries(2, maradaTimerQueries);
+    glBeginQuery(GL_TIME_ELAPSED, maradaTimerQueries[maradaTimerFrame % 2]);
+}
+
+void endMaradaTimer(){
+    if (!profileMarada) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    maradaTimerFrame++;
+    if (maradaTimerFrame < 2) return;
+
+    GLuint64 elapsed = 0;
+    glGetQueryObjectui64v(maradaTimerQueries[maradaTimerFrame % 2], GL_QUERY_RESULT, &elapsed);
+    maradaGpuMs += elapsed / 1e6;
+    maradaCpuMs += deltaTime * 1000.0;
+    if (++maradaTimerSamples == 120) {
+        std::cout << "marada " << MARADA_FORMATS[maradaFormatIndex].name() << ": GPU " << maradaGpuMs / 120
+                  << " ms/draw, frame " << maradaCpuMs / 120 << " ms" << std::endl;
+        maradaGpuMs = maradaCpuMs = 0.0;
+        maradaTimerSamples = 0;
+    }
+}
+
+// Same as the marada timer, around the snow draw
+void beginSnowTimer(){
+    if (!profileSnow) return;
+    if (snowTimerQueries[0] == 0) glGenQueries(2, snowTimerQueries);
+    glBeginQuery(GL_TIME_ELAPSED, snowTimerQueries[snowTimerFrame % 2]);
+}
+
+void endSnowTimer(){
+    if (!profileSnow) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    snowTimerFrame++;
+    if (snowTimerFrame < 2) return;
+
+    GLuint64 elapsed = 0;
+    glGetQueryObjectui64v(snowTimerQueries[snowTimerFrame % 2], GL_QUERY_RESULT, &elapsed);
+    snowGpuMs += elapsed / 1e6;
+    snowCpuMs += deltaTime * 1000.0;
+    snowSortSumMs += snowSortMs;
+    if (++snowTimerSamples == 120) {
+        std::cout << "snow " << (snowInstanced ? "instanced" : "geometry shader") << ", "
+                  << (snowOnGpu ? gpuSnow->size() : snowSystem.size()) << " flakes: GPU " << snowGpuMs / 120
+                  << " ms/draw, frame " << snowCpuMs / 120 << " ms";
+        if (snowSorted && !snowOnGpu)
+            std::cout << ", sort " << snowSortSumMs / 120 << " ms (last " << DepthSorter::methodName(snowSorter.lastMethod()) << ")";
+        std::cout << std::endl;
+        snowGpuMs = snowCpuMs = snowSortSumMs = 0.0;
+        snowTimerSamples = 0;
+    }
+}
+
+void resetSnowTimer(){
+    snowTimerFrame = 0;
+    snowGpuMs = snowCpuMs = snowSortSumMs = 0.0;
+    snowTimerSamples = 0;
+}
 
 void model_setup(){
 #if defined(__linux__) || defined(__APPLE__)
@@ -196,54 +434,58 @@ void model_setup(){
     std::string frog_texture_path = "..\\..\\src\\asset\\texture\\frog.png";
 
 #endif
+    // cube is tiny and doubles as the placeholder, so it is loaded right away
     cubeModel = new Object(cube_obj_path);
 
+    unsigned char white[4] = {255, 255, 255, 255};
+    glGenTextures(1, &placeholderTexture);
+    glBindTexture(GL_TEXTURE_2D, placeholderTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+
+    assetLoader = new AssetLoader();
+    staticArena = new MeshArena(VertexFormat::quantized().layout());
+
     // 已更改變數名稱, 需要加obj這邊都要改, 全域變數新增請參照上面~75行處
 
     // load marada
-    maradaModel = new Object(madara_obj_path);
-    maradaModel->loadTexture(madara_texture_path);
+    maradaObjPath = madara_obj_path;
+    maradaTexturePath = madara_texture_path;
+    maradaModel = new Object();
+    maradaModel->setTexture(placeholderTexture);
+    loadModelAsync(maradaModel, madara_obj_path, MARADA_FORMATS[maradaFormatIndex]);
+    // V可能在貼圖載完前就換了模型 (新的自己載過貼圖), 那這份reference就還給cache
+    int generation = maradaGeneration;
+    loadTextureAsync(madara_texture_path, [generation](unsigned int texture) {
+        if (generation == maradaGeneration) maradaModel->setTexture(texture);
+        else TextureCache::shared().release(texture);
+    });
 
     maradaMatrix = glm::mat4(1.0f);
     maradaMatrix = glm::translate(maradaMatrix, glm::vec3(0.0f, -50.0f, 0.0f));
     maradaMatrix = glm::scale(maradaMatrix, glm::vec3(50.0f));
 
     // load portal
-    portalModel = new Object(portal_obj_path);
-    portalModel->loadTexture(portal_texture_path);
+    portalModel = new Object();
+    portalModel->setTexture(placeholderTexture);
+    loadModelAsync(portalModel, portal_obj_path);
+    loadTextureAsync(portal_texture_path, [](unsigned int texture) { portalModel->setTexture(texture); });
 
     portalMatrix = glm::mat4(1.0f);
 
     // load meteor
-    meteorModel = new Object(meteor_obj_path);
-    meteorModel->loadTexture(meteor_base_color_path); 
+    meteorModel = new Object();
+    meteorModel->setTexture(placeholderTexture);
+    loadModelAsync(meteorModel, meteor_obj_path, VertexFormat::quantized(), staticArena);
+    loadTextureAsync(meteor_base_color_path, [](unsigned int texture) { meteorModel->setTexture(texture); });
 
     // load frog
-    frogModel = new Object(frog_obj_path);
-    
-    glGenTextures(1, &frogTexture);
-    glBindTexture(GL_TEXTURE_2D, frogTexture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char *data = stbi_load(frog_texture_path.c_str(), &width, &height, &nrChannels, 0);
-    if (data) {
-        GLenum format = GL_RGB;
-        if (nrChannels == 1) format = GL_RED;
-        else if (nrChannels == 3) format = GL_RGB;
-        else if (nrChannels == 4) format = GL_RGBA;
-        
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    } else {
-        std::cerr << "Failed to load frog texture: " << frog_texture_path << std::endl;
-    }
-    stbi_image_free(data);
-    
+    frogModel = new Object();
+    loadModelAsync(frogModel, frog_obj_path, VertexFormat::quantized(), staticArena);
+
+    frogTexture = placeholderTexture;
+    loadTextureAsync(frog_texture_path, [](unsigned int texture) { frogTexture = texture; });
 }
 
 void camera_setup(){
@@ -312,50 +554,178 @@ void material_setup(){
     material.gloss = 50.0;
 }
 
-float randomFloat(float min, float max) {
-    return min + static_cast<float>(rand()) / (static_cast<float>(RAND_MAX / (max - min)));
+MaterialBlock toMaterialBlock(const material_t& m){
+    MaterialBlock block = {};
+    block.ambient = m.ambient;
+    block.diffuse = m.diffuse;
+    block.specular = m.specular;
+    block.gloss = m.gloss;
+    return block;
 }
 
-void snowflake_setup() {
-    srand(static_cast<unsigned int>(std::time(nullptr)));
-    
-    // Initialize snowflake particles
-    snowflakes.resize(SNOWFLAKE_COUNT);
-    for (int i = 0; i < SNOWFLAKE_COUNT; i++) {
-        snowflakes[i].position = glm::vec3(
-            randomFloat(-SNOW_AREA_SIZE / 2, SNOW_AREA_SIZE / 2),
-            randomFloat(SNOW_HEIGHT_MIN, SNOW_HEIGHT_MAX),
-            randomFloat(-SNOW_AREA_SIZE / 2, SNOW_AREA_SIZE / 2)
-        );
-        snowflakes[i].size = randomFloat(2.0f, 6.0f);
-        snowflakes[i].rotation = randomFloat(0.0f, 6.28318f);
-        snowflakes[i].fallSpeed = randomFloat(20.0f, 60.0f);
-        snowflakes[i].swayPhase = randomFloat(0.0f, 6.28318f);
+// 建立三個uniform block的buffer, material表只在這裡上傳一次
+void uniform_block_setup(){
+    cameraBlock.create(CAMERA_BLOCK_BINDING, sizeof(CameraBlock));
+    lightBlock.create(LIGHT_BLOCK_BINDING, sizeof(LightBlock));
+    materialBlock.create(MATERIAL_BLOCK_BINDING, sizeof(MaterialBlock) * MAX_MATERIALS);
+
+    material_t frogMaterial;
+    frogMaterial.ambient = glm::vec3(1.0f);
+    frogMaterial.diffuse = glm::vec3(1.0f); // 白色，不影響貼圖顏色
+    frogMaterial.specular = glm::vec3(0.3f);
+    frogMaterial.gloss = 20.0f;
+
+    materials.resize(2);
+    materials[SCENE_MATERIAL] = toMaterialBlock(material);
+    materials[FROG_MATERIAL] = toMaterialBlock(frogMaterial);
+    materialBlock.update(materials.data(), materials.size() * sizeof(MaterialBlock));
+}
+
+// 每幀一次: camera跟光源 (沒變的話UniformBuffer不會重傳)
+void updateFrameBlocks(const glm::mat4& view, const glm::mat4& projection){
+    CameraBlock cameraData;
+    cameraData.view = view;
+    cameraData.projection = projection;
+    cameraData.viewPos = camera.position;
+    cameraData.time = currentTime;
+    cameraBlock.updateBlock(cameraData);
+
+    LightBlock lightData = {};
+    lightData.position = light.position;
+    lightData.ambient = light.ambient;
+    lightData.diffuse = light.diffuse;
+    lightData.specular = light.specular;
+    lightBlock.updateBlock(lightData);
+}
+
+// link完之後: 接上uniform block, sampler設成固定的texture unit (program沒有的名字會直接略過)
+void bindSceneBlocks(shader_program_t* shader){
+    shader->bind_uniform_block("Camera", CAMERA_BLOCK_BINDING);
+    shader->bind_uniform_block("Lights", LIGHT_BLOCK_BINDING);
+    shader->bind_uniform_block("Materials", MATERIAL_BLOCK_BINDING);
+
+    shader->use();
+    shader->set_uniform_value("objectTexture", OBJECT_TEXTURE_UNIT);
+    shader->set_uniform_value("ourTexture", OBJECT_TEXTURE_UNIT);
+    shader->set_uniform_value("frogTexture", OBJECT_TEXTURE_UNIT);
+    shader->set_uniform_value("skybox", SKYBOX_TEXTURE_UNIT);
+    shader->release();
+}
+
+// program先全部submit (driver可以同時compile), 每幀pollPrograms()問哪些link好了, 好了才接uniform block
+std::vector<shader_program_t*> pendingPrograms;
+
+// 存檔後下一幀自動重新compile (hot reload), 不用重開程式重新載入模型
+ShaderWatcher shaderWatcher;
+
+void submitProgram(shader_program_t* shader){
+    shader->submit_link();
+    pendingPrograms.push_back(shader);
+    shaderWatcher.watch(shader);
+}
+
+void printBuildStats(){
+    program_build_stats_t buildStats = shader_program_t::build_stats();
+    std::cout << "shaders: " << buildStats.programs << " programs, " << buildStats.from_cache << " from binary cache"
+              << " (compile " << buildStats.compile_ms << " ms, link " << buildStats.link_ms
+              << " ms, load " << buildStats.load_ms << " ms, waited " << buildStats.wait_ms << " ms)" << std::endl;
+}
+
+// 每幀一次, 不會等driver (沒有parallel_shader_compile的話is_ready()只能直接等link結果)
+void pollPrograms(){
+    if (pendingPrograms.empty()) return;
+    auto linked = std::remove_if(pendingPrograms.begin(), pendingPrograms.end(), [](shader_program_t* shader) {
+        if (!shader->is_ready()) return false;
+        if (shader->get_program_id() != 0) bindSceneBlocks(shader); // 0 = link失敗, log已經印了
+        return true;
+    });
+    if (linked == pendingPrograms.end()) return;
+    pendingPrograms.erase(linked, pendingPrograms.end());
+    if (pendingPrograms.empty()) printBuildStats();
+}
+
+bool programReady(shader_program_t* shader){
+    return std::find(pendingPrograms.begin(), pendingPrograms.end(), shader) == pendingPrograms.end();
+}
+
+// program還在link的draw這幀先跳過, 不然use()會卡住等它; link失敗的 (id 0) 就都不畫
+void submitDraw(const RenderItem& item){
+    if (item.program != nullptr && (!programReady(item.program) || item.program->get_program_id() == 0)) return;
+    renderQueue.submit(item);
+}
+
+// link失敗的話reload()會印log並保留舊的program
+void reloadChangedShaders(){
+    for (auto shader : shaderWatcher.poll()) {
+        if (shader->reload()) {
+            bindSceneBlocks(shader);
+            shaderWatcher.watch(shader); // #include可能有變
+        }
     }
+}
+
+// New CPU flakes: static attributes uploaded once, ring regions big enough for sorted flakes
+void resizeCpuSnow(size_t count) {
+    snowSystem.reset(count, static_cast<uint32_t>(std::time(nullptr)));
+    snowSorter.forget();
     
-    // Create VAO and VBO
-    glGenVertexArrays(1, &snowflakeVAO);
-    glGenBuffers(1, &snowflakeVBO);
-    
-    glBindVertexArray(snowflakeVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, snowflakeVBO);
-    
-    // Each snowflake has: position(3) + size(1) + rotation(1) = 5 floats
-    glBufferData(GL_ARRAY_BUFFER, SNOWFLAKE_COUNT * 5 * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+    // size + rotation never change, uploaded once
+    std::vector<float> staticData(count * 2);
+    snowSystem.writeStaticAttributes(staticData.data());
+    glBindBuffer(GL_ARRAY_BUFFER, snowflakeStaticVBO);
+    glBufferData(GL_ARRAY_BUFFER, staticData.size() * sizeof(float), staticData.data(), GL_STATIC_DRAW);
     
-    // position
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    // one ring region per frame (snowflake_update): 3 floats per flake, 5 when sorted
+    snowflakePositions->reserve(count * 5 * sizeof(float));
+}
+
+// Position, size and rotation of both CPU snow VAOs: position from this frame's ring region and the
+// rest from the static buffer, or all three interleaved in the region when sorted
+void pointSnowAttributes(size_t offset, bool sorted) {
+    for (unsigned int vertexArray : {snowflakeVAO, snowflakeInstancedVAO}) {
+        glBindVertexArray(vertexArray);
+        glBindBuffer(GL_ARRAY_BUFFER, snowflakePositions->buffer());
+        if (sorted) {
+            const size_t stride = 5 * sizeof(float);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+            glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, stride, (void*)(offset + 3 * sizeof(float)));
+            glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, stride, (void*)(offset + 4 * sizeof(float)));
+            continue;
+        }
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)offset);
+        glBindBuffer(GL_ARRAY_BUFFER, snowflakeStaticVBO);
+        glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)(1 * sizeof(float)));
+    }
+    glBindVertexArray(0);
+}
+
+void snowflake_setup() {
+    // Create VAO and VBOs
+    glGenVertexArrays(1, &snowflakeVAO);
+    glGenBuffers(1, &snowflakeStaticVBO);
+    snowflakePositions = new StreamBuffer(GL_ARRAY_BUFFER);
+    resizeCpuSnow(SNOWFLAKE_COUNT);
     
-    // size
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    // Instanced: the same three attributes once per flake + the star mesh per vertex
+    float star[SnowSystem::STAR_VERTICES * 2];
+    SnowSystem::writeStarMesh(star);
+    glGenBuffers(1, &snowflakeStarVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, snowflakeStarVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(star), star, GL_STATIC_DRAW);
     
-    // rotation
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(4 * sizeof(float)));
+    glGenVertexArrays(1, &snowflakeInstancedVAO);
+    glBindVertexArray(snowflakeInstancedVAO);
+    for (int location = 0; location < 3; location++) glVertexAttribDivisor(location, 1);
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
     
-    glBindVertexArray(0);
+    // position, size, rotation
+    for (unsigned int vertexArray : {snowflakeVAO, snowflakeInstancedVAO}) {
+        glBindVertexArray(vertexArray);
+        for (int location = 0; location < 3; location++) glEnableVertexAttribArray(location);
+    }
+    pointSnowAttributes(0, snowSorted);
     
     // Create shader program
 #if defined(__linux__) || defined(__APPLE__)
@@ -369,102 +739,162 @@ void snowflake_setup() {
     std::string vpath = shaderDir + "snowflake.vert";
     std::string gpath = shaderDir + "snowflake.geom";
     std::string fpath = shaderDir + "snowflake.frag";
+    std::string instancedPath = shaderDir + "snowflake_instanced.vert";
     
     snowflakeShader = new shader_program_t();
     snowflakeShader->create();
     snowflakeShader->add_shader(vpath, GL_VERTEX_SHADER);
     snowflakeShader->add_shader(gpath, GL_GEOMETRY_SHADER);
     snowflakeShader->add_shader(fpath, GL_FRAGMENT_SHADER);
-    snowflakeShader->link_shader();
+    submitProgram(snowflakeShader);
+    
+    snowflakeInstancedShader = new shader_program_t();
+    snowflakeInstancedShader->create();
+    snowflakeInstancedShader->add_shader(instancedPath, GL_VERTEX_SHADER);
+    snowflakeInstancedShader->add_shader(fpath, GL_FRAGMENT_SHADER);
+    submitProgram(snowflakeInstancedShader);
+    
+    // GPU simulation: vertex shader only, outputs captured by transform feedback
+    std::string initPath = shaderDir + "snow_init.vert";
+    std::string updatePath = shaderDir + "snow_update.vert";
+    
+    snowInitShader = new shader_program_t();
+    snowInitShader->create();
+    snowInitShader->add_shader(initPath, GL_VERTEX_SHADER);
+    snowInitShader->set_feedback_varyings({GpuSnowSystem::INIT_VARYINGS[0], GpuSnowSystem::INIT_VARYINGS[1]},
+                                          GL_SEPARATE_ATTRIBS);
+    submitProgram(snowInitShader);
+    
+    snowUpdateShader = new shader_program_t();
+    snowUpdateShader->create();
+    snowUpdateShader->add_shader(updatePath, GL_VERTEX_SHADER);
+    snowUpdateShader->set_feedback_varyings({GpuSnowSystem::UPDATE_VARYINGS[0]}, GL_INTERLEAVED_ATTRIBS);
+    submitProgram(snowUpdateShader);
+    
+    // buffers are only created the first time H is pressed
+    gpuSnow = new GpuSnowSystem(snowInitShader, snowUpdateShader);
+    gpuSnow->setStarMesh(snowflakeStarVBO);
 }
 
 void snowflake_update() {
     if (!snowflakeEnabled) return;
     
-    for (int i = 0; i < SNOWFLAKE_COUNT; i++) {
-        // Snowflake falling
-        snowflakes[i].position.y -= snowflakes[i].fallSpeed * deltaTime;
-        
-        // Horizontal swaying effect
-        float sway = sin(currentTime * 2.0f + snowflakes[i].swayPhase) * 15.0f * deltaTime;
-        snowflakes[i].position.x += sway;
+    if (snowOnGpu) {
+        gpuSnow->update(currentTime, deltaTime);
+        return;
+    }
+    
+    const size_t count = snowSystem.size();
+    if (snowSorted) {
+        snowScratch.resize(count * 3);
+        snowSystem.update(currentTime, deltaTime, snowScratch.data());
         
-        // If snowflake falls below ground, respawn from top
-        if (snowflakes[i].position.y < SNOW_HEIGHT_MIN) {
-            snowflakes[i].position.y = SNOW_HEIGHT_MAX;
-            snowflakes[i].position.x = randomFloat(-SNOW_AREA_SIZE / 2, SNOW_AREA_SIZE / 2);
-            snowflakes[i].position.z = randomFloat(-SNOW_AREA_SIZE / 2, SNOW_AREA_SIZE / 2);
+        // view space depth = distance along the camera's front (glm::lookAt)
+        glm::vec3 front = glm::normalize(camera.front);
+        const float* x = snowSystem.x();
+        const float* y = snowSystem.y();
+        const float* z = snowSystem.z();
+        snowDepths.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            snowDepths[i] = (x[i] - camera.position.x) * front.x + (y[i] - camera.position.y) * front.y
+                          + (z[i] - camera.position.z) * front.z;
         }
+        double sortStart = glfwGetTime();
+        const std::vector<uint32_t>& order = snowSorter.sort(snowDepths.data(), count);
+        snowSortMs = (glfwGetTime() - sortStart) * 1000.0;
+        
+        float* flakes = static_cast<float*>(snowflakePositions->map(count * 5 * sizeof(float)));
+        if (flakes == nullptr) return;
+        snowSystem.writeOrdered(order.data(), flakes);
+        pointSnowAttributes(snowflakePositions->unmap(), true);
+        return;
     }
     
-    // Update VBO data
-    std::vector<float> data(SNOWFLAKE_COUNT * 5);
-    for (int i = 0; i < SNOWFLAKE_COUNT; i++) {
-        data[i * 5 + 0] = snowflakes[i].position.x;
-        data[i * 5 + 1] = snowflakes[i].position.y;
-        data[i * 5 + 2] = snowflakes[i].position.z;
-        data[i * 5 + 3] = snowflakes[i].size;
-        data[i * 5 + 4] = snowflakes[i].rotation;
-    }
+    // The update writes the positions straight into the mapped ring region, no temporary copy.
+    // The GPU keeps reading the previous frames' regions meanwhile.
+    float* positions = static_cast<float*>(snowflakePositions->map(count * 3 * sizeof(float)));
+    if (positions == nullptr) return;
+    snowSystem.update(currentTime, deltaTime, positions);
     
-    glBindBuffer(GL_ARRAY_BUFFER, snowflakeVBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, data.size() * sizeof(float), data.data());
+    // Point the position attribute at this frame's region (size + rotation stay where they are)
+    pointSnowAttributes(snowflakePositions->unmap(), false);
 }
 
-void renderSnowflakes(const glm::mat4& view, const glm::mat4& projection) {
+// 'blendedDepths': view depth of the other BLENDED draws this frame
+void renderSnowflakes(const std::vector<float>& blendedDepths) {
     if (!snowflakeEnabled || snowflakeShader == nullptr) return;
     
-    // Enable blending for transparency effect
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDepthMask(GL_FALSE);  // Disable depth write to avoid transparency occlusion issues
-    
-    snowflakeShader->use();
-    snowflakeShader->set_uniform_value("view", view);
-    snowflakeShader->set_uniform_value("projection", projection);
-    snowflakeShader->set_uniform_value("time", currentTime);
-    
-    glBindVertexArray(snowflakeVAO);
-    glDrawArrays(GL_POINTS, 0, SNOWFLAKE_COUNT);
-    glBindVertexArray(0);
+    GLsizei flakes = (GLsizei)(snowOnGpu ? gpuSnow->size() : snowSystem.size());
+    RenderItem item;
+    item.pass = RenderPass::BLENDED;
+    if (snowInstanced) {
+        // one star (36 vertices) per flake, no geometry shader
+        item.program = snowflakeInstancedShader;
+        item.vertexArray = snowOnGpu ? gpuSnow->instancedVertexArray() : snowflakeInstancedVAO;
+        item.mode = GL_TRIANGLES;
+        item.count = SnowSystem::STAR_VERTICES;
+        item.instanceCount = flakes;
+    } else {
+        item.program = snowflakeShader;
+        item.vertexArray = snowOnGpu ? gpuSnow->vertexArray() : snowflakeVAO;
+        item.mode = GL_POINTS;
+        item.count = flakes;
+    }
+    item.indexed = false;
+    item.before = beginSnowTimer;
+    item.after = endSnowTimer;
+    // Enable blending for transparency effect (glBlendFunc is set in setup)
+    item.state.blend = true;
+    item.state.depthWrite = false;  // Disable depth write to avoid transparency occlusion issues
     
-    snowflakeShader->release();
+    // Unsorted (or no glDrawArraysInstancedBaseInstance to start in the middle): one draw
+    bool sorted = snowSorted && !snowOnGpu && snowSorter.order().size() == (size_t)flakes;
+    if (!sorted || blendedDepths.empty() || (snowInstanced && !GLAD_GL_VERSION_4_2)) {
+        submitDraw(item);
+        return;
+    }
     
-    glDepthMask(GL_TRUE);
-    glDisable(GL_BLEND);
+    // Sorted: one draw per run of flakes between two blended draws, the queue orders them by depth
+    std::vector<float> cuts(blendedDepths);
+    std::sort(cuts.begin(), cuts.end(), std::greater<float>());
+    const std::vector<uint32_t>& order = snowSorter.order();
+    std::vector<RenderItem> runs;
+    size_t begin = 0;
+    for (size_t c = 0; c <= cuts.size(); c++) {
+        size_t end = order.size();
+        if (c < cuts.size()) {
+            float cut = cuts[c];
+            end = std::partition_point(order.begin() + begin, order.end(),
+                                       [cut](uint32_t flake) { return snowDepths[flake] >= cut; }) - order.begin();
+        }
+        if (end == begin) continue;
+        
+        RenderItem run = item;
+        run.depth = snowDepths[order[end - 1]]; // nearest flake: behind the next cut, in front of the last
+        if (snowInstanced) {
+            run.baseInstance = (GLuint)begin;
+            run.instanceCount = (GLsizei)(end - begin);
+        } else {
+            run.firstIndex = (GLuint)begin;
+            run.count = (GLsizei)(end - begin);
+        }
+        run.before = runs.empty() ? beginSnowTimer : nullptr;
+        run.after = nullptr;
+        runs.push_back(run);
+        begin = end;
+    }
+    // the timer spans every run, and whatever is drawn between them
+    runs.back().after = endSnowTimer;
+    for (const RenderItem& run : runs) submitDraw(run);
 }
 
 // 渲染青蛙
-void renderFrog(const glm::mat4& view, const glm::mat4& projection) {
+void renderFrog(const glm::mat4& view) {
     if (!showFrog || frogShader == nullptr || frogModel == nullptr) {
         return;
     }
     
-    frogShader->use();
-    
-    // 設置shader需要的變數
-    frogShader->set_uniform_value("view", view);
-    frogShader->set_uniform_value("projection", projection);
-    frogShader->set_uniform_value("viewPos", camera.position);
-    frogShader->set_uniform_value("time", (float)glfwGetTime());
-    
-    // 設置光照
-    frogShader->set_uniform_value("light.position", light.position);
-    frogShader->set_uniform_value("light.ambient", light.ambient);
-    frogShader->set_uniform_value("light.diffuse", light.diffuse);
-    frogShader->set_uniform_value("light.specular", light.specular);
-    
-    // 設置材質
-    frogShader->set_uniform_value("material.ambient", glm::vec3(1.0f));
-    frogShader->set_uniform_value("material.diffuse", glm::vec3(1.0f)); // 白色，不影響貼圖顏色
-    frogShader->set_uniform_value("material.specular", glm::vec3(0.3f));
-    frogShader->set_uniform_value("material.gloss", 20.0f);
-    
-    // 綁定青蛙紋理
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, frogTexture);
-    frogShader->set_uniform_value("frogTexture", 0);
-    
+    // camera / 光照 / 材質都在uniform block裡, 青蛙用FROG_MATERIAL, 貼圖是frogTexture
     // 渲染青蛙
     glm::mat4 currentFrogMatrix = glm::mat4(1.0f);
     // 調整青蛙位置，使其融入隕石中心
@@ -479,35 +909,93 @@ void renderFrog(const glm::mat4& view, const glm::mat4& projection) {
     }
     currentFrogMatrix = glm::scale(currentFrogMatrix, glm::vec3(frogScale));
     
-    frogShader->set_uniform_value("model", currentFrogMatrix);
-    frogModel->draw();
-    
-    frogShader->release();
+    submitDraw(modelItem(frogModel, frogShader, currentFrogMatrix, view, FROG_MATERIAL, frogTexture));
 }
 
 void shader_setup(){
+    // 新的permutation: link好之前那個物件先不畫
+    litShaders.set_on_submit([](shader_program_t* shader) {
+        pendingPrograms.push_back(shader);
+        shaderWatcher.watch(shader);
+    });
+}
+
+// shaderProgramIndex -> program, lit permutations are built on first use
+// multiDraw: multidraw.vert版本 (MultiDrawBatch), 0/1 (geometry shader) 沒有這種版本會回傳nullptr
+shader_program_t* objectShader(bool multiDraw = false){
+    if (shaderProgramIndex < (int)shaderPrograms.size())
+        return multiDraw ? nullptr : shaderPrograms[shaderProgramIndex];
+
 #if defined(__linux__) || defined(__APPLE__)
     std::string shaderDir = "../../src/shaders/";
-    //std::string shaderDir = "..\\..\\src\\shaders\\";
 #else
-    // std::string shaderDir = "../../src/shaders/";
     std::string shaderDir = "..\\..\\src\\shaders\\";
 #endif
+    int method = shaderProgramIndex - (int)shaderPrograms.size();
+    if (multiDraw) {
+        return litShaders.get({{shaderDir + "multidraw.vert", GL_VERTEX_SHADER}, {shaderDir + "lit.frag", GL_FRAGMENT_SHADER}},
+                              {litShadingMethods[method], "MULTI_DRAW"});
+    }
+    return litShaders.get({{shaderDir + "lit.vert", GL_VERTEX_SHADER}, {shaderDir + "lit.frag", GL_FRAGMENT_SHADER}},
+                          {litShadingMethods[method]});
+}
 
-    std::vector<std::string> shadingMethod = {
-        "default", "bling-phong", "gouraud", "metallic", "glass_schlick", "Toon"
-    };
+// 第一次按G時建: 位置固定 (seed), 石頭跟青蛙輪流
+bool buildStaticField(){
+    if (!meteorModel->isReady() || !frogModel->isReady()) return false;
+    if (!staticField.empty()) return true;
+
+    std::mt19937 rng(2025);
+    std::uniform_real_distribution<float> position(-STATIC_FIELD_SIZE / 2, STATIC_FIELD_SIZE / 2);
+    std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+    std::uniform_real_distribution<float> rockScale(15.0f, 60.0f), frogScale(1.5f, 4.0f);
+
+    for (int i = 0; i < STATIC_FIELD_COUNT; i++) {
+        bool rock = i % 2 == 0;
+        glm::mat4 matrix = glm::translate(glm::mat4(1.0f), glm::vec3(position(rng), METEOR_GROUND_Y, position(rng)));
+        matrix = glm::rotate(matrix, glm::radians(angle(rng)), glm::vec3(0.0f, 1.0f, 0.0f));
+        matrix = glm::scale(matrix, glm::vec3(rock ? rockScale(rng) : frogScale(rng)));
+        staticField.push_back({rock ? meteorModel : frogModel, matrix, rock ? SCENE_MATERIAL : FROG_MATERIAL});
+    }
 
-    for(int i=0; i<shadingMethod.size(); i++){
-        std::string vpath = shaderDir + shadingMethod[i] + ".vert";
-        std::string fpath = shaderDir + shadingMethod[i] + ".frag";
+    // 兩個mesh都要在arena裡 (cache裡的格式不一樣的話會有自己的VAO)
+    if (!MultiDrawBatch::supported() || !meteorModel->inArena() || !frogModel->inArena()) return true;
+    rockBatch = new MultiDrawBatch(*staticArena);
+    frogBatch = new MultiDrawBatch(*staticArena);
+    for (const StaticInstance& instance : staticField) {
+        Object* model = instance.model;
+        MultiDrawBatch* batch = model == meteorModel ? rockBatch : frogBatch;
+        batch->add(model->meshRange(), instance.matrix, model->positionDecode(), instance.materialIndex,
+                   transformSphere(model->boundingSphere(), instance.matrix),
+                   transformBox(model->bounds(), instance.matrix));
+    }
+    return true;
+}
 
-        shader_program_t* shaderProgram = new shader_program_t();
-        shaderProgram->create();
-        shaderProgram->add_shader(vpath, GL_VERTEX_SHADER);
-        shaderProgram->add_shader(fpath, GL_FRAGMENT_SHADER);
-        shaderProgram->link_shader();
-        shaderPrograms.push_back(shaderProgram);
+// 每種texture一個batch item, 或 (3.3 / B / geometry shader) 每個instance一個item, 兩種都先frustum cull
+void renderStaticField(const glm::mat4& view, const Frustum& frustum){
+    if (!showStaticField || staticField.empty()) return;
+
+    shader_program_t* multiDrawShader = rockBatch && useMultiDraw ? objectShader(true) : nullptr;
+    if (multiDrawShader != nullptr) {
+        std::pair<MultiDrawBatch*, unsigned int> batches[] = {{rockBatch, meteorModel->texture()}, {frogBatch, frogTexture}};
+        for (const auto& batch : batches) {
+            batch.first->cull(frustum, fieldCull);
+            RenderItem item;
+            item.program = multiDrawShader;
+            item.vertexArray = staticArena->vertexArray();
+            item.batch = batch.first;
+            item.textures[OBJECT_TEXTURE_UNIT] = {GL_TEXTURE_2D, batch.second ? batch.second : placeholderTexture};
+            item.textures[SKYBOX_TEXTURE_UNIT] = {GL_TEXTURE_CUBE_MAP, cubemapTexture};
+            submitDraw(item);
+        }
+        return;
+    }
+
+    shader_program_t* shader = objectShader();
+    for (const StaticInstance& instance : staticField) {
+        unsigned int texture = instance.model == frogModel ? frogTexture : 0;
+        submitDraw(modelItem(instance.model, shader, instance.matrix, view, instance.materialIndex, texture));
     }
 }
 
@@ -535,7 +1023,7 @@ void shader_setup_w_geometry_shader(){
         shaderProgram->add_shader(vpath, GL_VERTEX_SHADER);
         shaderProgram->add_shader(fpath, GL_FRAGMENT_SHADER);
         shaderProgram->add_shader(gpath, GL_GEOMETRY_SHADER);
-        shaderProgram->link_shader();
+        submitProgram(shaderProgram);
         shaderPrograms.push_back(shaderProgram);
     }
 
@@ -552,7 +1040,7 @@ void shader_setup_w_geometry_shader(){
     portalShader->create();
     portalShader->add_shader(portal_vpath, GL_VERTEX_SHADER);
     portalShader->add_shader(portal_fpath, GL_FRAGMENT_SHADER);
-    portalShader->link_shader();
+    submitProgram(portalShader);
 
     // meteor的shader - 隕石爆炸效果shader（使用geometry shader）
     std::string meteor_vpath = shaderDir + "meteor.vert";
@@ -564,7 +1052,7 @@ void shader_setup_w_geometry_shader(){
     meteorShader->add_shader(meteor_vpath, GL_VERTEX_SHADER);
     meteorShader->add_shader(meteor_gpath, GL_GEOMETRY_SHADER);
     meteorShader->add_shader(meteor_fpath, GL_FRAGMENT_SHADER);
-    meteorShader->link_shader();
+    submitProgram(meteorShader);
 
     // frog的shader
     std::string frog_vpath = shaderDir + "frog.vert";
@@ -574,7 +1062,7 @@ void shader_setup_w_geometry_shader(){
     frogShader->create();
     frogShader->add_shader(frog_vpath, GL_VERTEX_SHADER);
     frogShader->add_shader(frog_fpath, GL_FRAGMENT_SHADER);
-    frogShader->link_shader();
+    submitProgram(frogShader);
 }
 
 void cubemap_setup(){
@@ -608,7 +1096,7 @@ void cubemap_setup(){
     cubemapShader->create();
     cubemapShader->add_shader(vpath, GL_VERTEX_SHADER);
     cubemapShader->add_shader(fpath, GL_FRAGMENT_SHADER);
-    cubemapShader->link_shader();
+    submitProgram(cubemapShader);
 
     glGenVertexArrays(1, &cubemapVAO);
     glGenBuffers(1, &cubemapVBO);
@@ -623,15 +1111,17 @@ void cubemap_setup(){
 void setup(){
     light_setup();
     model_setup();
-    // shader_setup();
     shader_setup_w_geometry_shader();
+    shader_setup();
     camera_setup();
     cubemap_setup();
     material_setup();
+    uniform_block_setup();
     snowflake_setup();
 
     glEnable(GL_DEPTH_TEST);
     glDepthFunc(GL_LEQUAL);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // only enabled for RenderState::blend draws
     glEnable(GL_CULL_FACE);
     glFrontFace(GL_CCW);
     glCullFace(GL_BACK);
@@ -747,56 +1237,28 @@ void render(){
     float aspect = (SCR_HEIGHT > 0) ? (float)SCR_WIDTH / (float)SCR_HEIGHT : 1.0f;
     glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 5000.0f); // 1000 -> 5000避免被obj被卡掉
 
-    // set matrix for view, projection, model transformation
-    shaderPrograms[shaderProgramIndex]->use();
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("model", maradaMatrix);
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("view", view);
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("projection", projection);
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("viewPos", camera.position);
-
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("time", (float)glfwGetTime());
-    // TODO: set additional uniform value for shader program
+    // view, projection, viewPos, time, light 整幀只上傳一次, 各program從uniform block讀
+    updateFrameBlocks(view, projection);
 
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("light.position", light.position);
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("light.ambient",  light.ambient);
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("light.diffuse",  light.diffuse);
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("light.specular", light.specular);
+    // 在frustum外面的model不會送到GL
+    Frustum frustum = Frustum::fromMatrix(projection * view);
 
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("material.ambient",  material.ambient);
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("material.diffuse",  material.diffuse);
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("material.specular", material.specular);
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("material.gloss",    material.gloss);
-
-    // specifying sampler for shader program
-
-    glActiveTexture(GL_TEXTURE0);
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("objectTexture", 0); // object texture
-
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
-    shaderPrograms[shaderProgramIndex]->set_uniform_value("skybox", 1); // Set cubemap texture for reflection
+    shader_program_t* maradaShader = objectShader();
+    std::vector<float> blendedDepths; // 半透明的draw, 雪花要在它們之間切開
 
     // Draw character model
-    if(isCube)
-        cubeModel->draw();
-    else
-        maradaModel->draw();
+    RenderItem marada = modelItem(isCube ? cubeModel : maradaModel, maradaShader, maradaMatrix, view);
+    marada.before = beginMaradaTimer;
+    marada.after = endMaradaTimer;
+    submitDraw(marada);
 
 
     // 如果觸發顯示portal -> draw
     // transformation 要在這邊處理!!!
     // ***記得要用正確的shader 
-    // 直接用上面的shaderPrograms[shaderProgramIndex]的話會跟marada用到一樣的 (就是會爆炸的意思)
+    // 直接用上面的maradaShader的話會跟marada用到一樣的 (就是會爆炸的意思)
 
     if (showPortal) {
-        portalShader->use();
-
-        // 傳該用的variables進去
-        portalShader->set_uniform_value("view", view);
-        portalShader->set_uniform_value("projection", projection);
-        portalShader->set_uniform_value("viewPos", camera.position);
-        portalShader->set_uniform_value("time", (float)glfwGetTime());
-        portalShader->set_uniform_value("progress", currentProgress);
         // transformation
         glm::mat4 currentPortalMatrix = glm::mat4(1.0f);
         // 移到初始位置
@@ -811,70 +1273,29 @@ void render(){
         // 放大
         currentPortalMatrix = glm::scale(currentPortalMatrix, glm::vec3(portalScale));
 
-        portalShader->set_uniform_value("model", currentPortalMatrix);
-        glActiveTexture(GL_TEXTURE0);
-        portalShader->set_uniform_value("objectTexture", 0);
-        portalModel->draw();
-
-        portalShader->release();
+        RenderItem portal = modelItem(portalModel, portalShader, currentPortalMatrix, view);
+        // 傳該用的variables進去 (camera跟time在uniform block)
+        portal.setFloat("progress", currentProgress);
+        // portal.frag的邊緣靠alpha淡出: 跟雪花一起由遠到近畫
+        portal.pass = RenderPass::BLENDED;
+        portal.state.blend = true;
+        portal.state.depthWrite = false;
+        submitDraw(portal);
+        blendedDepths.push_back(portal.depth);
     }
 
     // 渲染隕石（如果觸發了隕石動畫）
+    // 以前在青蛙之後再畫一次隕石蓋住青蛙, 但第二次的深度跟第一次一樣, GL_LESS下全部被擋掉, 靠depth test就夠了
     if (showMeteor && meteorShader != nullptr) {
-        meteorShader->use();
-        
-        // 設置shader需要的變數
-        meteorShader->set_uniform_value("view", view);
-        meteorShader->set_uniform_value("projection", projection);
-        meteorShader->set_uniform_value("viewPos", camera.position);
-        meteorShader->set_uniform_value("time", (float)glfwGetTime());
-        meteorShader->set_uniform_value("explosionProgress", meteorExplosionProgress);
-        
-        // 設置光照
-        meteorShader->set_uniform_value("light.position", light.position);
-        meteorShader->set_uniform_value("light.ambient", light.ambient);
-        meteorShader->set_uniform_value("light.diffuse", light.diffuse);
-        meteorShader->set_uniform_value("light.specular", light.specular);
-        
-        meteorShader->set_uniform_value("model", meteorMatrix);
-        
-        glActiveTexture(GL_TEXTURE0);
-        meteorShader->set_uniform_value("objectTexture", 0);
-        meteorModel->draw();
-        
-        meteorShader->release();
+        RenderItem meteor = modelItem(meteorModel, meteorShader, meteorMatrix, view);
+        // 設置shader需要的變數 (光照跟材質在uniform block)
+        meteor.setFloat("explosionProgress", meteorExplosionProgress);
+        submitDraw(meteor);
     }
 
-    // 先shade青蛙，使其被隕石蓋掉
-    renderFrog(view, projection);
-    
-    if (showMeteor && meteorShader && meteorModel && meteorTimer < METEOR_FALL_DURATION) {
-        meteorShader->use();
-        meteorShader->set_uniform_value("view", view);
-        meteorShader->set_uniform_value("projection", projection);
-        meteorShader->set_uniform_value("viewPos", camera.position);
-        meteorShader->set_uniform_value("explosionProgress", 0.0f);
-        
-        meteorShader->set_uniform_value("material.ambient", material.ambient);
-        meteorShader->set_uniform_value("material.diffuse", material.diffuse);
-        meteorShader->set_uniform_value("material.specular", material.specular);
-        meteorShader->set_uniform_value("material.gloss", material.gloss);
-        
-        meteorShader->set_uniform_value("light.position", light.position);
-        meteorShader->set_uniform_value("light.ambient", light.ambient);
-        meteorShader->set_uniform_value("light.diffuse", light.diffuse);
-        meteorShader->set_uniform_value("light.specular", light.specular);
-        
-        meteorShader->set_uniform_value("model", meteorMatrix);
-        
-        glActiveTexture(GL_TEXTURE0);
-        meteorShader->set_uniform_value("objectTexture", 0);
-        meteorModel->draw();
-        
-        meteorShader->release();
-    }
+    renderFrog(view);
 
-    shaderPrograms[shaderProgramIndex]->release();
+    renderStaticField(view, frustum);
 
     // TODO 
     // Rendering cubemap environment
@@ -884,34 +1305,27 @@ void render(){
     // 3. You can use the cubemapShader to render the cubemap 
     //    (refer to the above code to get an idea of how to use the shader program)
 
-    glDepthFunc(GL_LEQUAL); // draw equal depth (=1), let cubemap can be always the max depth (=1)
-    cubemapShader->use();
-    
-    glm::mat4 viewSkybox = glm::mat4(glm::mat3(view)); // remove camera translation, let cubemap stay around the camera
-    
-    cubemapShader->set_uniform_value("view", viewSkybox);
-    cubemapShader->set_uniform_value("projection", projection);
-    
-    glBindVertexArray(cubemapVAO);
-    
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
-    cubemapShader->set_uniform_value("skybox", 0);
-    
+    RenderItem sky;
+    sky.pass = RenderPass::SKY; // 在所有不透明的東西之後
+    sky.program = cubemapShader; // cubemap.vert removes the camera translation from the block's view
+    sky.vertexArray = cubemapVAO;
     // cubemapVertices is typically the vertex count of a cube (6 faces * 2 triangles * 3 vertices = 36)
-    glDrawArrays(GL_TRIANGLES, 0, 36);
-    
-    glBindVertexArray(0);
-    
-    glDepthFunc(GL_LESS);
-    
+    sky.count = 36;
+    sky.indexed = false;
+    sky.textures[SKYBOX_TEXTURE_UNIT] = {GL_TEXTURE_CUBE_MAP, cubemapTexture};
+    sky.state.depthFunc = GL_LEQUAL; // draw equal depth (=1), let cubemap can be always the max depth (=1)
+    submitDraw(sky);
+
     // Render snowflakes
-    renderSnowflakes(view, projection);
+    renderSnowflakes(blendedDepths);
+
+    renderQueue.execute(glState, &frustum);
 }
 
 int main() {
     glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    // 4.3 for glMultiDrawElementsIndirect (static field), everything else only needs 3.3
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
@@ -920,6 +1334,11 @@ int main() {
 #endif
 
     GLFWwindow *window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "HW3-Static Model", NULL, NULL);
+    if (window == NULL) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "HW3-Static Model", NULL, NULL);
+    }
     if (window == NULL) {
         std::cerr << "Failed to create GLFW window" << std::endl;
         glfwTerminate();
@@ -935,42 +1354,102 @@ int main() {
         return -1;
     }
 
+    std::cout << "OpenGL " << glGetString(GL_VERSION)
+              << (MultiDrawBatch::supported() ? "" : " (no multi-draw indirect, the static field uses one draw per mesh)") << std::endl;
+
     glfwGetFramebufferSize(window, &SCR_WIDTH, &SCR_HEIGHT);
     glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
 
+    double startTime = glfwGetTime();
+    // linked programs are kept here between runs, see shader_program_t::link_shader
+    shader_program_t::set_binary_cache_dir("shader_cache");
+    shader_program_t::enable_parallel_compile();
     setup();
-    
+
+    bool firstFrame = true;
+    bool assetsReady = false;
     while (!glfwWindowShouldClose(window)) {
+        assetLoader->processUploads(ASSET_UPLOAD_BUDGET_MS);
+        reloadChangedShaders();
+        pollPrograms();
+
         processInput(window);
         update(); 
         render(); 
         glfwSwapBuffers(window);
+
+        lastFrameUniformStats = shader_program_t::uniform_stats();
+        shader_program_t::reset_uniform_stats();
+        lastFrameBlockUploads = UniformBuffer::uploads();
+        lastFrameBlockSkipped = UniformBuffer::skipped();
+        UniformBuffer::resetStats();
+        lastFrameQueueStats = renderQueue.stats();
+        lastFrameFieldCull = fieldCull;
+        fieldCull = CullStats();
+        lastFrameStateStats = glState.stats();
+        glState.resetStats();
+
+        if (firstFrame) {
+            std::cout << "first frame after " << (glfwGetTime() - startTime) * 1000.0 << " ms" << std::endl;
+            firstFrame = false;
+        }
+        if (!assetsReady && assetLoader->idle()) {
+            std::cout << "all assets ready after " << (glfwGetTime() - startTime) * 1000.0 << " ms" << std::endl;
+            assetsReady = true;
+            TextureCache::shared().printStats();
+            printMeshMemory();
+        }
+
         glfwPollEvents();
     }
 
+    // 先停掉worker, 它們可能還在寫model
+    delete assetLoader;
+
     // 記得delete model
     delete maradaModel;
     delete portalModel; 
     delete cubeModel;
     delete meteorModel;
     delete frogModel;
+    delete rockBatch;
+    delete frogBatch;
+    delete staticArena; // after the models that live in it
     
     for (auto shader : shaderPrograms) {
         delete shader;
     }
+    litShaders.clear();
     delete cubemapShader;
     delete snowflakeShader;
+    delete snowflakeInstancedShader;
+    delete gpuSnow;
+    delete snowInitShader;
+    delete snowUpdateShader;
     delete portalShader;
     delete meteorShader;
     delete frogShader;
     
-    // 清理青蛙紋理
-    if (frogTexture != 0) {
-        glDeleteTextures(1, &frogTexture);
+    // 清理青蛙紋理 (placeholder不在cache裡, release會直接忽略)
+    TextureCache::shared().release(frogTexture);
+    TextureCache::shared().release(cubemapTexture);
+    glDeleteTextures(1, &placeholderTexture);
+    if (maradaTimerQueries[0] != 0) {
+        glDeleteQueries(2, maradaTimerQueries);
+    }
+    if (snowTimerQueries[0] != 0) {
+        glDeleteQueries(2, snowTimerQueries);
     }
     
+    cameraBlock.release();
+    lightBlock.release();
+    materialBlock.release();
+
     glDeleteVertexArrays(1, &snowflakeVAO);
-    glDeleteBuffers(1, &snowflakeVBO);
+    glDeleteBuffers(1, &snowflakeStaticVBO);
+    glDeleteVertexArrays(1, &snowflakeInstancedVAO);
+    glDeleteBuffers(1, &snowflakeStarVBO);
+    delete snowflakePositions;
 
     glfwTerminate();
     return 0;
@@ -1041,8 +1520,87 @@ void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods
     if (key == GLFW_KEY_P && action == GLFW_PRESS)
         showPortal = !showPortal;
 
-    if (key == GLFW_KEY_N && action == GLFW_PRESS)
+    if (key == GLFW_KEY_N && action == GLFW_PRESS) {
         snowflakeEnabled = !snowflakeEnabled;
+        if (snowflakeEnabled)
+            std::cout << "snow: " << snowSystem.size() << " flakes, " << SnowSystem::kernelName(SnowSystem::bestKernel())
+                      << " update, " << (snowflakePositions->persistent() ? "persistent mapped" : "orphaned")
+                      << " ring, " << snowflakePositions->stalls() << " waits for the GPU so far" << std::endl;
+    }
+
+    if ((key == GLFW_KEY_H || key == GLFW_KEY_J) && action == GLFW_PRESS) {
+        if (key == GLFW_KEY_H) snowOnGpu = !snowOnGpu;
+        else snowCountIndex = (snowCountIndex + 1) % 3;
+        resetSnowTimer();
+        size_t count = SNOWFLAKE_COUNTS[snowCountIndex];
+        if (snowOnGpu && gpuSnow->size() != count)
+            gpuSnow->reset(count, static_cast<uint32_t>(std::time(nullptr)));
+        if (!snowOnGpu && snowSystem.size() != count) resizeCpuSnow(count);
+        if (snowOnGpu) std::cout << "snow: " << gpuSnow->size() << " flakes simulated on the GPU (transform feedback)" << std::endl;
+        else std::cout << "snow: " << snowSystem.size() << " flakes simulated on the CPU" << std::endl;
+    }
+
+    if (key == GLFW_KEY_Z && action == GLFW_PRESS) {
+        snowSorted = !snowSorted;
+        resetSnowTimer();
+        if (snowSorted) std::cout << "snow: sorted back to front" << (snowOnGpu ? " (CPU simulation only, H)" : "") << std::endl;
+        else std::cout << "snow: drawn in simulation order" << std::endl;
+    }
+
+    if (key == GLFW_KEY_K && action == GLFW_PRESS) {
+        snowInstanced = !snowInstanced;
+        resetSnowTimer();
+        std::cout << "snow: " << (snowInstanced ? "instanced star mesh (glDrawArraysInstanced)" : "geometry shader")
+                  << std::endl;
+    }
+
+    if (key == GLFW_KEY_L && action == GLFW_PRESS) {
+        profileSnow = !profileSnow;
+        resetSnowTimer();
+    }
+
+    if (key == GLFW_KEY_U && action == GLFW_PRESS) {
+        std::cout << "uniforms last frame: " << lastFrameUniformStats.uploads << " uploads, "
+                  << lastFrameUniformStats.redundant << " skipped (unchanged or inactive), "
+                  << lastFrameUniformStats.lookups << " glGetUniformLocation calls avoided" << std::endl;
+        std::cout << "uniform blocks last frame: " << lastFrameBlockUploads << " updates, "
+                  << lastFrameBlockSkipped << " unchanged" << std::endl;
+        std::cout << "render queue last frame: " << lastFrameQueueStats.draws << " draws, "
+                  << lastFrameQueueStats.changesSubmitted << " state changes in submission order, "
+                  << lastFrameQueueStats.changesSorted << " after sorting; GL state calls "
+                  << lastFrameStateStats.issued << " issued, " << lastFrameStateStats.redundant << " redundant skipped" << std::endl;
+        std::cout << "frustum culling last frame: " << lastFrameQueueStats.cull.tested << " tested, "
+                  << lastFrameQueueStats.cull.culled << " culled (" << lastFrameQueueStats.cull.culledByBox
+                  << " by the box after the sphere passed)" << std::endl;
+        if (showStaticField) {
+            std::cout << "static field: " << staticField.size() << " meshes, ";
+            if (lastFrameFieldCull.tested > 0) // the batches cull themselves
+                std::cout << lastFrameQueueStats.batchedDraws << " drawn by 2 glMultiDrawElementsIndirect ("
+                          << lastFrameFieldCull.culled << " culled)" << std::endl;
+            else
+                std::cout << "one draw call per visible mesh (multi-draw " << (rockBatch ? "off" : "not available") << ")" << std::endl;
+        }
+    }
+
+    if (key == GLFW_KEY_G && action == GLFW_PRESS) {
+        if (buildStaticField()) showStaticField = !showStaticField;
+        else std::cout << "static field: meteor / frog still loading" << std::endl;
+    }
+
+    if (key == GLFW_KEY_B && action == GLFW_PRESS) {
+        useMultiDraw = !useMultiDraw;
+        std::cout << "static field multi-draw indirect " << (useMultiDraw ? "on" : "off") << std::endl;
+    }
+
+    if (key == GLFW_KEY_V && action == GLFW_PRESS)
+        switchMaradaFormat();
+
+    if (key == GLFW_KEY_T && action == GLFW_PRESS) {
+        profileMarada = !profileMarada;
+        maradaTimerFrame = 0;
+        maradaGpuMs = maradaCpuMs = 0.0;
+        maradaTimerSamples = 0;
+    }
 
     if (key == GLFW_KEY_M && action == GLFW_PRESS) {
         // 按下M鍵觸發隕石從portal掉落
@@ -1061,22 +1619,9 @@ void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods
         shaderProgramIndex = 1;
 
 
-    // 暫時移除下面的 不然按到會crash
-
-    // if (key == GLFW_KEY_2 && (action == GLFW_REPEAT || action == GLFW_PRESS)) 
-    //     shaderProgramIndex = 2;
-    // if (key == GLFW_KEY_3 && action == GLFW_PRESS)
-    //     shaderProgramIndex = 3;
-    // if (key == GLFW_KEY_4 && action == GLFW_PRESS)
-    //     shaderProgramIndex = 4;
-    // if (key == GLFW_KEY_5 && action == GLFW_PRESS)
-    //     shaderProgramIndex = 5;
-    // if (key == GLFW_KEY_6 && action == GLFW_PRESS)
-    //     shaderProgramIndex = 6;
-    // if (key == GLFW_KEY_7 && action == GLFW_PRESS)
-    //     shaderProgramIndex = 7;
-    // if (key == GLFW_KEY_8 && action == GLFW_PRESS)
-    //     shaderProgramIndex = 8;
+    // 2~7: lit shading methods (UNLIT, BLING-PHONG, GOURAUD, METALLIC, GLASS, TOON)
+    if (key >= GLFW_KEY_2 && key <= GLFW_KEY_7 && action == GLFW_PRESS)
+        shaderProgramIndex = (int)shaderPrograms.size() + (key - GLFW_KEY_2);
     // if( key == GLFW_KEY_9 && action == GLFW_PRESS)
     //     isCube = !isCube;
 }
@@ -1089,33 +1634,5 @@ void framebufferSizeCallback(GLFWwindow *window, int width, int height) {
 
 unsigned int loadCubemap(vector<std::string>& faces)
 {
-    unsigned int texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
-
-    int width, height, nrChannels;
-    for (unsigned int i = 0; i < faces.size(); i++)
-    {
-        stbi_set_flip_vertically_on_load(false);
-        unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-        if (data)
-        {
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 
-                         0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data
-            );
-            stbi_image_free(data);
-        }
-        else
-        {
-            std::cout << "Cubemap tex failed to load at path: " << faces[i] << std::endl;
-            stbi_image_free(data);
-        }
-    }
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-    return texture;
-}  
+    return TextureCache::shared().loadCubemap(faces);
+}
\ No newline at end of file
@@ -5,6 +5,12 @@
 
 #include "header/shader.h"
 
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
 shader_program_t::shader_program_t(){
     program_handle = 0;
 }
@@ -18,7 +24,7 @@ void shader_program_t::create(){
 
 void shader_program_t::add_shader(std::string& filepath, unsigned int type){
     
-    // compile and add shader to program
+    // read and preprocess the source, compiling waits for link_shader() (not needed when the binary is cached)
     
     if(type == GL_VERTEX_SHADER){
         std::cout << "adding vert shader from " << filepath << std::endl;  
@@ -34,43 +40,331 @@ void shader_program_t::add_shader(std::string& filepath, unsigned int type){
         return;
     }
 
-    std::ifstream fs(filepath);
+    shader_stage_t stage;
+    stage.type = type;
+    stage.path = filepath;
     std::stringstream ss;
-    std::string s;
-    while (getline(fs, s)) {
-        ss << s << "\n";
+    if (!expand_source(filepath, defines, stage.files, ss)) return;
+    stage.source = ss.str();
+    stages.push_back(stage);
+}
+
+void shader_program_t::add_define(const std::string& define){
+    defines += "#define " + define + "\n";
+}
+
+void shader_program_t::set_feedback_varyings(const std::vector<std::string>& names, unsigned int buffer_mode){
+    feedback_varyings = names;
+    feedback_mode = buffer_mode;
+}
+
+// "dir/" part of a path, empty if there is none
+static std::string directory_of(const std::string& path){
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+// Bounds the include tree; every file is read at most once per stage anyway
+static const size_t MAX_SOURCE_FILES = 32;
+
+// Copy 'path' into 'out' with every #include "file" (relative to the including file) replaced by
+// the file itself, and 'defines' inserted right after the #version line. A file is included at
+// most once per stage, so headers need no guards. Includes are expanded before the GLSL compiler
+// sees any #if, so keep them unconditional. The #line directives keep compiler messages
+// usable: their source string number is the file's index in 'files'.
+bool shader_program_t::expand_source(const std::string& path, const std::string& defines,
+                                     std::vector<std::string>& files, std::ostream& out){
+    std::ifstream fs(path);
+    if (!fs) {
+        std::cout << "ERROR::SHADER::FILE_NOT_READ " << path << std::endl;
+        return false;
     }
-    std::string temp = ss.str();
-    const char *source = temp.c_str();
+    int file_index = (int)files.size();
+    files.push_back(path);
 
-    unsigned int shader = glCreateShader(type);
-    glShaderSource(shader, 1, &source, NULL);
-    glCompileShader(shader);
+    std::string line;
+    int line_number = 0;
+    while (getline(fs, line)) {
+        line_number++;
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line[start] != '#') {
+            out << line << "\n";
+            continue;
+        }
 
-    int success;
-    char infoLog[512];
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(shader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::" << type << "::COMPLIATION_FAILED"
-                  << infoLog << std::endl;
-        return;
+        if (line.compare(start, 8, "#version") == 0) {
+            out << line << "\n" << defines << "#line " << line_number + 1 << " " << file_index << "\n";
+        }
+        else if (line.compare(start, 8, "#include") == 0) {
+            size_t open = line.find('"', start + 8);
+            size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+            if (close == std::string::npos) {
+                std::cout << "ERROR::SHADER::BAD_INCLUDE " << path << ":" << line_number << std::endl;
+                return false;
+            }
+            std::string include_path = directory_of(path) + line.substr(open + 1, close - open - 1);
+            if (std::find(files.begin(), files.end(), include_path) == files.end()) {
+                if (files.size() >= MAX_SOURCE_FILES) {
+                    std::cout << "ERROR::SHADER::TOO_MANY_INCLUDES " << path << std::endl;
+                    return false;
+                }
+                out << "#line 1 " << files.size() << "\n";
+                if (!expand_source(include_path, "", files, out)) return false;
+            }
+            out << "#line " << line_number + 1 << " " << file_index << "\n";
+        }
+        else {
+            out << line << "\n";
+        }
     }
-    shader_handles.push_back(shader);
+    return true;
 }
 
-void shader_program_t::link_shader(){
+static std::string g_binary_cache_dir;
+static program_build_stats_t g_build_stats;
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start){
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void shader_program_t::set_binary_cache_dir(const std::string& dir){
+    g_binary_cache_dir = dir;
+    if (dir.empty()) return;
+#if defined(_WIN32)
+    _mkdir(dir.c_str());
+#else
+    mkdir(dir.c_str(), 0755);
+#endif
+}
+
+program_build_stats_t shader_program_t::build_stats(){
+    return g_build_stats;
+}
+
+// Binary cache file: "ICGB", format (uint32), length (uint32), program binary
+static const char BINARY_MAGIC[4] = {'I', 'C', 'G', 'B'};
+
+static bool binary_cache_usable(){
+    if (g_binary_cache_dir.empty() || !GLAD_GL_ARB_get_program_binary) return false;
+    int formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+// file names of the stages and the #define flags, for log output
+std::string shader_program_t::label() const{
+    std::string s;
+    for (const auto& stage : stages) {
+        size_t slash = stage.path.find_last_of("/\\");
+        if (!s.empty()) s += "+";
+        s += slash == std::string::npos ? stage.path : stage.path.substr(slash + 1);
+    }
+    // permutation flags, "#define A\n#define B 1\n" -> " [A, B 1]"
+    std::string flags;
+    std::istringstream lines(defines);
+    std::string line;
+    while (getline(lines, line)) {
+        flags += (flags.empty() ? "" : ", ") + line.substr(strlen("#define "));
+    }
+    if (!flags.empty()) s += " [" + flags + "]";
+    return s;
+}
+
+// Queue every stage and the link. Nothing here waits for the driver: the compile status is only
+// looked at when the link failed (report_compile_errors)
+void shader_program_t::submit_compile(){
+    auto compile_start = std::chrono::steady_clock::now();
+    for (const auto& stage : stages) {
+        const char *source = stage.source.c_str();
+
+        unsigned int shader = glCreateShader(stage.type);
+        glShaderSource(shader, 1, &source, NULL);
+        glCompileShader(shader);
+        shader_handles.push_back(shader);
+    }
+    pending_compile_ms = elapsed_ms(compile_start);
+
+    if (binary_cache_usable()) glProgramParameteri(program_handle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 
     // attach the compiles shader to program 
     for(auto shader_handle: shader_handles){
         glAttachShader(program_handle, shader_handle);
     }
+    if (!feedback_varyings.empty()) {
+        std::vector<const char*> names;
+        for (const auto& name : feedback_varyings) names.push_back(name.c_str());
+        glTransformFeedbackVaryings(program_handle, (GLsizei)names.size(), names.data(), feedback_mode);
+    }
     // link the attached shader to program
+    auto link_start = std::chrono::steady_clock::now();
     glLinkProgram(program_handle);
+    pending_link_ms = elapsed_ms(link_start);
+}
+
+void shader_program_t::report_compile_errors() const{
+    for (size_t i = 0; i < shader_handles.size() && i < stages.size(); i++) {
+        int success;
+        char infoLog[512];
+        glGetShaderiv(shader_handles[i], GL_COMPILE_STATUS, &success);
+        if (success) continue;
+
+        glGetShaderInfoLog(shader_handles[i], 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::" << stages[i].type << "::COMPLIATION_FAILED"
+                  << infoLog << std::endl;
+        for (size_t f = 0; f < stages[i].files.size(); f++)
+            std::cout << "  source string " << f << ": " << stages[i].files[f] << std::endl;
+    }
+}
+
+// FNV-1a 64 over the driver strings and every stage (type + source, in order)
+uint64_t shader_program_t::binary_key() const{
+    uint64_t h = 14695981039346656037ull;
+    auto mix = [&h](const void* data, size_t size) {
+        const unsigned char* p = (const unsigned char*)data;
+        for (size_t i = 0; i < size; i++) {
+            h ^= p[i];
+            h *= 1099511628211ull;
+        }
+    };
+    const GLenum strings[] = {GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION};
+    for (GLenum name : strings) {
+        const char* value = (const char*)glGetString(name);
+        if (value) mix(value, strlen(value) + 1);
+    }
+    for (const auto& stage : stages) {
+        mix(&stage.type, sizeof(stage.type));
+        mix(stage.source.data(), stage.source.size());
+        mix("", 1);
+    }
+    // the captured outputs are linked into the binary too
+    if (!feedback_varyings.empty()) mix(&feedback_mode, sizeof(feedback_mode));
+    for (const auto& name : feedback_varyings) mix(name.c_str(), name.size() + 1);
+    return h;
+}
+
+std::string shader_program_t::binary_path() const{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)binary_key());
+    return g_binary_cache_dir + "/" + name;
+}
+
+bool shader_program_t::submit_binary(){
+    if (!binary_cache_usable()) return false;
+
+    std::ifstream in(binary_path(), std::ios::binary);
+    if (!in) return false;
+
+    char magic[4];
+    uint32_t format = 0, length = 0;
+    in.read(magic, 4);
+    in.read((char*)&format, sizeof(format));
+    in.read((char*)&length, sizeof(length));
+    if (!in || memcmp(magic, BINARY_MAGIC, 4) != 0 || length == 0) return false;
+
+    std::vector<char> binary(length);
+    if (!in.read(binary.data(), length)) return false;
+
+    // GL_LINK_STATUS tells whether the driver took it, finish_link() checks
+    glProgramBinary(program_handle, format, binary.data(), length);
+    return true;
+}
+
+void shader_program_t::save_binary(){
+    if (!binary_cache_usable()) return;
+
+    int length = 0;
+    glGetProgramiv(program_handle, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program_handle, length, &length, &format, binary.data());
+
+    std::ofstream out(binary_path(), std::ios::binary);
+    uint32_t format32 = format, length32 = length;
+    out.write(BINARY_MAGIC, 4);
+    out.write((const char*)&format32, sizeof(format32));
+    out.write((const char*)&length32, sizeof(length32));
+    out.write(binary.data(), length);
+}
+
+static bool parallel_compile_supported(){
+    return GLAD_GL_KHR_parallel_shader_compile || GLAD_GL_ARB_parallel_shader_compile;
+}
+
+void shader_program_t::enable_parallel_compile(){
+    // 0xFFFFFFFF = as many compiler threads as the driver wants
+    if (GLAD_GL_KHR_parallel_shader_compile)
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    else if (GLAD_GL_ARB_parallel_shader_compile)
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+}
+
+void shader_program_t::link_shader(){
+    submit_link();
+    finish_link();
+}
+
+void shader_program_t::submit_link(){
+    g_build_stats.programs++;
+    link_pending = true;
+
+    auto load_start = std::chrono::steady_clock::now();
+    linked_from_binary = submit_binary();
+    if (linked_from_binary) {
+        pending_load_ms = elapsed_ms(load_start);
+        return;
+    }
+    submit_compile();
+}
+
+bool shader_program_t::is_ready(){
+    if (!link_pending) return true;
+    if (parallel_compile_supported()) {
+        int done = 0;
+        glGetProgramiv(program_handle, GL_COMPLETION_STATUS_KHR, &done);
+        if (!done) return false;
+    }
+    finish_link();
+    return true;
+}
+
+bool shader_program_t::finish_link(){
+    if (!link_pending) return link_ok;
+    link_pending = false;
+
+    auto wait_start = std::chrono::steady_clock::now();
     int success = 0;
     glGetProgramiv(program_handle, GL_LINK_STATUS, &success);
 
+    if (linked_from_binary) {
+        if (success) {
+            double wait_ms = elapsed_ms(wait_start);
+            g_build_stats.from_cache++;
+            g_build_stats.load_ms += pending_load_ms;
+            g_build_stats.wait_ms += wait_ms;
+            std::cout << "program " << label() << ": binary cache, " << pending_load_ms << " ms, waited "
+                      << wait_ms << " ms" << std::endl;
+            reflect_uniforms();
+            link_ok = true;
+            return true;
+        }
+        // a driver update can reject the binary even with the same version strings
+        linked_from_binary = false;
+        submit_compile();
+        glGetProgramiv(program_handle, GL_LINK_STATUS, &success);
+    }
+    double wait_ms = elapsed_ms(wait_start);
+
+    g_build_stats.compile_ms += pending_compile_ms;
+    g_build_stats.link_ms += pending_link_ms;
+    g_build_stats.wait_ms += wait_ms;
+    std::cout << "program " << label() << ": compile " << pending_compile_ms << " ms, link " << pending_link_ms
+              << " ms, waited " << wait_ms << " ms" << std::endl;
+
     if (!success) {
+        report_compile_errors();
+
         int maxLength = 0;
         glGetProgramiv(program_handle, GL_INFO_LOG_LENGTH, &maxLength);
 
@@ -80,22 +374,81 @@ void shader_program_t::link_shader(){
 
         // We don't need the program anymore.
         glDeleteProgram(program_handle);
+        program_handle = 0;
         
         // Don't leak shaders either.
         for(auto shader_handle: shader_handles)
             glDeleteShader(shader_handle);
+        shader_handles.clear();
 
         puts(infoLog);
         free(infoLog);
+        link_ok = false;
+        return false;
     }
     
-    // detach the shader once linked
+    // detach the shader once linked, the program keeps the compiled code
     for(auto shader_handle: shader_handles){
         glDetachShader(program_handle, shader_handle);
+        glDeleteShader(shader_handle);
+    }
+    shader_handles.clear();
+
+    save_binary();
+
+    // name -> location table and value cache for set_uniform_value
+    reflect_uniforms();
+    link_ok = true;
+    return true;
+}
+
+std::vector<std::string> shader_program_t::source_files() const{
+    std::vector<std::string> files;
+    for (const auto& stage : stages) {
+        for (const auto& file : stage.files) {
+            if (std::find(files.begin(), files.end(), file) == files.end()) files.push_back(file);
+        }
     }
+    return files;
+}
+
+bool shader_program_t::reload(){
+    if (link_pending) finish_link();
+
+    shader_program_t candidate;
+    candidate.defines = defines;
+    candidate.feedback_varyings = feedback_varyings;
+    candidate.feedback_mode = feedback_mode;
+    for (const auto& stage : stages) {
+        shader_stage_t fresh;
+        fresh.type = stage.type;
+        fresh.path = stage.path;
+        std::stringstream ss;
+        if (!expand_source(stage.path, defines, fresh.files, ss)) {
+            std::cout << "reload " << label() << " failed, keeping the old program" << std::endl;
+            return false;
+        }
+        fresh.source = ss.str();
+        candidate.stages.push_back(fresh);
+    }
+
+    candidate.create();
+    candidate.link_shader();
+    // a failed finish_link() already deleted the candidate's program
+    if (!candidate.link_ok) {
+        std::cout << "reload " << label() << " failed, keeping the old program" << std::endl;
+        return false;
+    }
+
+    // the linked candidate takes this object's place, the old program goes with the candidate
+    std::swap(*this, candidate);
+    glDeleteProgram(candidate.program_handle);
+    std::cout << "reloaded " << label() << std::endl;
+    return true;
 }
 
 void shader_program_t::use(){
+    if (link_pending) finish_link();
     glUseProgram(program_handle);
 }
 
@@ -103,28 +456,210 @@ void shader_program_t::release(){
     glUseProgram(0);
 }
 
+bool shader_program_t::bind_uniform_block(const char* name, unsigned int binding){
+    if (link_pending) finish_link();
+    if (program_handle == 0) return false; // the link failed
+    unsigned int index = glGetUniformBlockIndex(program_handle, name);
+    if (index == GL_INVALID_INDEX) return false;
+    glUniformBlockBinding(program_handle, index, binding);
+    return true;
+}
+
+static uniform_stats_t g_uniform_stats;
+
+uniform_stats_t shader_program_t::uniform_stats(){
+    return g_uniform_stats;
+}
+
+void shader_program_t::reset_uniform_stats(){
+    g_uniform_stats = uniform_stats_t();
+}
+
+static uint32_t hash_uniform_name(const char* name){
+    // FNV-1a 32
+    uint32_t h = 2166136261u;
+    for (; *name; name++) {
+        h ^= (unsigned char)*name;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void shader_program_t::reflect_uniforms(){
+    uniform_table.clear();
+    uniform_values.clear();
+    uniform_valid.clear();
+
+    int count = 0, max_length = 0;
+    glGetProgramiv(program_handle, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program_handle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+
+    // arrays are reported as "name[0]", register the bare name as well
+    std::vector<std::pair<std::string, int>> active;
+    std::vector<char> buffer(std::max(max_length, 1));
+    for (int i = 0; i < count; i++) {
+        int length = 0, size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program_handle, i, (GLsizei)buffer.size(), &length, &size, &type, buffer.data());
+        std::string name(buffer.data(), length);
+        int location = glGetUniformLocation(program_handle, name.c_str());
+        if (location < 0) continue; // uniform block members
+
+        active.push_back({name, location});
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0) {
+            active.push_back({name.substr(0, name.size() - 3), location});
+        }
+    }
+
+    size_t capacity = 16;
+    while (capacity < active.size() * 2) capacity *= 2;
+    uniform_table.assign(capacity, uniform_entry_t{"", 0, -1, -1});
+
+    int slots = 0;
+    for (const auto& uniform : active) {
+        uint32_t hash = hash_uniform_name(uniform.first.c_str());
+        size_t i = hash & (capacity - 1);
+        while (!uniform_table[i].name.empty()) i = (i + 1) & (capacity - 1);
+
+        // "name" and "name[0]" share one location and so one cached value
+        int slot = slots;
+        for (const auto& entry : uniform_table) {
+            if (!entry.name.empty() && entry.location == uniform.second) slot = entry.slot;
+        }
+        if (slot == slots) slots++;
+
+        uniform_table[i] = {uniform.first, hash, uniform.second, slot};
+    }
+
+    uniform_values.assign(slots * 64, 0);
+    uniform_valid.assign(slots, 0);
+}
+
+const shader_program_t::uniform_entry_t* shader_program_t::find_uniform(const char* name) const{
+    if (uniform_table.empty()) return nullptr;
+
+    uint32_t hash = hash_uniform_name(name);
+    size_t mask = uniform_table.size() - 1;
+    for (size_t i = hash & mask; !uniform_table[i].name.empty(); i = (i + 1) & mask) {
+        if (uniform_table[i].hash == hash && uniform_table[i].name == name) return &uniform_table[i];
+    }
+    return nullptr;
+}
+
+uniform_handle_t shader_program_t::uniform(const char* name){
+    if (link_pending) finish_link();
+    uniform_handle_t u;
+    const uniform_entry_t* entry = find_uniform(name);
+    if (entry) {
+        u.location = entry->location;
+        u.slot = entry->slot;
+    }
+    return u;
+}
+
+// Remember the value and tell whether the program has to be updated. Inactive uniforms never are.
+bool shader_program_t::uniform_changed(const uniform_handle_t& u, const void* data, size_t bytes){
+    if (u.slot < 0 || u.slot >= (int)uniform_valid.size()) {
+        g_uniform_stats.redundant++;
+        return false;
+    }
+    unsigned char* cached = &uniform_values[u.slot * 64];
+    if (uniform_valid[u.slot] && memcmp(cached, data, bytes) == 0) {
+        g_uniform_stats.redundant++;
+        return false;
+    }
+    memcpy(cached, data, bytes);
+    uniform_valid[u.slot] = 1;
+    g_uniform_stats.uploads++;
+    return true;
+}
+
+void shader_program_t::set_uniform_value(const uniform_handle_t& u, const glm::mat4 &mat){
+    if (uniform_changed(u, glm::value_ptr(mat), sizeof(mat)))
+        glUniformMatrix4fv(u.location, 1, GL_FALSE, glm::value_ptr(mat));
+}
+
+void shader_program_t::set_uniform_value(const uniform_handle_t& u, const glm::mat3 &mat){
+    if (uniform_changed(u, glm::value_ptr(mat), sizeof(mat)))
+        glUniformMatrix3fv(u.location, 1, GL_FALSE, glm::value_ptr(mat));
+}
+
+void shader_program_t::set_uniform_value(const uniform_handle_t& u, const glm::vec3& vec){
+    if (uniform_changed(u, glm::value_ptr(vec), sizeof(vec)))
+        glUniform3fv(u.location, 1, glm::value_ptr(vec));
+}
+
+void shader_program_t::set_uniform_value(const uniform_handle_t& u, const float value){
+    if (uniform_changed(u, &value, sizeof(value)))
+        glUniform1f(u.location, value);
+}
+
+void shader_program_t::set_uniform_value(const uniform_handle_t& u, const int value){
+    if (uniform_changed(u, &value, sizeof(value)))
+        glUniform1i(u.location, value);
+}
+
 void shader_program_t::set_uniform_value(const char* name, const glm::mat4 &mat){
-    unsigned int loc = glGetUniformLocation(program_handle, name);
-    glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(mat)); 
+    g_uniform_stats.lookups++;
+    set_uniform_value(uniform(name), mat);
 }
 
 void shader_program_t::set_uniform_value(const char* name, const glm::mat3 &mat){
-    unsigned int loc = glGetUniformLocation(program_handle, name);
-    glUniformMatrix3fv(loc, 1, GL_FALSE, glm::value_ptr(mat));
+    g_uniform_stats.lookups++;
+    set_uniform_value(uniform(name), mat);
 }
 
 void shader_program_t::set_uniform_value(const char* name, const glm::vec3& vec){
-    unsigned int loc = glGetUniformLocation(program_handle, name);
-    glUniform3fv(loc, 1, glm::value_ptr(vec));
-
+    g_uniform_stats.lookups++;
+    set_uniform_value(uniform(name), vec);
 }
 
 void shader_program_t::set_uniform_value(const char* name, const float value){
-    unsigned int loc = glGetUniformLocation(program_handle, name);
-    glUniform1f(loc, value);
+    g_uniform_stats.lookups++;
+    set_uniform_value(uniform(name), value);
 }
 
 void shader_program_t::set_uniform_value(const char* name, const int value){
-    unsigned int loc = glGetUniformLocation(program_handle, name);
-    glUniform1i(loc, value);
-}
\ No newline at end of file
+    g_uniform_stats.lookups++;
+    set_uniform_value(uniform(name), value);
+}
+
+shader_variant_cache_t::~shader_variant_cache_t(){
+    clear();
+}
+
+shader_program_t* shader_variant_cache_t::get(const std::vector<stage_t>& stages, std::vector<std::string> defines){
+    // flag order does not make a different permutation
+    std::sort(defines.begin(), defines.end());
+    defines.erase(std::unique(defines.begin(), defines.end()), defines.end());
+
+    std::string key;
+    for (const auto& stage : stages)
+        key += std::to_string(stage.type) + ":" + stage.path + ";";
+    for (const auto& define : defines)
+        key += "-D" + define + ";";
+
+    auto found = programs.find(key);
+    if (found != programs.end()) return found->second;
+
+    shader_program_t* program = new shader_program_t();
+    program->create();
+    for (const auto& define : defines)
+        program->add_define(define);
+    for (const auto& stage : stages) {
+        std::string path = stage.path;
+        program->add_shader(path, stage.type);
+    }
+    // not waited for, the caller checks is_ready() before drawing with it
+    program->submit_link();
+    if (on_submit) on_submit(program);
+
+    programs[key] = program;
+    return program;
+}
+
+void shader_variant_cache_t::clear(){
+    for (auto& entry : programs)
+        delete entry.second;
+    programs.clear();
+}
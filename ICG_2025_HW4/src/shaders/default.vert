@@ -6,8 +6,8 @@ layout (location = 2) in vec2 aTexCoord;
 out vec2 vTexCoord;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+#include "include/camera.glsl"
 
 void main()
 {
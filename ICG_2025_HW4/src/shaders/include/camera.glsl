@@ -0,0 +1,7 @@
+// Per-frame camera block, filled once per frame by render() (CameraBlock in header/UniformBlocks.h)
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+    float time;
+};
@@ -0,0 +1,14 @@
+// Stateless random numbers for GPU particles: pcg_hash (Jarzynski & Olano 2020) of whatever
+// identifies the draw, e.g. gl_VertexID mixed with a per-frame seed
+uint pcgHash(uint v)
+{
+    uint state = v * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+// top 24 bits -> [0, 1)
+float unitFloat(uint h)
+{
+    return float(h >> 8u) * (1.0 / 16777216.0);
+}
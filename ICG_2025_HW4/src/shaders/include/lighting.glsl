@@ -0,0 +1,48 @@
+// Light terms shared by the lit shaders, light_t / material_t come from scene.glsl.
+// The specular model is picked at compile time: SHADING_BLINN_PHONG, SHADING_TOON or Phong (default).
+
+struct light_terms_t {
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+// 卡通風格: 離散化亮度變化
+float toon_diffuse(float diff)
+{
+    if (diff > 0.95)
+        return 1.0;
+    else if (diff > 0.5)
+        return 0.7;
+    else if (diff > 0.25)
+        return 0.4;
+    return 0.1;
+}
+
+// Untextured ambient / diffuse / specular at P (N normalized), seen from eye
+light_terms_t light_terms(light_t light, material_t material, vec3 P, vec3 N, vec3 eye)
+{
+    vec3 L = normalize(light.position - P);
+    vec3 V = normalize(eye - P);
+
+    float diff = max(dot(L, N), 0.0);
+#if defined(SHADING_BLINN_PHONG)
+    // Halfway Vector H = (L + V) / ||L + V||
+    vec3 H = normalize(L + V);
+    float spec = pow(max(dot(N, H), 0.0), material.gloss);
+#else
+    vec3 R = reflect(-L, N);
+    float spec = pow(max(dot(V, R), 0.0), material.gloss);
+#endif
+
+#if defined(SHADING_TOON)
+    diff = toon_diffuse(diff);
+    spec = spec > 0.9 ? 1.0 : 0.0; // binarize 高光，像是漫畫用一個圓圈代表高光那樣
+#endif
+
+    light_terms_t terms;
+    terms.ambient = light.ambient * material.ambient;
+    terms.diffuse = light.diffuse * material.diffuse * diff;
+    terms.specular = light.specular * material.specular * spec;
+    return terms;
+}
@@ -0,0 +1,30 @@
+// Light and material blocks of the lit shaders (LightBlock / MaterialBlock in header/UniformBlocks.h)
+#include "camera.glsl"
+
+struct light_t {
+    vec3 position;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct material_t {
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+    float gloss;
+};
+
+layout (std140) uniform Lights {
+    light_t light;
+};
+
+#define MAX_MATERIALS 16
+
+layout (std140) uniform Materials {
+    material_t materials[MAX_MATERIALS];
+};
+// MULTI_DRAW programs get it per draw from multidraw.vert instead
+#if !defined(MULTI_DRAW)
+uniform int materialIndex;
+#endif
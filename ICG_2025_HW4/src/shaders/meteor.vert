@@ -10,13 +10,14 @@ out VS_OUT {
 } vs_out;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+uniform mat3 normalMatrix; // inverse transpose of model, from the CPU
+
+#include "include/camera.glsl"
 
 void main()
 {
     vs_out.texCoords = aTexCoords;
-    vs_out.normal = mat3(transpose(inverse(model))) * aNormal;
+    vs_out.normal = normalMatrix * aNormal;
     vs_out.fragPos = vec3(model * vec4(aPos, 1.0));
     
     gl_Position = projection * view * model * vec4(aPos, 1.0);
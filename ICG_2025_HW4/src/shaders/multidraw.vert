@@ -0,0 +1,49 @@
+#version 430 core
+// lit.vert for MultiDrawBatch: model, normal matrix and material come from the per-draw shader
+// storage buffer instead of uniforms. Paired with lit.frag, compiled with MULTI_DRAW and one of the
+// SHADING_* defines.
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+// 0, 1, 2, ... with divisor 1: the draw's baseInstance (MeshArena::DRAW_ID_LOCATION)
+layout (location = 3) in uint aDrawId;
+
+out vec3 WorldPos;
+out vec3 Normal;
+out vec2 TexCoord;
+flat out int materialIndex;
+
+// DrawData in header/MultiDraw.h
+struct draw_data_t {
+    mat4 model;
+    mat3 normalMatrix;
+    int materialIndex;
+};
+
+layout (std430, binding = 0) readonly buffer DrawDataBuffer {
+    draw_data_t draws[];
+};
+
+#include "include/scene.glsl"
+#include "include/lighting.glsl"
+
+#if defined(SHADING_GOURAUD)
+out vec3 ColorCoeff;
+#endif
+
+void main()
+{
+    draw_data_t draw = draws[aDrawId];
+    materialIndex = draw.materialIndex;
+
+    WorldPos = vec3(draw.model * vec4(aPos, 1.0));
+    Normal = draw.normalMatrix * aNormal;
+    TexCoord = aTexCoord;
+
+#if defined(SHADING_GOURAUD)
+    light_terms_t terms = light_terms(light, materials[materialIndex], WorldPos, normalize(Normal), viewPos);
+    ColorCoeff = terms.ambient + terms.diffuse + terms.specular;
+#endif
+
+    gl_Position = projection * view * vec4(WorldPos, 1.0);
+}
@@ -4,9 +4,10 @@ out vec4 FragColor;
 in vec2 TexCoord;
 
 uniform sampler2D objectTexture;
-uniform float time;
 uniform float progress;
 
+#include "include/camera.glsl"
+
 // random函式
 float random(vec2 st) {
     return fract(sin(dot(st.xy, vec2(12.9898,78.233))) * 43758.5453123);
@@ -0,0 +1,26 @@
+#version 330 core
+// Fills the GPU snowflake buffers (GpuSnowSystem::reset): one point per flake, rasterizer off,
+// both outputs captured by transform feedback into separate buffers
+
+out vec3 outPosition;
+out vec4 outParams; // size, rotation, fall speed, sway phase
+
+uniform int seed;
+uniform vec3 volume; // area size, height min, height max
+
+#include "include/hash.glsl"
+
+void main()
+{
+    uint h = pcgHash(uint(gl_VertexID) ^ pcgHash(uint(seed)));
+    float r[7];
+    for (int i = 0; i < 7; i++) {
+        h = pcgHash(h);
+        r[i] = unitFloat(h);
+    }
+
+    // same ranges as SnowSystem::reset()
+    float halfArea = volume.x * 0.5;
+    outPosition = vec3(mix(-halfArea, halfArea, r[0]), mix(volume.y, volume.z, r[1]), mix(-halfArea, halfArea, r[2]));
+    outParams = vec4(mix(2.0, 6.0, r[3]), r[4] * 6.28318531, mix(20.0, 60.0, r[5]), r[6] * 6.28318531);
+}
@@ -0,0 +1,31 @@
+#version 330 core
+// One simulation step per flake (GpuSnowSystem::update), same motion as SnowSystem::update():
+// fall, sway sideways, respawn at the top when below the volume. The rasterizer is off and
+// outPosition goes to the other position buffer through transform feedback.
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec4 aParams; // size, rotation, fall speed, sway phase
+
+out vec3 outPosition;
+
+uniform float swayTime;   // time * sway frequency
+uniform float swayAmount; // sway amplitude * dt
+uniform float deltaTime;
+uniform int seed;         // changes every step, so respawns land somewhere new
+uniform vec3 volume;      // area size, height min, height max
+
+#include "include/hash.glsl"
+
+void main()
+{
+    vec3 p = aPos;
+    p.x += sin(swayTime + aParams.w) * swayAmount;
+    p.y -= aParams.z * deltaTime;
+
+    if (p.y < volume.y) {
+        uint h = pcgHash(uint(gl_VertexID) ^ pcgHash(uint(seed)));
+        uint h2 = pcgHash(h);
+        float halfArea = volume.x * 0.5;
+        p = vec3(mix(-halfArea, halfArea, unitFloat(h)), volume.z, mix(-halfArea, halfArea, unitFloat(h2)));
+    }
+    outPosition = p;
+}
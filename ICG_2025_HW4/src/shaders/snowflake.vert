@@ -8,9 +8,7 @@ out VS_OUT {
     float rotation;
 } vs_out;
 
-uniform mat4 view;
-uniform mat4 projection;
-uniform float time;
+#include "include/camera.glsl"
 
 void main()
 {
@@ -0,0 +1,34 @@
+#version 330 core
+// snowflake.vert + snowflake.geom without the geometry shader: the star is a static 36 vertex mesh
+// (location 3, radius 1) drawn once per flake with glDrawArraysInstanced, the flake attributes
+// advance once per instance (divisor 1). Paired with snowflake.frag.
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in float aSize;
+layout (location = 2) in float aRotation;
+layout (location = 3) in vec2 aCorner;
+
+out vec3 SnowColor;
+out vec2 LocalPos;
+
+#include "include/camera.glsl"
+
+mat2 rotate2D(float angle) {
+    float c = cos(angle);
+    float s = sin(angle);
+    return mat2(c, -s, s, c);
+}
+
+void main()
+{
+    float rotation = aRotation + time * 0.5;
+    vec2 local = aCorner * aSize;
+    vec2 rotated = rotate2D(rotation) * local;
+
+    vec3 right = vec3(view[0][0], view[1][0], view[2][0]);
+    vec3 up = vec3(view[0][1], view[1][1], view[2][1]);
+    vec3 worldPos = aPos + right * rotated.x + up * rotated.y;
+
+    gl_Position = projection * view * vec4(worldPos, 1.0);
+    SnowColor = vec3(0.95, 0.97, 1.0);
+    LocalPos = local;
+}